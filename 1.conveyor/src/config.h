@@ -4,7 +4,9 @@
 //ТАЙМІНГИ ТА ІНТЕРВАЛИ ПНЕВМОКЛАПАНІВ
 // -------------------------
 
-// Розлив фарби: один імпульс поршня (утримання в мс)
+// Розлив фарби: один імпульс поршня (утримання в мс).
+// З кінцевим датчиком (PAINT_PISTON_REED_PIN) — межа ходу: клапан вимикається, щойно датчик
+// підтвердить кінець ходу, а не підтверджений за цей час хід рахується як таймаут
 #define PAINT_PISTON_HOLD_TIME                  1000
 // Другий пневмоциліндр для розливу фарби (утримання в мс)
 #define PAINT_PISTON_2_HOLD_TIME                500
@@ -13,11 +15,16 @@
 #define PNEUMATIC1_HOLD_TIME_MS                 400   // додаткове утримання після увімкнення
 // Закривання кришок
 #define STEP_PAUSE_CAP_SCREW_MS                 300   // пауза перед запуском Valve 5 після Valve 4
-#define CLOSE_CAP_HOLD_TIME                     800  // утримання в положенні закривання (вимкнеться раніше за Valve 4)
+#define CLOSE_CAP_HOLD_TIME                     800  // утримання в положенні закривання (вимкнеться раніше за Valve 4); з CAP_CLOSE_REED_PIN — межа ходу
 #define STEP_PAUSE_CAP_CLOSE_MS                 300   // мінімальна пауза після Valve 5
 
 // Кількість баночок у збірці
 #define JARS_IN_SET             6     // кількість баночок у збірці
+#define JAR_PITCH_MM            40.0  // відстань між центрами баночок у спайці (мм)
+
+// Облік спайок на ремені (set_tracker.h): виміряти на станку
+#define SENSOR1_TO_SENSOR2_MM     400.0 // відстань між датчиками 1 і 2 уздовж ременя (мм)
+#define SET_ARRIVAL_TOLERANCE_MM  15.0  // допуск приходу спайки на датчик 2 відносно розрахунку (мм)
 
 // -------------------------
 // ПАРАМЕТРИ КОНВЕЄРА (XY) — основний конвеєр з ременем/шківом
@@ -27,7 +34,27 @@
 #define MICROSTEPS_XY            8       // Дріблення кроку (1/8)
 #define MOTOR_STEPS_PER_REV_XY   200     // Кроків на оберт двигуна (звичайно 200)
 // Швидкість конвеєра XY:
-#define BELT_SPEED_XY_MM_PER_S   50.0    // Бажана швидкість у мм/с
+#define BELT_SPEED_XY_MM_PER_S   50.0    // Швидкість підходу до датчиків у мм/с (з неї розраховані дотягування)
+// Планування швидкості (Conveyor::scheduleSpeed): між спайками конвеєр їде транзитною швидкістю,
+// а за APPROACH_DISTANCE_MM до найранішого очікуваного фронту датчика 1 чи 2 вже має їхати
+// BELT_SPEED_XY_MM_PER_S. Фронт датчика 1 очікується через SET_PITCH_MM після попереднього
+// (ближче спайки не лягають), датчика 2 — за обліком SetTracker мінус допуск приходу.
+// Поки прогнозу немає (після пуску, без спайок) — швидкість підходу.
+// APPROACH_DISTANCE_MM — не менше кроку баночок: пропущена датчиком 1 передня баночка
+// приходить на датчик 2 на крок раніше за розрахунок.
+// BELT_TRANSIT_SPEED_XY_MM_PER_S = BELT_SPEED_XY_MM_PER_S вимикає режим.
+#define BELT_TRANSIT_SPEED_XY_MM_PER_S  80.0   // Перевірити на станку: баночки не мають хитатись
+#define APPROACH_DISTANCE_MM            50.0
+#define SET_PITCH_MM                    (JARS_IN_SET * JAR_PITCH_MM)  // найменша відстань між передніми баночками спайок
+// Розгін і гальмування конвеєра XY (таблиця розгону рахується при компіляції).
+// Швидкість підходу — окреме плато таблиці розгону, тож гальмівний шлях з неї — повна S-крива:
+// v*(v/a + a/j)/2, при 50 мм/с, 400 мм/с², 8000 мм/с³ це 4.375 мм (175 кроків, з кроком на поточному
+// рівні — 176). Разом зі шляхом під час антидребезгу він має бути меншим за JAR_CENTERING_MM і
+// CAP_CENTERING_MM (перевіряє sensor_capture.h), інакше дотягування скидає швидкість стрибком.
+#define BELT_ACCEL_XY_MM_PER_S2  400.0   // Прискорення, мм/с²
+#define BELT_JERK_XY_MM_PER_S3   8000.0  // Ривок, мм/с³ (0 = трапеція без обмеження ривка)
+// Найбільша швидкість, до якої будується таблиця розгону
+#define RAMP_TOP_SPEED_XY_MM_PER_S  (BELT_TRANSIT_SPEED_XY_MM_PER_S > BELT_SPEED_XY_MM_PER_S ? BELT_TRANSIT_SPEED_XY_MM_PER_S : BELT_SPEED_XY_MM_PER_S)
 
 // -------------------------
 // ОБЧИСЛЕННЯ КІНЕМАТИКИ
@@ -42,16 +69,79 @@
 
 // Тривалість STEP імпульсу
 #define PULSE_WIDTH_MICROS 10
+
+// Апаратний генератор кроків (Timer3): 16 МГц / 8 = 0.5 мкс на тік
+#define STEP_TIMER_PRESCALER     8
+#define STEP_TIMER_CLOCK_SELECT  _BV(CS31)   // біти CS3x для переддільника 8
+#define STEP_TIMER_TICKS_PER_US  (F_CPU / 1000000UL / STEP_TIMER_PRESCALER)
+// Інтервал між кроками та тривалість імпульсу в тіках таймера
+#define STEP_INTERVAL_XY_TICKS   ((uint16_t)(STEP_INTERVAL_XY_MICROS * STEP_TIMER_TICKS_PER_US + 0.5))
+#define PULSE_WIDTH_TICKS        ((uint16_t)(PULSE_WIDTH_MICROS * STEP_TIMER_TICKS_PER_US))
 // Напрямки моторів
 #define MOTOR_X_DIR LOW // Напрямок мотора X
 
 // -------------------------
 // ДАТЧИКИ ТА КНОПКИ
 // -------------------------
-#define SENSOR_POLL_INTERVAL      10    // мс, інтервал опитування датчиків
 #define SENSOR_DEBOUNCE_TIME_MS   50    // мс, час антидребезгу для механічних сенсорів (рекомендовано 20-100мс)
+#define BUTTON_DEBOUNCE_TIME_MS   50    // мс, антидребезг кнопок (для STOP — блокування після натискання)
+// Стратегію кожного входу (стабільний рівень, блокування після фронту, інтегратор)
+// задає ControlsConfig. Усі входи знімаються разом раз на INPUT_SCAN_PERIOD_US; лічильник
+// антидребезгу — INPUT_COUNTER_BITS розрядів, тож найдовший час — (2^BITS - 1) вибірок (127 мс)
+#define INPUT_SCAN_PERIOD_US      500
+#define INPUT_COUNTER_BITS        8
 
+// Обидві відстані відраховуються від фронту датчика, захопленого в перериванні (sensor_capture.h),
+// і мають бути більшими за шлях під час антидребезгу плюс гальмівний шлях.
 #define JAR_CENTERING_MM 8.0 // На скільки мм зрушити баночку вперед після спрацювання датчика //8мм
+#define CAP_CENTERING_MM 7.0 // Де стати після датчика 2 (мм); 7 мм — як раніше: антидребезг + гальмування
+
+// Об'єднання зупинок (arbitrateConveyor): якщо спайка другої станції стане на місце не далі ніж
+// через STOP_COALESCE_MM після точки зупинки першої, конвеєр їде до неї і обидві станції працюють
+// за одну зупинку — спайка першої при цьому проходить свою точку на ці міліметри. Не більше за
+// допуск положення баночок під соплом і пресом; 0 — лише точний збіг. Виграш буває, коли
+// SENSOR1_TO_SENSOR2_MM близька до кратної відстані між спайками на ремені.
+#define STOP_COALESCE_MM 3.0
+
+
+// -------------------------
+// ТЕЛЕМЕТРІЯ (telemetry.h): двійкові події в Serial, розбирає tools/telemetry_decode
+// -------------------------
+#define TELEMETRY_BAUD            115200
+#define TELEMETRY_LEVEL           4     // 0 — вимкнено, 1 — помилки, 2 — попередження, 3 — інфо, 4 — налагодження
+
+// -------------------------
+// СТАТИСТИКА ВИРОБНИЦТВА (production_stats.h)
+// -------------------------
+#define STATS_EEPROM_START        0     // перший байт кільця записів статистики в EEPROM
+#define STATS_EEPROM_SIZE         2048  // байтів під кільце (далі — звіт сторожа зависань)
+#define STATS_SAVE_INTERVAL_S     600   // зберігати кожні N секунд роботи (крім паузи/зупинки)
 
+// -------------------------
+// ЗАПИС ВХОДІВ І СТАНІВ (input_trace.h): команда trace, відтворення — tools/trace_replay
+// -------------------------
+#define INPUT_TRACE_SIZE          256   // записів у кільці (6 байтів RAM кожен)
+
+// -------------------------
+// СТОРОЖ ЗАВИСАНЬ loop() (common/StallWatchdog)
+// -------------------------
+#define WATCHDOG_STALL_MS         1500  // довша ітерація — скидання плати (звіти на команди Serial сторожа підгодовують)
+#define WATCHDOG_EEPROM_ADDRESS   2048  // звіт останнього зависання, одразу за кільцем статистики
+
+// -------------------------
+// ШИНА ЛІНІЇ (common/LineBus): Mega — ведучий, опитує малий конвеєр (1) і пакування (2)
+// -------------------------
+// Serial1 (TX1 18, RX1 19) зараз зайнятий кнопками start/stop: перед увімкненням шини
+// кнопки треба перенести на вільні піни (pinout.h), інакше збірка для AVR не пройде.
+#ifndef LINE_BUS_ENABLED
+#define LINE_BUS_ENABLED          0
+#endif
+#define LINE_BUS_SERIAL           Serial1
+#define LINE_BUS_BAUD             115200
+#define LINE_BUS_SLAVES           2     // малий конвеєр і пакування
+#define LINE_BUS_POLL_MS          25    // кадр опитування; кожен ведений — раз на SLAVES * POLL_MS
+// Uno відповідає між ітераціями loop(), а журнал у Serial при спрацюванні датчика займає порт
+// на десятки мс; довший тайм-аут — менше запізнілих відповідей і тиша на лінії після них
+#define LINE_BUS_REPLY_TIMEOUT_MS 20
 
 #endif
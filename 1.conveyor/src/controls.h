@@ -2,19 +2,20 @@
 #include <Arduino.h>
 #include "pinout.h"
 #include "config.h"
-
-struct ButtonState {
-    bool current = false;
-    bool last = false;
-    unsigned long lastChange = 0;
-    bool pressedEvent = false;
+#include "input_scan.h"
+#include "sensor_capture.h"
+#include "input_trace.h"
+
+// Фронт датчика, захоплений перериванням (SensorCapture): положення конвеєра і час
+struct SensorEdge {
+    uint32_t position = 0;
+    unsigned long micros = 0;
 };
 
-struct SensorState {
-    bool current = false;
-    bool last = false;
-    unsigned long lastChange = 0;
-    bool rising = false;
+// Антидребезг одного входу: стратегія (input_scan.h) і її час у мс
+struct InputDebounce {
+    DebounceMode mode;
+    uint16_t ms;
 };
 
 enum ButtonMode {
@@ -35,9 +36,25 @@ struct ControlsConfig {
     ButtonMode stopMode = BUTTON_MOMENTARY;
     ButtonMode modeMode = BUTTON_TOGGLE;
     ButtonMode singleMode = BUTTON_MOMENTARY;
+
+    // Debounce strategy per input. STOP reacts on the first sample and ignores bounce after it.
+    InputDebounce startDebounce = {DEBOUNCE_STABLE, BUTTON_DEBOUNCE_TIME_MS};
+    InputDebounce stopDebounce = {DEBOUNCE_LOCKOUT, BUTTON_DEBOUNCE_TIME_MS};
+    InputDebounce s1Debounce = {DEBOUNCE_STABLE, SENSOR_DEBOUNCE_TIME_MS};
+    InputDebounce s2Debounce = {DEBOUNCE_STABLE, SENSOR_DEBOUNCE_TIME_MS};
 };
 
+// Кнопки і датчики знімаються разом, цілими портами (input_scan.h), раз на INPUT_SCAN_PERIOD_US;
+// антидребезг — вертикальні лічильники зі стратегією кожного входу з ControlsConfig, фронти — маски.
 class Controls {
+    using Inputs = InputScan<start_PIN, stop_PIN, sensor_1, sensor_2>;
+    using Mask = Inputs::Mask;
+
+    static constexpr Mask START = Inputs::mask<start_PIN>();
+    static constexpr Mask STOP = Inputs::mask<stop_PIN>();
+    static constexpr Mask SENSOR_1 = Inputs::mask<sensor_1>();
+    static constexpr Mask SENSOR_2 = Inputs::mask<sensor_2>();
+
 public:
     // Ініціалізація всіх пінів: кнопок та датчиків
     void begin() {
@@ -48,29 +65,59 @@ public:
         // Датчики (INPUT_PULLUP - активний стан = LOW)
         pinMode(sensor_1, INPUT_PULLUP);
         pinMode(sensor_2, INPUT_PULLUP);
-        
+
+        // Захоплення фронтів датчиків у перериванні
+        SensorCapture::begin(config.invertS1, config.invertS2);
+
+        // INPUT_PULLUP: активний = LOW; інверсія датчиків з конфігурації — поверх
+        activeLow = Inputs::ALL ^ (config.invertS1 ? SENSOR_1 : 0) ^ (config.invertS2 ? SENSOR_2 : 0);
+        debounce.reset(0);              // як і раніше: вхід, активний при старті, дає фронт
+        configure(START, config.startDebounce);
+        configure(STOP, config.stopDebounce);
+        configure(SENSOR_1, config.s1Debounce);
+        configure(SENSOR_2, config.s2Debounce);
+        pressed = 0;
+        sensorRising = 0;
+        lastScan = micros();
+        lastRaw = ~(Mask)0;
     }
 
     // Ініціалізація з конфігурацією (інверсії та режими кнопок)
     void begin(const ControlsConfig& cfg) {
-        begin();
         config = cfg;
+        begin();
     }
 
-    // Оновлення стану всіх кнопок та датчиків
+    // Вибірка входів, якщо настав час (раз на INPUT_SCAN_PERIOD_US)
     void update() {
-        // Оновлення кнопок
-        updateButton(start_PIN, startBtn);
-        updateButton(stop_PIN, stopBtn);
-
-        // Оновлення датчиків з антидребезгом
-        updateSensor(sensor_1, sensor1, config.invertS1);
-        updateSensor(sensor_2, sensor2, config.invertS2);
+        unsigned long now = micros();
+        if (now - lastScan < INPUT_SCAN_PERIOD_US) return;
+        // Після довгої ітерації loop() — нова сітка вибірок замість серії надолужувань
+        lastScan = now - lastScan < 2 * INPUT_SCAN_PERIOD_US ? lastScan + INPUT_SCAN_PERIOD_US : now;
+
+        Mask raw = Inputs::sample();
+        if (raw != lastRaw) {
+            lastRaw = raw;
+            InputTrace::inputs(traceLevels(raw));
+        }
+        Mask changed = debounce.update(raw ^ activeLow);
+        if (!changed) return;
+        Mask level = debounce.level();
+        pressed |= changed & level & (START | STOP);
+        // Фронт датчика чекає на читання, поки датчик не відпустить
+        sensorRising = (sensorRising & ~changed) | (changed & level & (SENSOR_1 | SENSOR_2));
+        // Датчик стабільно активний від останнього захопленого переходу
+        if (changed & level & SENSOR_1) {
+            SensorCapture::lastActivation(SensorCapture::SENSOR_1, sensor1Edge.position, sensor1Edge.micros);
+        }
+        if (changed & level & SENSOR_2) {
+            SensorCapture::lastActivation(SensorCapture::SENSOR_2, sensor2Edge.position, sensor2Edge.micros);
+        }
     }
 
     // --- Кнопки ---
-    bool startPressed()    { return handleButton(startBtn, startToggleState, config.startMode, config.invertStart); }
-    bool stopPressed()     { return handleButton(stopBtn, stopToggleState, config.stopMode, config.invertStop); }
+    bool startPressed()    { return handleButton(START, startToggleState, config.startMode, config.invertStart); }
+    bool stopPressed()     { return handleButton(STOP, stopToggleState, config.stopMode, config.invertStop); }
 
 
     // Доступ до станів кнопок у режимі TOGGLE
@@ -81,72 +128,59 @@ public:
 
     // --- Датчики ---
     // Датчик 1: наявність баночки під соплом розливу фарби
-    bool isSensor1Active() { return sensor1.current; }
+    bool isSensor1Active() { return debounce.level() & SENSOR_1; }
     // Датчик 2: наявність баночки під пресом закривання кришки
-    bool isSensor2Active() { return sensor2.current; }
+    bool isSensor2Active() { return debounce.level() & SENSOR_2; }
 
     // Події фронту (rising edge)
-    bool sensor1RisingEdge() { bool e = sensor1.rising; sensor1.rising = false; return e; }
-    bool sensor2RisingEdge() { bool e = sensor2.rising; sensor2.rising = false; return e; }
+    bool sensor1RisingEdge() { return takeEdge(sensorRising, SENSOR_1); }
+    bool sensor2RisingEdge() { return takeEdge(sensorRising, SENSOR_2); }
+
+    // Положення конвеєра (кроки StepEngine) на фронті, підтвердженому останнім RisingEdge
+    uint32_t sensor1EdgePosition() const { return sensor1Edge.position; }
+    uint32_t sensor2EdgePosition() const { return sensor2Edge.position; }
+    // Час цього фронту (micros())
+    unsigned long sensor1EdgeMicros() const { return sensor1Edge.micros; }
+    unsigned long sensor2EdgeMicros() const { return sensor2Edge.micros; }
     
 
 private:
-    static constexpr unsigned long debounceDelay = 50;
-
     ControlsConfig config;
 
-    ButtonState startBtn, stopBtn;
+    Debouncer<Mask, INPUT_COUNTER_BITS> debounce;
+    Mask activeLow = 0;             // входи, активні при LOW на піні
+    Mask pressed = 0;               // натиснення кнопок, ще не прочитані
+    Mask sensorRising = 0;          // фронти датчиків, ще не прочитані
+    unsigned long lastScan = 0;
+    Mask lastRaw = ~(Mask)0;        // остання вибірка, передана в InputTrace
+
     bool startToggleState = false;
     bool stopToggleState = false;
 
-    SensorState sensor1, sensor2;
-    
+    SensorEdge sensor1Edge, sensor2Edge;
 
-    void updateButton(uint8_t pin, ButtonState& btn) {
-        bool reading = (digitalRead(pin) == LOW);
-        if (reading != btn.last) {
-            btn.lastChange = millis();
-        }
-        if ((millis() - btn.lastChange) > debounceDelay) {
-            if (reading != btn.current) {
-                btn.current = reading;
-                if (btn.current) btn.pressedEvent = true;
-            }
-        }
-        btn.last = reading;
+    void configure(Mask input, const InputDebounce& d) {
+        debounce.configure(input, d.mode, (uint32_t)d.ms * 1000 / INPUT_SCAN_PERIOD_US);
     }
 
-    void updateSensor(uint8_t pin, SensorState& sensor, bool invert) {
-        // Читаємо сире значення (INPUT_PULLUP: активний = LOW)
-        bool rawReading = (digitalRead(pin) == LOW);
-        bool reading = invert ? !rawReading : rawReading;
-        
-        // Якщо значення змінилося - починаємо відлік часу антидребезгу
-        if (reading != sensor.last) {
-            sensor.lastChange = millis();
-        }
-        
-        // Перевіряємо, чи пройшов час антидребезгу
-        if ((millis() - sensor.lastChange) > SENSOR_DEBOUNCE_TIME_MS) {
-            if (reading != sensor.current) {
-                // Edge detection для rising edge (перехід з false на true)
-                sensor.rising = (!sensor.current && reading);
-                sensor.current = reading;
-            }
-        }
-        sensor.last = reading;
+    // Рівні входів у бітах InputTrace
+    static uint8_t traceLevels(Mask raw) {
+        return (raw & START ? InputTrace::IN_START : 0) | (raw & STOP ? InputTrace::IN_STOP : 0) |
+               (raw & SENSOR_1 ? InputTrace::IN_SENSOR_1 : 0) | (raw & SENSOR_2 ? InputTrace::IN_SENSOR_2 : 0);
     }
 
-    bool handleButton(ButtonState& btn, bool& toggleRef, ButtonMode mode, bool invert) {
+    static bool takeEdge(Mask& edges, Mask input) {
+        bool e = edges & input;
+        edges &= ~input;
+        return e;
+    }
+
+    bool handleButton(Mask button, bool& toggleRef, ButtonMode mode, bool invert) {
         // Stable logical level derived from debounced state
-        bool logicalLevel = invert ? !btn.current : btn.current;
+        bool current = debounce.level() & button;
+        bool logicalLevel = invert ? !current : current;
         if (mode == BUTTON_MOMENTARY) {
-            bool event = false;
-            if (btn.pressedEvent) {
-                btn.pressedEvent = false;
-                event = true;
-            }
-            return event;
+            return takeEdge(pressed, button);
         } else { // BUTTON_TOGGLE
             // Follow maintained switch level; report change on edges
             bool changed = (logicalLevel != toggleRef);
@@ -154,4 +188,4 @@ private:
             return changed;
         }
     }
-};
\ No newline at end of file
+};
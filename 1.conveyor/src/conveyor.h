@@ -1,14 +1,21 @@
 #pragma once
 #include <Arduino.h>
+#include <FixedKinematics.h>
 #include "pinout.h"
 #include "config.h"
+#include "step_engine.h"
+#include "fast_gpio.h"
+#include "telemetry.h"
 
 class Conveyor {
+    using EnablePin = FastPin<X_ENABLE_PIN>;
+    using DirPin = FastPin<X_DIR_PIN>;
+    using RunSignalPin = FastPin<START_CONVEYOR_PIN>;
+
 public:
     Conveyor() {}
 
     void begin() {
-        pinMode(X_STEP_PIN, OUTPUT);
         pinMode(X_DIR_PIN, OUTPUT);
         pinMode(X_ENABLE_PIN, OUTPUT);
         pinMode(START_CONVEYOR_PIN, OUTPUT);
@@ -18,136 +25,134 @@ public:
         // pinMode(Y_DIR_PIN, OUTPUT);
         // pinMode(Y_ENABLE_PIN, OUTPUT);
 
+        // STEP пін і Timer3 налаштовує генератор кроків
+        StepEngine::begin();
+
         disable();
         // Y motor disabled: set only X direction. To restore Y, pass MOTOR_Y_DIR
         setDirection(MOTOR_X_DIR, /* MOTOR_Y_DIR */ MOTOR_X_DIR);
 
         running = false;
         dociagActive = false;
-        dociagSteps = 0;
-        dociagDone = 0;
-        lastStepTime = 0;
-        stepState = false;
+        transit = false;
+        StepEngine::setCruiseLevel(RAMP_APPROACH_LEVEL_XY);
         updateConveyorSignal();
     }
 
     void enable() {
-        digitalWrite(X_ENABLE_PIN, LOW);
+        EnablePin::low();
         // Y motor disabled: share X driver
         // digitalWrite(Y_ENABLE_PIN, LOW);
     }
 
     void disable() {
-        digitalWrite(X_ENABLE_PIN, HIGH);
+        EnablePin::high();
         // Y motor disabled: share X driver
         // digitalWrite(Y_ENABLE_PIN, HIGH);
     }
 
     void setDirection(bool xDir, bool yDir) {
-        digitalWrite(X_DIR_PIN, xDir);
+        DirPin::write(xDir);
         // Y motor disabled: share X driver
         // digitalWrite(Y_DIR_PIN, yDir);
     }
 
-    // Запустити постійний рух
+    // Запустити постійний рух (з розгоном до швидкості, заданої scheduleSpeed())
     void start() {
-        Serial.println("Conveyor start() called");
         enable();
+        StepEngine::run();
         running = true;
         dociagActive = false;
         updateConveyorSignal();
-        Serial.println("Conveyor started successfully");
+        telemetry::log<telemetry::EV_CONVEYOR_STARTED>();
     }
 
-    // Зупинити негайно
+    // Зупинити негайно (пауза/стоп): без гальмування
     void stop() {
+        StepEngine::stop();
         running = false;
         dociagActive = false;
         disable();
         updateConveyorSignal();
     }
 
-    // Зупинка з дотягуванням (проїхати ще mm мм і зупинитись)
-    void stopWithDociag(float mm) {
-        if (mm <= 0) {
+    // Плавна зупинка: гальмування по таблиці розгону на найкоротшому шляху
+    void brake() {
+        if (!StepEngine::isMoving()) {
             stop();
             return;
         }
-        
-        // Додаткова діагностика
-        Serial.print("Conveyor stopWithDociag called with mm: ");
-        Serial.println(mm);
-        Serial.print("Current running state: ");
-        Serial.println(running);
-        Serial.print("Current dociagActive state: ");
-        Serial.println(dociagActive);
-        
+        StepEngine::brake();
+        dociagActive = true; // завершення фіксує update(), як і для дотягування
+        running = false;
+        updateConveyorSignal();
+    }
+
+    // Стати точно в положенні target (одометр). Якщо конвеєр стоїть, він доїде до цілі
+    // з розгоном; якщо вже їде — лише переплановується гальмування.
+    // false — ціль уже пройдено: гальмуємо якнайшвидше.
+    bool stopAt(uint32_t target) {
         // гарантуємо увімкнені драйвери для дотягування
         enable();
-        dociagSteps = (unsigned long)(mm * STEPS_PER_MM_XY);
-        dociagDone = 0;
+        // Рахунок кроків веде переривання таймера — без перезапуску, якщо вже їдемо.
+        if (!StepEngine::moveTo(target)) {
+            // Ціль уже позаду — зупиняємось якнайшвидше
+            brake();
+            telemetry::log<telemetry::EV_DOCIAG_TARGET_PASSED>(StepEngine::position() - target);
+            return false;
+        }
         dociagActive = true;
         running = false; // Зупиняємо основний рух, але дозволяємо дотягування
         updateConveyorSignal();
-        
-        Serial.print("Dociag steps calculated: ");
-        Serial.println(dociagSteps);
-        Serial.println("Conveyor stopWithDociag completed");
+        return true;
     }
 
-    // Основний update для генерації імпульсів
+    // Обслуговування з loop(): імпульси генерує Timer3, тут лише
+    // фіксуємо завершення дотягування
     void update() {
-        unsigned long now = micros();
-
-        // Якщо не рухаємося — нічого не робимо
-        if (!running && !dociagActive) return;
-
-        // Генеруємо імпульси з потрібною частотою
-        if (!stepState && (now - lastStepTime >= STEP_INTERVAL_XY_MICROS)) {
-            digitalWrite(X_STEP_PIN, HIGH);
-            // Y motor disabled: share X driver
-            // digitalWrite(Y_STEP_PIN, HIGH);
-            stepState = true;
-            lastStepTime = now;
-        } else if (stepState && (now - lastStepTime >= PULSE_WIDTH_MICROS)) {
-            digitalWrite(X_STEP_PIN, LOW);
-            // Y motor disabled: share X driver
-            // digitalWrite(Y_STEP_PIN, LOW);
-            stepState = false;
-            lastStepTime = now;
-
-            // Якщо дотягування — рахуємо кроки
-            if (dociagActive) {
-                dociagDone++;
-                if (dociagDone >= dociagSteps) {
-                    dociagActive = false;
-                    running = false;
-                    disable(); // Вимкнути драйвери після завершення дотягування
-                    updateConveyorSignal();
-                    Serial.println("Conveyor dociag completed - fully stopped");
-                }
-            }
+        if (dociagActive && !StepEngine::isMoving()) {
+            dociagActive = false;
+            running = false;
+            disable(); // Вимкнути драйвери після завершення дотягування
+            updateConveyorSignal();
+            telemetry::log<telemetry::EV_DOCIAG_COMPLETED>();
+        }
+    }
 
+    // Планування швидкості: nextTrigger — найраніший очікуваний фронт датчика (одометр),
+    // known = false — прогнозу немає. Транзитна швидкість тримається, лише поки до точки
+    // за APPROACH_DISTANCE_MM перед фронтом лишається більше за шлях гальмування з транзитної
+    // швидкості до швидкості підходу; далі — швидкість підходу, з якої розраховані дотягування.
+    void scheduleSpeed(bool known, uint32_t nextTrigger) {
+        bool fast = false;
+        if (known) {
+            uint32_t slowFrom = nextTrigger - APPROACH_STEPS - (RAMP_TRANSIT_LEVEL_XY - RAMP_APPROACH_LEVEL_XY);
+            fast = (int32_t)(slowFrom - odometer()) > 0;
         }
+        if (fast == transit) return;
+        transit = fast;
+        StepEngine::setCruiseLevel(fast ? RAMP_TRANSIT_LEVEL_XY : RAMP_APPROACH_LEVEL_XY);
+        telemetry::log<telemetry::EV_CONVEYOR_SPEED>(fast);
     }
 
+    // Одометр ременя: кроки з моменту ввімкнення (32 біти, різниця — через беззнакове віднімання)
+    uint32_t odometer() const { return StepEngine::position(); }
+
     bool isRunning() const { return running || dociagActive; }
     bool isDociagActive() const { return dociagActive; }
 
 private:
+    static constexpr uint32_t APPROACH_STEPS = kin::mmToSteps(APPROACH_DISTANCE_MM, STEPS_PER_MM_XY);
+
     // Оновлення сигналу START_CONVEYOR_PIN
     void updateConveyorSignal() {
         bool conveyorRunning = running || dociagActive;
-        digitalWrite(START_CONVEYOR_PIN, conveyorRunning ? HIGH : LOW);
+        RunSignalPin::write(conveyorRunning);
     }
     bool running = false;
     bool dociagActive = false;
-    unsigned long dociagSteps = 0;
-    unsigned long dociagDone = 0;
-
-    unsigned long lastStepTime = 0;
-    bool stepState = false;
+    bool transit = false;               // зараз задана транзитна швидкість
 };
 
 // Другий конвеєр (один двигун Z)
-// Клас другого конвеєра (Z) видалено — перенесено на інший контролер
\ No newline at end of file
+// Клас другого конвеєра (Z) видалено — перенесено на інший контролер
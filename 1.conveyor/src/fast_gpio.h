@@ -0,0 +1,143 @@
+#pragma once
+#include <Arduino.h>
+
+// Швидкий доступ до пінів без digitalWrite/digitalRead.
+//
+// Номер піна Arduino перетворюється на адресу регістра PINx і маску біта ще при
+// компіляції, тож FastPin<PIN>::high() для портів A–G стає однією інструкцією sbi,
+// а read() — sbic/sbis. Порти H, J, K, L на ATmega2560 лежать поза зоною sbi/cbi —
+// для них запис іде через lds/sts з короткою забороною переривань (атомарно).
+//
+// Інверсія логічного рівня (клапани з активним LOW) — параметр шаблону:
+// FastPin<PIN, true>::set(true) видає LOW.
+//
+// Режим піна (pinMode) налаштовується як і раніше в begin() — це не гаряча ділянка.
+// На невідомих платах (і поза AVR) усе падає назад на digitalWrite/digitalRead.
+
+// Необов'язковий пін, якого немає (наприклад, кінцевий датчик не встановлено)
+#define NO_PIN 255
+
+namespace fastgpio {
+
+// Адреси регістрів PINx у просторі даних AVR; DDRx = PINx + 1, PORTx = PINx + 2
+constexpr uint16_t PORT_NONE = 0;
+constexpr uint16_t PORT_A = 0x20;
+constexpr uint16_t PORT_B = 0x23;
+constexpr uint16_t PORT_C = 0x26;
+constexpr uint16_t PORT_D = 0x29;
+constexpr uint16_t PORT_E = 0x2C;
+constexpr uint16_t PORT_F = 0x2F;
+constexpr uint16_t PORT_G = 0x32;
+constexpr uint16_t PORT_H = 0x100;
+constexpr uint16_t PORT_J = 0x103;
+constexpr uint16_t PORT_K = 0x106;
+constexpr uint16_t PORT_L = 0x109;
+
+// Остання адреса, доступна для sbi/cbi/sbis/sbic (I/O 0x00–0x1F)
+constexpr uint16_t BIT_ADDRESSABLE_END = 0x3F;
+
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+#define FASTGPIO_SUPPORTED 1
+constexpr uint8_t PIN_COUNT = 70;
+// Таблиця відповідає variants/mega/pins_arduino.h
+constexpr uint16_t PIN_PORT[PIN_COUNT] = {
+    PORT_E, PORT_E, PORT_E, PORT_E, PORT_G, PORT_E, PORT_H, PORT_H, PORT_H, PORT_H,  //  0..9
+    PORT_B, PORT_B, PORT_B, PORT_B, PORT_J, PORT_J, PORT_H, PORT_H, PORT_D, PORT_D,  // 10..19
+    PORT_D, PORT_D, PORT_A, PORT_A, PORT_A, PORT_A, PORT_A, PORT_A, PORT_A, PORT_A,  // 20..29
+    PORT_C, PORT_C, PORT_C, PORT_C, PORT_C, PORT_C, PORT_C, PORT_C, PORT_D, PORT_G,  // 30..39
+    PORT_G, PORT_G, PORT_L, PORT_L, PORT_L, PORT_L, PORT_L, PORT_L, PORT_L, PORT_L,  // 40..49
+    PORT_B, PORT_B, PORT_B, PORT_B, PORT_F, PORT_F, PORT_F, PORT_F, PORT_F, PORT_F,  // 50..59
+    PORT_F, PORT_F, PORT_K, PORT_K, PORT_K, PORT_K, PORT_K, PORT_K, PORT_K, PORT_K   // 60..69
+};
+constexpr uint8_t PIN_BIT[PIN_COUNT] = {
+    0, 1, 4, 5, 5, 3, 3, 4, 5, 6,   //  0..9
+    4, 5, 6, 7, 1, 0, 1, 0, 3, 2,   // 10..19
+    1, 0, 0, 1, 2, 3, 4, 5, 6, 7,   // 20..29
+    7, 6, 5, 4, 3, 2, 1, 0, 7, 2,   // 30..39
+    1, 0, 7, 6, 5, 4, 3, 2, 1, 0,   // 40..49
+    3, 2, 1, 0, 0, 1, 2, 3, 4, 5,   // 50..59
+    6, 7, 0, 1, 2, 3, 4, 5, 6, 7    // 60..69
+};
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__)
+#define FASTGPIO_SUPPORTED 1
+constexpr uint8_t PIN_COUNT = 20;
+// Таблиця відповідає variants/standard/pins_arduino.h
+constexpr uint16_t PIN_PORT[PIN_COUNT] = {
+    PORT_D, PORT_D, PORT_D, PORT_D, PORT_D, PORT_D, PORT_D, PORT_D,  //  0..7
+    PORT_B, PORT_B, PORT_B, PORT_B, PORT_B, PORT_B,                  //  8..13
+    PORT_C, PORT_C, PORT_C, PORT_C, PORT_C, PORT_C                   // 14..19 (A0..A5)
+};
+constexpr uint8_t PIN_BIT[PIN_COUNT] = {
+    0, 1, 2, 3, 4, 5, 6, 7,
+    0, 1, 2, 3, 4, 5,
+    0, 1, 2, 3, 4, 5
+};
+#else
+#define FASTGPIO_SUPPORTED 0
+#endif
+
+#if FASTGPIO_SUPPORTED
+constexpr uint16_t pinRegister(uint8_t pin) { return pin < PIN_COUNT ? PIN_PORT[pin] : PORT_NONE; }
+constexpr uint8_t pinMask(uint8_t pin) { return pin < PIN_COUNT ? (uint8_t)(1 << PIN_BIT[pin]) : 0; }
+
+inline volatile uint8_t& reg(uint16_t address) {
+    return *reinterpret_cast<volatile uint8_t*>(address);
+}
+#endif
+
+} // namespace fastgpio
+
+template <uint8_t PIN, bool INVERTED = false>
+struct FastPin {
+#if FASTGPIO_SUPPORTED
+    static constexpr uint16_t PIN_REG = fastgpio::pinRegister(PIN);
+    static constexpr uint16_t PORT_REG = PIN_REG + 2;
+    static constexpr uint8_t MASK = fastgpio::pinMask(PIN);
+    static_assert(PIN_REG != fastgpio::PORT_NONE, "FastPin: пін відсутній на цій платі");
+
+    // Фізичний рівень на виході
+    static inline void high() {
+        if constexpr (PORT_REG <= fastgpio::BIT_ADDRESSABLE_END) {
+            fastgpio::reg(PORT_REG) |= MASK;
+        } else {
+            uint8_t sreg = SREG;
+            cli();
+            fastgpio::reg(PORT_REG) |= MASK;
+            SREG = sreg;
+        }
+    }
+
+    static inline void low() {
+        if constexpr (PORT_REG <= fastgpio::BIT_ADDRESSABLE_END) {
+            fastgpio::reg(PORT_REG) &= (uint8_t)~MASK;
+        } else {
+            uint8_t sreg = SREG;
+            cli();
+            fastgpio::reg(PORT_REG) &= (uint8_t)~MASK;
+            SREG = sreg;
+        }
+    }
+
+    // Запис 1 у PINx перемикає вихід апаратно (атомарно для будь-якого порту)
+    static inline void toggle() { fastgpio::reg(PIN_REG) = MASK; }
+
+    // Фізичний рівень на вході
+    static inline bool read() { return (fastgpio::reg(PIN_REG) & MASK) != 0; }
+#else
+    static inline void high() { digitalWrite(PIN, HIGH); }
+    static inline void low() { digitalWrite(PIN, LOW); }
+    static inline void toggle() { digitalWrite(PIN, digitalRead(PIN) == HIGH ? LOW : HIGH); }
+    static inline bool read() { return digitalRead(PIN) == HIGH; }
+#endif
+
+    static inline void write(bool level) {
+        if (level) high();
+        else low();
+    }
+
+    // Логічний стан з урахуванням інверсії
+    static inline void set(bool active) { write(active != INVERTED); }
+    static inline bool isActive() { return read() != INVERTED; }
+
+    static void mode(uint8_t pinModeValue) { pinMode(PIN, pinModeValue); }
+};
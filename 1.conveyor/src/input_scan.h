@@ -0,0 +1,214 @@
+#pragma once
+#include <Arduino.h>
+#include "fast_gpio.h"
+
+// Вибірка входів цілими портами і антидребезг вертикальними лічильниками.
+//
+// InputScan<PINS...>::sample() читає регістр PINx кожного порту, на якому є хоч один
+// із PINS, рівно один раз: усі входи знімаються в один момент, а вартість залежить від
+// кількості портів, а не входів. Біти лишаються на своїх місцях — порт k займає біти
+// 8k..8k+7 вектора (Mask — 8, 16 або 32 біти за кількістю портів), тож маска кожного
+// входу (mask<PIN>()) відома при компіляції.
+// Поза AVR (ArduinoNative) кожен пін читається digitalRead() у свій біт.
+//
+// Debouncer<Mask, BITS> — антидребезг усіх входів разом. На кожен біт вектора — лічильник
+// з BITS розрядів, розкладений «вертикально» по BITS словах: розряд i усіх лічильників
+// лежить у count[i], так само розкладено поріг кожного входу. Стратегія (DebounceMode) —
+// маска входів, тож update() — кілька логічних операцій над словами на розряд, скільки б
+// входів не було і як би вони не були налаштовані.
+
+namespace inputscan {
+
+constexpr uint8_t MAX_PORTS = 4;
+
+struct Ports {
+    uint16_t reg[MAX_PORTS];
+    uint8_t count;
+};
+
+#if FASTGPIO_SUPPORTED
+template <size_t N>
+constexpr Ports collectPorts(const uint8_t (&pins)[N]) {
+    Ports ports{};
+    for (size_t i = 0; i < N; i++) {
+        uint16_t reg = fastgpio::pinRegister(pins[i]);
+        bool known = false;
+        for (uint8_t k = 0; k < ports.count; k++) known = known || ports.reg[k] == reg;
+        if (!known && ports.count < MAX_PORTS) ports.reg[ports.count++] = reg;
+    }
+    return ports;
+}
+
+constexpr uint8_t portIndex(const Ports& ports, uint16_t reg) {
+    for (uint8_t k = 0; k < ports.count; k++) {
+        if (ports.reg[k] == reg) return k;
+    }
+    return MAX_PORTS;
+}
+#endif
+
+// Найменше беззнакове ціле на WIDTH біт: на AVR кожен зайвий байт маски — зайві такти
+template <bool FITS, typename Small, typename Large>
+struct Pick {
+    typedef Large type;
+};
+template <typename Small, typename Large>
+struct Pick<true, Small, Large> {
+    typedef Small type;
+};
+template <uint8_t WIDTH>
+struct MaskFor {
+    typedef typename Pick<(WIDTH <= 8), uint8_t, typename Pick<(WIDTH <= 16), uint16_t, uint32_t>::type>::type type;
+};
+
+template <size_t N>
+constexpr bool contains(const uint8_t (&pins)[N], uint8_t pin) {
+    for (size_t i = 0; i < N; i++) {
+        if (pins[i] == pin) return true;
+    }
+    return false;
+}
+
+} // namespace inputscan
+
+template <uint8_t... PINS>
+class InputScan {
+    static constexpr uint8_t LIST[] = {PINS...};
+
+#if FASTGPIO_SUPPORTED
+    static constexpr inputscan::Ports PORTS = inputscan::collectPorts(LIST);
+    static_assert(((inputscan::portIndex(PORTS, fastgpio::pinRegister(PINS)) < inputscan::MAX_PORTS) && ...),
+                  "InputScan: входи займають більше MAX_PORTS портів");
+
+    static constexpr uint8_t bitOf(uint8_t pin) {
+        return inputscan::portIndex(PORTS, fastgpio::pinRegister(pin)) * 8 + fastgpio::PIN_BIT[pin];
+    }
+    static constexpr uint8_t WIDTH = PORTS.count * 8;
+#else
+    static constexpr uint8_t WIDTH = sizeof...(PINS);
+    static constexpr uint8_t bitOf(uint8_t pin) {
+        for (uint8_t i = 0; i < sizeof(LIST); i++) {
+            if (LIST[i] == pin) return i;
+        }
+        return 0;
+    }
+#endif
+
+public:
+    typedef typename inputscan::MaskFor<WIDTH>::type Mask;
+
+    template <uint8_t PIN>
+    static constexpr Mask mask() {
+        static_assert(inputscan::contains(LIST, PIN), "InputScan: пін не входить до списку");
+        return (Mask)1 << bitOf(PIN);
+    }
+
+    static constexpr Mask ALL = (((Mask)1 << bitOf(PINS)) | ...);
+
+    // Фізичні рівні всіх входів (1 = HIGH)
+    static Mask sample() {
+#if FASTGPIO_SUPPORTED
+        Mask v = 0;
+        for (uint8_t k = 0; k < PORTS.count; k++) v |= (Mask)fastgpio::reg(PORTS.reg[k]) << (8 * k);
+        return v & ALL;
+#else
+        return ((digitalRead(PINS) == HIGH ? (Mask)1 << bitOf(PINS) : 0) | ...);
+#endif
+    }
+};
+
+enum DebounceMode : uint8_t {
+    DEBOUNCE_STABLE,        // новий рівень тримається N вибірок поспіль — лише тоді фронт
+    DEBOUNCE_LOCKOUT,       // фронт одразу на першій вибірці, далі N вибірок вхід не слухається
+    DEBOUNCE_INTEGRATOR     // лічильник +1 на активній вибірці, -1 на неактивній; фронт на N і на 0
+};
+
+template <typename Mask, uint8_t BITS>
+class Debouncer {
+public:
+    static constexpr uint16_t MAX_SAMPLES = (1u << BITS) - 1;
+
+    // Почати зі стану level без фронтів; усі входи — DEBOUNCE_STABLE на MAX_SAMPLES
+    void reset(Mask level) {
+        state = level;
+        lockout = integrator = 0;
+        for (uint8_t i = 0; i < BITS; i++) {
+            count[i] = 0;
+            threshold[i] = ~(Mask)0;
+        }
+    }
+
+    // Стратегія і поріг (1..MAX_SAMPLES вибірок) для входів inputs
+    void configure(Mask inputs, DebounceMode mode, uint16_t samples) {
+        if (samples < 1) samples = 1;
+        if (samples > MAX_SAMPLES) samples = MAX_SAMPLES;
+        lockout &= ~inputs;
+        integrator &= ~inputs;
+        if (mode == DEBOUNCE_LOCKOUT) lockout |= inputs;
+        if (mode == DEBOUNCE_INTEGRATOR) integrator |= inputs;
+        for (uint8_t i = 0; i < BITS; i++) {
+            threshold[i] = (samples >> i) & 1 ? threshold[i] | inputs : threshold[i] & ~inputs;
+            count[i] &= ~inputs;
+        }
+    }
+
+    // Нова вибірка; повертає маску входів, що змінили стан
+    Mask update(Mask sample) {
+        Mask stable = ~(lockout | integrator);
+        Mask delta = sample ^ state;
+        Mask idle = isZero();
+        Mask atThreshold = isThreshold();
+
+        // Що змінює стан одразу, і хто на цій вибірці рахує вгору/вниз
+        Mask leading = lockout & idle & delta;
+        Mask up = (stable & delta) | (lockout & ~idle) | leading | (integrator & sample & ~atThreshold);
+        Mask down = integrator & ~sample & ~idle;
+        step(up, down);
+
+        idle = isZero();
+        atThreshold = isThreshold();
+        Mask changed = leading |
+                       (stable & atThreshold) |
+                       (integrator & ((atThreshold & ~state) | (idle & state)));
+        state ^= changed;
+
+        // Скинути: стабільні — на старому рівні або після перемикання, блокування — після N вибірок
+        clear((stable & (~delta | atThreshold)) | (lockout & atThreshold));
+        return changed;
+    }
+
+    Mask level() const { return state; }
+
+private:
+    Mask state = 0;
+    Mask lockout = 0;
+    Mask integrator = 0;
+    Mask count[BITS] = {};
+    Mask threshold[BITS] = {};      // поріг кожного входу, розкладений так само вертикально
+
+    // +1 для входів up, -1 для down (up і down не перетинаються)
+    void step(Mask up, Mask down) {
+        for (uint8_t i = 0; i < BITS; i++) {
+            Mask c = count[i];
+            count[i] = c ^ up ^ down;
+            up &= c;
+            down &= ~c;
+        }
+    }
+
+    void clear(Mask inputs) {
+        for (uint8_t i = 0; i < BITS; i++) count[i] &= ~inputs;
+    }
+
+    Mask isZero() const {
+        Mask any = 0;
+        for (uint8_t i = 0; i < BITS; i++) any |= count[i];
+        return ~any;
+    }
+
+    Mask isThreshold() const {
+        Mask differs = 0;
+        for (uint8_t i = 0; i < BITS; i++) differs |= count[i] ^ threshold[i];
+        return ~differs;
+    }
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Запис входів і переходів станів для відтворення на ПК (tools/trace_replay).
+//
+// Кільце в RAM на INPUT_TRACE_SIZE записів по 6 байтів: момент micros() і подія —
+//  - нові фізичні рівні START, STOP, датчиків 1 і 2: кожна вибірка Controls, що відрізняється
+//    від попередньої (ще до антидребезгу — з дребезгом, як їх бачить прошивка);
+//  - новий стан станка, розливу або закривання (перевіряється на початку loop()).
+// Коли кільце повне, найстаріший запис витісняється, а його подія переходить у «базу» —
+// рівні й стани на момент перед першим збереженим записом, тож вивід завжди самодостатній.
+//
+// Команда Serial `trace` друкує базу і записи текстом, час — приростом від попереднього
+// запису (коротші рядки — швидший вивід). Пишуть лише Controls::update() і states() з loop(),
+// тож переривання не забороняються.
+
+class InputTrace {
+public:
+    // Біти рівнів входів (1 = HIGH на піні)
+    static constexpr uint8_t IN_START = 0x01;
+    static constexpr uint8_t IN_STOP = 0x02;
+    static constexpr uint8_t IN_SENSOR_1 = 0x04;
+    static constexpr uint8_t IN_SENSOR_2 = 0x08;
+    static constexpr uint8_t UNKNOWN = 0xFF;       // ще не записано (у базі — від увімкнення)
+
+    struct StateNames {
+        const char* const* machine;
+        const char* const* paint;
+        const char* const* cap;
+    };
+
+    // Нова вибірка входів (Controls::update())
+    static void inputs(uint8_t levels) {
+        if (levels == last[TRACE_INPUTS]) return;
+        last[TRACE_INPUTS] = levels;
+        append(TRACE_INPUTS, levels);
+    }
+
+    // Поточні стани (початок loop()); записуються лише зміни
+    static void states(uint8_t machine, uint8_t paint, uint8_t cap) {
+        if (machine != last[TRACE_MACHINE]) append(TRACE_MACHINE, last[TRACE_MACHINE] = machine);
+        if (paint != last[TRACE_PAINT]) append(TRACE_PAINT, last[TRACE_PAINT] = paint);
+        if (cap != last[TRACE_CAP]) append(TRACE_CAP, last[TRACE_CAP] = cap);
+    }
+
+    // Почати запис заново: база — поточні рівні й стани
+    static void clear() {
+        for (uint8_t k = 0; k < KINDS; k++) base[k] = last[k];
+        baseMicros = micros();
+        head = count = 0;
+        dropped = 0;
+    }
+
+    static void dump(Print& out, const StateNames& names) {
+        out.print("Trace: ");
+        out.print(count);
+        out.print(" records, ");
+        out.print(dropped);
+        out.println(" dropped");
+
+        out.print("base ");
+        out.print(baseMicros);
+        printEvent(out, names, TRACE_INPUTS, base[TRACE_INPUTS]);
+        for (uint8_t k = TRACE_MACHINE; k < KINDS; k++) printEvent(out, names, k, base[k]);
+        out.println();
+
+        uint32_t previous = baseMicros;
+        uint16_t i = (uint16_t)((head + INPUT_TRACE_SIZE - count) % INPUT_TRACE_SIZE);
+        for (uint16_t n = 0; n < count; n++) {
+            const Record& r = ring[i];
+            out.print('+');
+            out.print(r.micros - previous);
+            printEvent(out, names, r.kind, r.value);
+            out.println();
+            previous = r.micros;
+            if (++i == INPUT_TRACE_SIZE) i = 0;
+        }
+        out.println("end of trace");
+    }
+
+private:
+    enum Kind : uint8_t {
+        TRACE_INPUTS,
+        TRACE_MACHINE,
+        TRACE_PAINT,
+        TRACE_CAP,
+        KINDS
+    };
+
+    struct Record {
+        uint32_t micros;
+        uint8_t kind;
+        uint8_t value;
+    };
+
+    static inline Record ring[INPUT_TRACE_SIZE];
+    static inline uint16_t head = 0;                // куди піде наступний запис
+    static inline uint16_t count = 0;
+    static inline uint32_t dropped = 0;             // витіснено з кільця
+    static inline uint8_t last[KINDS] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+    static inline uint8_t base[KINDS] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+    static inline uint32_t baseMicros = 0;
+
+    static void append(uint8_t kind, uint8_t value) {
+        Record& r = ring[head];
+        if (count == INPUT_TRACE_SIZE) {
+            // Найстаріший запис (на місці нового) стає частиною бази
+            base[r.kind] = r.value;
+            baseMicros = r.micros;
+            dropped++;
+        } else {
+            count++;
+        }
+        r.micros = micros();
+        r.kind = kind;
+        r.value = value;
+        if (++head == INPUT_TRACE_SIZE) head = 0;
+    }
+
+    static void printEvent(Print& out, const StateNames& names, uint8_t kind, uint8_t value) {
+        if (kind == TRACE_INPUTS) {
+            out.print(" in ");
+            if (value == UNKNOWN) {
+                out.print('?');
+                return;
+            }
+            out.print(value & IN_START ? '1' : '0');
+            out.print(value & IN_STOP ? '1' : '0');
+            out.print(value & IN_SENSOR_1 ? '1' : '0');
+            out.print(value & IN_SENSOR_2 ? '1' : '0');
+            return;
+        }
+        const char* const* table = kind == TRACE_MACHINE ? names.machine : kind == TRACE_PAINT ? names.paint : names.cap;
+        out.print(' ');
+        out.print(value == UNKNOWN ? "?" : table[value]);
+    }
+};
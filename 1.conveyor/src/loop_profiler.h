@@ -0,0 +1,199 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "ramp_table.h"
+
+// Вимірювання тривалості ітерацій loop().
+//
+// Timer4 рахує вільно з переддільником 8 (0.5 мкс на тік), переповнення добираються
+// в перериванні до 32-бітного лічильника. LoopProfiler::mark() на початку loop() закриває
+// попередню ітерацію — від її початку до початку поточної, разом з обслуговуванням Serial
+// ядром Arduino між викликами loop(), — і запам'ятовує стани станка, розливу й закривання,
+// з якими починається нова. Статистика:
+//  - гістограма log2: кошик k — ітерації від 2^(k-1) до 2^k - 1 мкс, кошик 0 — менше 1 мкс;
+//  - найдовша ітерація з станами, у яких вона почалась, і моментом millis();
+//  - найдовша ітерація для кожної пари станів розливу й закривання.
+// Гарячий шлях має бути коротшим за інтервал кроку на найбільшій (транзитній) швидкості: тоді
+// loop() встигає реагувати на датчики і дотягування раніше, ніж конвеєр зробить наступний крок.
+//
+// Timer4 на Mega — це ШІМ пінів 6, 7, 8; вони працюють лише як цифрові виходи
+// (START_CONVEYOR_PIN, PNEUMATIC_5_PIN), тож analogWrite() на них не використовувати.
+// У збірці для ПК замість Timer4 — micros() віртуального годинника.
+
+class LoopProfiler {
+public:
+    static constexpr uint8_t BUCKETS = 20;        // останній кошик — від 2^18 мкс (262 мс) і довше
+    static constexpr uint8_t PAINT_STATES = 8;
+    static constexpr uint8_t CAP_STATES = 8;
+    static constexpr uint8_t TICKS_PER_US = F_CPU / 1000000UL / 8;
+
+    // Імена станів для dump(): масиви з main.cpp
+    struct StateNames {
+        const char* const* machine;
+        const char* const* paint;
+        const char* const* cap;
+    };
+
+    // Викликати першим рядком loop()
+    static void mark(uint8_t machineState, uint8_t paintState, uint8_t capState) {
+        uint32_t now = ticks();
+        if (started && !discarded) {
+            record((now - iterationStart) / TICKS_PER_US);
+        }
+        started = true;
+        discarded = false;
+        iterationStart = now;
+        machine = machineState;
+        paint = paintState;
+        cap = capState;
+    }
+
+    static void begin() {
+#if defined(__AVR__)
+        noInterrupts();
+        TCCR4A = 0;                     // звичайний режим, виходи OC4x відключені
+        TCCR4B = _BV(CS41);             // переддільник 8
+        TCNT4 = 0;
+        TIFR4 = _BV(TOV4);
+        TIMSK4 = _BV(TOIE4);
+        interrupts();
+#endif
+        reset();
+    }
+
+    static void reset() {
+        for (uint8_t i = 0; i < BUCKETS; i++) histogram[i] = 0;
+        for (uint8_t p = 0; p < PAINT_STATES; p++) {
+            for (uint8_t c = 0; c < CAP_STATES; c++) stateMax[p][c] = 0;
+        }
+        iterations = 0;
+        totalUs = 0;
+        worstUs = 0;
+        worstAtMs = 0;
+        worstMachine = worstPaint = worstCap = 0;
+    }
+
+    // Не враховувати поточну ітерацію (вивід звіту в Serial сам триває довго)
+    static void discardIteration() { discarded = true; }
+
+    static void dump(Print& out, const StateNames& names) {
+        out.print("Loop profile: ");
+        out.print(iterations);
+        out.print(" iterations, avg ");
+        out.print(iterations ? (float)totalUs / iterations : 0.0f, 1);
+        out.print(" us, step interval ");
+        out.print((float)RAMP_CRUISE_TICKS_XY / STEP_TIMER_TICKS_PER_US, 1);
+        out.println(" us");
+
+        for (uint8_t k = 0; k < BUCKETS; k++) {
+            if (!histogram[k]) continue;
+            out.print("  ");
+            if (k == 0) {
+                out.print("<1");
+            } else if (k == BUCKETS - 1) {
+                out.print(">=");
+                out.print(1UL << (k - 1));
+            } else {
+                out.print(1UL << (k - 1));
+                out.print("-");
+                out.print((1UL << k) - 1);
+            }
+            out.print(" us: ");
+            out.println(histogram[k]);
+        }
+
+        out.print("Worst: ");
+        out.print(worstUs);
+        out.print(" us at ");
+        out.print(worstAtMs);
+        out.print(" ms (");
+        out.print(names.machine[worstMachine]);
+        out.print(", ");
+        out.print(names.paint[worstPaint]);
+        out.print(", ");
+        out.print(names.cap[worstCap]);
+        out.println(")");
+
+        out.println("Worst per paint/cap state (us):");
+        for (uint8_t p = 0; p < PAINT_STATES; p++) {
+            for (uint8_t c = 0; c < CAP_STATES; c++) {
+                if (!stateMax[p][c]) continue;
+                out.print("  ");
+                out.print(names.paint[p]);
+                out.print(" + ");
+                out.print(names.cap[c]);
+                out.print(": ");
+                out.println(stateMax[p][c]);
+            }
+        }
+    }
+
+#if defined(__AVR__)
+    static void onOverflow() { overflows++; }
+#endif
+
+private:
+    static inline uint32_t histogram[BUCKETS] = {};
+    static inline uint32_t stateMax[PAINT_STATES][CAP_STATES] = {};
+    static inline uint32_t iterations = 0;
+    static inline uint64_t totalUs = 0;
+    static inline uint32_t worstUs = 0;
+    static inline uint32_t worstAtMs = 0;
+    static inline uint8_t worstMachine = 0;
+    static inline uint8_t worstPaint = 0;
+    static inline uint8_t worstCap = 0;
+    static inline bool discarded = false;
+    static inline bool started = false;
+    static inline uint32_t iterationStart = 0;
+    static inline uint8_t machine = 0;       // стани, з якими почалась поточна ітерація
+    static inline uint8_t paint = 0;
+    static inline uint8_t cap = 0;
+#if defined(__AVR__)
+    static inline volatile uint16_t overflows = 0;
+#endif
+
+    // Тіки Timer4 (0.5 мкс), 32 біти з урахуванням переповнень
+    static uint32_t ticks() {
+#if defined(__AVR__)
+        uint8_t sreg = SREG;
+        noInterrupts();
+        uint16_t low = TCNT4;
+        uint16_t high = overflows;
+        // Переповнення вже сталося, але переривання ще не обслуговане
+        if ((TIFR4 & _BV(TOV4)) && low < 0x8000) high++;
+        SREG = sreg;
+        return ((uint32_t)high << 16) | low;
+#else
+        return micros() * TICKS_PER_US;
+#endif
+    }
+
+    static uint8_t bucketOf(uint32_t us) {
+        uint8_t k = 0;
+        while (us && k < BUCKETS - 1) {
+            us >>= 1;
+            k++;
+        }
+        return k;
+    }
+
+    static void record(uint32_t us) {
+        histogram[bucketOf(us)]++;
+        iterations++;
+        totalUs += us;
+        if (paint < PAINT_STATES && cap < CAP_STATES && us > stateMax[paint][cap]) {
+            stateMax[paint][cap] = us;
+        }
+        if (us > worstUs) {
+            worstUs = us;
+            worstAtMs = millis();
+            worstMachine = machine;
+            worstPaint = paint;
+            worstCap = cap;
+        }
+    }
+};
+
+#if defined(__AVR__)
+ISR(TIMER4_OVF_vect) { LoopProfiler::onOverflow(); }
+#endif
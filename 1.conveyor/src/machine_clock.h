@@ -0,0 +1,172 @@
+#pragma once
+#include <Arduino.h>
+
+// Годинник станка і таймери на ньому.
+//
+// MachineClock — час станка в мс. Він іде лише тоді, коли станок працює: pause()
+// зупиняє його, resume() продовжує з того ж значення. Усі витримки (клапани, паузи
+// між кроками розливу й закривання) рахуються на цьому годиннику, тож пауза станка
+// заморожує їх без жодного ручного зсуву. Час 32-бітний і порівнюється лише
+// через різницю (int32_t)(a - b) — переповнення millis() через 49.7 доби нічого не ламає.
+//
+// MachineTimer — одноразовий або періодичний таймер з необов'язковим обробником.
+// Активні таймери лежать у хеш-колесі TimerWheel: слот = (момент спрацювання) % SLOTS,
+// по 1 мс на слот. TimerWheel::service() з loop() переглядає лише слоти мілісекунд,
+// що минули з попереднього виклику, а таймери далі ніж на оберт колеса чекають
+// у своєму слоті наступних обертів.
+
+class MachineClock {
+public:
+    static uint32_t now() { return paused ? pausedAt : (uint32_t)millis() - offset; }
+
+    static void pause() {
+        if (paused) return;
+        pausedAt = now();
+        paused = true;
+    }
+
+    static void resume() {
+        if (!paused) return;
+        offset = (uint32_t)millis() - pausedAt;
+        paused = false;
+    }
+
+    static bool isPaused() { return paused; }
+
+private:
+    static inline uint32_t offset = 0;
+    static inline uint32_t pausedAt = 0;
+    static inline bool paused = true;     // після ввімкнення станок зупинений
+};
+
+class MachineTimer {
+public:
+    typedef void (*Callback)(void* context);
+
+    MachineTimer() {}
+    MachineTimer(Callback cb, void* ctx) : callback(cb), context(ctx) {}
+
+    // Спрацювати через delayMs мс часу станка; periodMs > 0 — повторювати з цим періодом
+    void start(uint32_t delayMs, uint32_t periodMs = 0);
+    void cancel();
+
+    bool isActive() const { return active; }
+    // Скільки мс часу станка лишилось до спрацювання (0 — неактивний або вже час)
+    uint32_t remaining() const {
+        if (!active) return 0;
+        int32_t left = (int32_t)(due - MachineClock::now());
+        return left > 0 ? (uint32_t)left : 0;
+    }
+
+private:
+    friend class TimerWheel;
+
+    Callback callback = nullptr;
+    void* context = nullptr;
+    uint32_t due = 0;
+    uint32_t period = 0;
+    bool active = false;
+    uint8_t slot = 0;
+    MachineTimer* next = nullptr;
+};
+
+class TimerWheel {
+public:
+    static constexpr uint8_t SLOTS = 32;
+
+    // Викликати з кожної ітерації loop(): обробники спрацьовують тут, не в перериванні
+    static void service() {
+        if (!count) return;
+        uint32_t now = MachineClock::now();
+        if ((int32_t)(now - cursor) < 0) return;
+
+        // Мілісекунди від cursor до now включно; за більше ніж оберт — усі слоти один раз
+        uint32_t span = now - cursor + 1;
+        if (span > SLOTS) span = SLOTS;
+
+        MachineTimer** readyTail = &ready;
+        for (uint32_t i = 0; i < span; i++) {
+            MachineTimer** link = &slots[(cursor + i) % SLOTS];
+            while (*link) {
+                MachineTimer* t = *link;
+                if ((int32_t)(now - t->due) >= 0) {
+                    *link = t->next;          // вийняти зі слота
+                    t->next = nullptr;
+                    *readyTail = t;
+                    readyTail = &t->next;
+                    count--;
+                } else {
+                    link = &t->next;
+                }
+            }
+        }
+        cursor = now + 1;
+
+        // Обробники можуть перезапускати і скасовувати таймери (і ті, що чекають у ready) —
+        // слоти вже не обходяться
+        while (ready) {
+            MachineTimer* t = ready;
+            ready = t->next;
+            t->next = nullptr;
+            t->active = false;
+            if (t->period) {
+                t->due += t->period;
+                if ((int32_t)(now - t->due) >= 0) t->due = now + t->period;   // пропущені періоди не доганяємо
+                insert(*t);
+            }
+            if (t->callback) t->callback(t->context);
+        }
+    }
+
+    static uint8_t activeCount() { return count; }
+
+private:
+    friend class MachineTimer;
+
+    static inline MachineTimer* slots[SLOTS] = {};
+    static inline uint32_t cursor = 0;    // перша мілісекунда, ще не переглянута service()
+    static inline uint8_t count = 0;
+    static inline MachineTimer* ready = nullptr;   // настали в поточному service(), ще не виконані
+
+    static void insert(MachineTimer& t) {
+        if (!count) cursor = MachineClock::now();
+        // Момент, що вже минув, обслуговується найближчим service()
+        uint32_t slotTime = (int32_t)(t.due - cursor) < 0 ? cursor : t.due;
+        t.slot = slotTime % SLOTS;
+        t.next = slots[t.slot];
+        slots[t.slot] = &t;
+        t.active = true;
+        count++;
+    }
+
+    static void remove(MachineTimer& t) {
+        if (unlink(&slots[t.slot], t)) {
+            count--;
+        } else {
+            unlink(&ready, t);
+        }
+        t.active = false;
+    }
+
+    static bool unlink(MachineTimer** link, MachineTimer& t) {
+        for (; *link; link = &(*link)->next) {
+            if (*link == &t) {
+                *link = t.next;
+                t.next = nullptr;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+inline void MachineTimer::start(uint32_t delayMs, uint32_t periodMs) {
+    cancel();
+    due = MachineClock::now() + delayMs;
+    period = periodMs;
+    TimerWheel::insert(*this);
+}
+
+inline void MachineTimer::cancel() {
+    if (active) TimerWheel::remove(*this);
+}
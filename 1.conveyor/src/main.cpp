@@ -4,15 +4,29 @@
 #include "controls.h"
 #include "conveyor.h"
 #include "pneumatic_valve.h"
+#include "set_tracker.h"
+#include "machine_clock.h"
+#include "loop_profiler.h"
+#include "input_trace.h"
+#include "production_stats.h"
+#include "telemetry.h"
+#include "fast_gpio.h"
+#include <StallWatchdog.h>
+#include <LineBus.h>
 
 // Глобальні об'єкти
 Controls controls;
 Conveyor conveyor;
-PneumaticValve valve1(PNEUMATIC_1_PIN, true);  // інвертований сигнал
-PneumaticValve valve2(PNEUMATIC_2_PIN, true);  // другий пневмоциліндр для розливу фарби
-PneumaticValve valve3(PNEUMATIC_3_PIN, true);  // поршень фарби
-PneumaticValve valve4(PNEUMATIC_4_PIN);  // завертання кришок
-PneumaticValve valve5(PNEUMATIC_5_PIN);  // закривання кришок
+PneumaticValve<PNEUMATIC_1_PIN, true> valve1;  // інвертований сигнал
+PneumaticValve<PNEUMATIC_2_PIN, true> valve2;  // другий пневмоциліндр для розливу фарби
+PneumaticValve<PNEUMATIC_3_PIN, true, PAINT_PISTON_REED_PIN> valve3;  // поршень фарби
+PneumaticValve<PNEUMATIC_4_PIN> valve4;  // завертання кришок
+PneumaticValve<PNEUMATIC_5_PIN, false, CAP_CLOSE_REED_PIN> valve5;  // закривання кришок
+SetTracker sets;                         // спайки між датчиками 1 і 2
+ProductionStats stats;                   // лічильники виробництва (EEPROM)
+#if LINE_BUS_ENABLED
+LineBus lineBus(LINE_BUS_SERIAL, linebus::MASTER, LINE_BUS_DE_PIN);  // шина з малим конвеєром і пакуванням
+#endif
 
 // Стани станка
 enum MachineState {
@@ -25,7 +39,7 @@ enum MachineState {
 enum PaintState {
   P_IDLE,                 // очікування
   P_WAIT_SENSOR,          // очікування датчика 1
-  P_DOCIAG,               // дотяжка після датчика 1
+  P_DOCIAG,               // дотяжка після датчика 1 (до paintTarget)
   P_PISTON,               // робота поршня фарби (valve3)
   P_PISTON_2,             // робота другого поршня фарби (valve2)
   P_DELAY                 // затримка після розливання
@@ -34,29 +48,47 @@ enum PaintState {
 enum CapState {
   C_IDLE,                 // очікування
   C_WAIT_SENSOR,          // очікування датчика 2
+  C_BRAKE,                // гальмування до CAP_CENTERING_MM після датчика 2 (до capTarget)
   C_SCREW_ON,             // увімкнення завертання кришок
   C_SCREW_PAUSE,          // пауза перед закриванням
   C_CLOSE,                // закривання кришок
   C_CLOSE_PAUSE           // пауза після закривання
 };
 
+// Імена станів для звіту LoopProfiler (у порядку значень enum)
+const char* const MACHINE_STATE_NAMES[] = {"STOPPED", "RUNNING", "PAUSED"};
+const char* const PAINT_STATE_NAMES[] = {"P_IDLE", "P_WAIT_SENSOR", "P_DOCIAG", "P_PISTON", "P_PISTON_2", "P_DELAY"};
+const char* const CAP_STATE_NAMES[] = {"C_IDLE", "C_WAIT_SENSOR", "C_BRAKE", "C_SCREW_ON", "C_SCREW_PAUSE", "C_CLOSE", "C_CLOSE_PAUSE"};
+static_assert(P_DELAY < LoopProfiler::PAINT_STATES && C_CLOSE_PAUSE < LoopProfiler::CAP_STATES,
+              "Таблиця LoopProfiler замала для станів розливу/закривання");
+static_assert(WATCHDOG_EEPROM_ADDRESS >= STATS_EEPROM_START + STATS_EEPROM_SIZE ||
+              WATCHDOG_EEPROM_ADDRESS + sizeof(StallReport) <= STATS_EEPROM_START,
+              "Звіт сторожа перекриває кільце статистики в EEPROM");
+#if LINE_BUS_ENABLED && defined(__AVR__)
+static_assert(start_PIN != 18 && start_PIN != 19 && stop_PIN != 18 && stop_PIN != 19,
+              "LINE_BUS_ENABLED: Serial1 (піни 18/19) зайнятий кнопками start/stop — перенесіть їх у pinout.h");
+#endif
+
 // Глобальні змінні стану
 MachineState machineState = MACHINE_STOPPED;
 PaintState paintState = P_IDLE;
 CapState capState = C_IDLE;
 
-// Лічильники для ігнорування баночок
-int paintIgnoreCount = 0;
-int capIgnoreCount = 0;
-
-// Час паузи для синхронізації таймерів
-unsigned long pauseStartTime = 0;
-unsigned long pauseDuration = 0;
+// Де має стати конвеєр (одометр), щоб спайка була під соплом / під пресом.
+// Станції лише задають свою точку, саму зупинку планує arbitrateConveyor().
+const uint32_t JAR_CENTERING_STEPS = settrack::mmToSteps(JAR_CENTERING_MM);
+const uint32_t CAP_CENTERING_STEPS = settrack::mmToSteps(CAP_CENTERING_MM);
+const uint32_t STOP_COALESCE_STEPS = settrack::mmToSteps(STOP_COALESCE_MM);
+uint32_t paintTarget = 0;   // дійсне в P_DOCIAG
+uint32_t capTarget = 0;     // дійсне в C_BRAKE
+uint32_t plannedStop = 0;   // остання точка, задана конвеєру
+uint32_t trackingStart = 0; // одометр на пуску: з нього SetTracker знає всі спайки між датчиками
+const uint32_t SET_PITCH_STEPS = settrack::mmToSteps(SET_PITCH_MM);
 
-// Таймери для неблокуючих затримок
-unsigned long paintDelayStart = 0;
-unsigned long capScrewPauseStart = 0;
-unsigned long capClosePauseStart = 0;
+// Неблокуючі затримки на годиннику станка (на паузі стоять)
+MachineTimer paintDelayTimer;
+MachineTimer capScrewPauseTimer;
+MachineTimer capClosePauseTimer;
 
 // Оголошення функцій
 void handleStartStopButtons();
@@ -65,12 +97,17 @@ void handleCapOperations();
 void arbitrateConveyor();
 void updateMachineSignals();
 void updateLEDs();
-void pauseAllTimers();
-void resumeAllTimers();
-void shiftAllTimers();
+void cancelStationTimers();
+void checkSerialCommands();
+bool readCommandLine(String& line);
+bool stationInPosition(uint32_t target);
+uint32_t planStop(bool paintWaits, bool capWaits, uint32_t& first);
+void planConveyorSpeed();
+void printStrokeTimes(Print& out, const char* name, const StrokeTimes& t, uint16_t limit);
+void publishLineStatus();
 
 void setup() {
-  Serial.begin(9600);
+  Telemetry::begin();
   
   // Ініціалізація всіх компонентів
   controls.begin();
@@ -80,6 +117,8 @@ void setup() {
   valve3.begin();
   valve4.begin();
   valve5.begin();
+  LoopProfiler::begin();
+  stats.begin();
   
   // Налаштування сигнальних пінів
   pinMode(START_STOP_PIN, OUTPUT);
@@ -91,32 +130,51 @@ void setup() {
   digitalWrite(ledMode0Pin, LOW);
   digitalWrite(ledMode1Pin, HIGH); // станок зупинений
   
-  Serial.println("Machine initialized");
+#if LINE_BUS_ENABLED
+  LINE_BUS_SERIAL.begin(LINE_BUS_BAUD);
+  lineBus.begin(LINE_BUS_SLAVES, LINE_BUS_POLL_MS, LINE_BUS_REPLY_TIMEOUT_MS);
+#endif
+
+  telemetry::log<telemetry::EV_MACHINE_INITIALIZED>();
+
+  if (StallWatchdog::begin(WATCHDOG_STALL_MS, WATCHDOG_EEPROM_ADDRESS)) StallWatchdog::printReport(Telemetry::text());
 }
 
+// Окрема функція і при LTO: tools/avr_bench міряє період loop() за входом у неї
+void loop() __attribute__((noinline));
+
 void loop() {
+  // Закрити вимірювання попередньої ітерації і почати нове
+  LoopProfiler::mark(machineState, paintState, capState);
+  StallWatchdog::kick(machineState, paintState, capState);
+  InputTrace::states(machineState, paintState, capState);
+
   // Оновлення всіх компонентів
   controls.update();
   conveyor.update();
-  valve1.update();
-  valve2.update();
-  valve3.update();
-  valve4.update();
-  valve5.update();
+  // Таймери, чий час настав (клапани, затримки розливу й закривання)
+  TimerWheel::service();
+  stats.service();
+  Telemetry::service();
   
   // Обробка кнопок старт/стоп
   handleStartStopButtons();
   // Тримати вихідний сигнал у синхроні з поточним станом
   updateMachineSignals();
+  checkSerialCommands();
+#if LINE_BUS_ENABLED
+  // Опитування йде і на зупинці: наступні станції бачать, що станок стоїть
+  publishLineStatus();
+  lineBus.update();
+#endif
   
   // Якщо станок зупинений - нічого не робимо
   if (machineState == MACHINE_STOPPED) {
     return;
   }
   
-  // Якщо станок на паузі - зсуваємо таймери
+  // Якщо станок на паузі - годинник станка стоїть разом з усіма таймерами
   if (machineState == MACHINE_PAUSED) {
-    shiftAllTimers();
     return;
   }
   
@@ -124,6 +182,7 @@ void loop() {
   handlePaintOperations();
   handleCapOperations();
   arbitrateConveyor();
+  planConveyorSpeed();
 }
 
 // Обробка кнопок старт/стоп
@@ -132,23 +191,26 @@ void handleStartStopButtons() {
     if (machineState == MACHINE_STOPPED) {
       // Запуск станка
       machineState = MACHINE_RUNNING;
+      MachineClock::resume();
+      stats.onStart();
       paintState = P_IDLE;
       capState = C_IDLE;
-      paintIgnoreCount = 0;
-      capIgnoreCount = 0;
+      sets.clear();
+      trackingStart = conveyor.odometer();
       conveyor.start();
       // Імпульс на PNEUMATIC_1 після першого запуску та старту конвеєра
       valve1.onFor(PNEUMATIC1_ON_TIME_MS + PNEUMATIC1_HOLD_TIME_MS);
       updateMachineSignals();
       updateLEDs();
-      Serial.println("Machine started");
+      telemetry::log<telemetry::EV_MACHINE_STARTED>();
     } else if (machineState == MACHINE_PAUSED) {
       // Відновлення роботи після паузи
       machineState = MACHINE_RUNNING;
-      resumeAllTimers();
+      MachineClock::resume();
+      stats.onResume();
       updateMachineSignals();
       updateLEDs();
-      Serial.println("Machine resumed");
+      telemetry::log<telemetry::EV_MACHINE_RESUMED>();
     }
   }
   
@@ -156,12 +218,12 @@ void handleStartStopButtons() {
     if (machineState == MACHINE_RUNNING) {
       // Пауза станка
       machineState = MACHINE_PAUSED;
-      pauseStartTime = millis();
-      pauseAllTimers();
+      MachineClock::pause();
+      stats.onPause();
       conveyor.stop();
       updateMachineSignals();
       updateLEDs();
-      Serial.println("Machine paused");
+      telemetry::log<telemetry::EV_MACHINE_PAUSED>();
     } else if (machineState == MACHINE_PAUSED) {
       // Повна зупинка станка
       machineState = MACHINE_STOPPED;
@@ -173,9 +235,11 @@ void handleStartStopButtons() {
       valve3.off();
       valve4.off();
       valve5.off();
+      cancelStationTimers();
+      stats.onStop();
       updateMachineSignals();
       updateLEDs();
-      Serial.println("Machine stopped");
+      telemetry::log<telemetry::EV_MACHINE_STOPPED>();
     }
   }
 }
@@ -187,23 +251,20 @@ void handlePaintOperations() {
       paintState = P_WAIT_SENSOR;
       break;
     case P_WAIT_SENSOR:
-      if (controls.sensor1RisingEdge()) {
-        if (paintIgnoreCount == 0) {
-          conveyor.stopWithDociag(JAR_CENTERING_MM);
-          paintState = P_DOCIAG;
-        } else {
-          paintIgnoreCount--;
-        }
+      // Задні баночки спайки ігноруються за відстанню від передньої
+      if (controls.sensor1RisingEdge() && sets.onSensor1(controls.sensor1EdgePosition())) {
+        paintTarget = controls.sensor1EdgePosition() + JAR_CENTERING_STEPS;
+        paintState = P_DOCIAG;
       }
       break;
     case P_DOCIAG:
-      if (!conveyor.isRunning()) {
-        valve3.onFor(PAINT_PISTON_HOLD_TIME);
+      if (stationInPosition(paintTarget)) {
+        valve3.onForStroke(PAINT_PISTON_HOLD_TIME);
         paintState = P_PISTON;
       }
       break;
     case P_PISTON:
-      if (!valve3.isTimerActive()) {
+      if (valve3.strokeDone()) {
         // Після першого поршня включаємо другий
         valve2.onFor(PAINT_PISTON_2_HOLD_TIME);
         paintState = P_PISTON_2;
@@ -211,13 +272,13 @@ void handlePaintOperations() {
       break;
     case P_PISTON_2:
       if (!valve2.isTimerActive()) {
-        paintDelayStart = millis();
+        paintDelayTimer.start(50);
         paintState = P_DELAY;
       }
       break;
     case P_DELAY:
-      if (millis() - paintDelayStart >= 50) {
-        paintIgnoreCount = JARS_IN_SET - 1;
+      if (!paintDelayTimer.isActive()) {
+        stats.onSetPainted();
         paintState = P_WAIT_SENSOR;
               // Імпульс на PNEUMATIC_1 при відновленні руху
         valve1.onFor(PNEUMATIC1_ON_TIME_MS + PNEUMATIC1_HOLD_TIME_MS);
@@ -234,60 +295,154 @@ void handleCapOperations() {
       break;
     case C_WAIT_SENSOR:
       if (controls.sensor2RisingEdge()) {
-        if (capIgnoreCount == 0) {
-          conveyor.stop();
-          valve4.on();
-          capState = C_SCREW_ON;
-        } else {
-          capIgnoreCount--;
+        SetTracker::Sensor2Match match = sets.onSensor2(controls.sensor2EdgePosition());
+        if (match == SetTracker::S2_LEADING || match == SetTracker::S2_UNKNOWN) {
+          capTarget = controls.sensor2EdgePosition() + CAP_CENTERING_STEPS;
+          capState = C_BRAKE;
+        } else if (match == SetTracker::S2_MISSED) {
+          // Передню баночку датчик пропустив — по задній кришки не вирівняти
+          telemetry::log<telemetry::EV_CAP_SET_MISSED>();
         }
       }
+      // Спайки, що пройшли датчик 2, прибираються з обліку
+      if (uint8_t lost = sets.update(conveyor.odometer())) {
+        telemetry::log<telemetry::EV_CAP_SET_LOST>(lost);
+      }
+      break;
+    case C_BRAKE:
+      if (stationInPosition(capTarget)) {
+        valve4.on();
+        capState = C_SCREW_ON;
+      }
       break;
     case C_SCREW_ON:
-      capScrewPauseStart = millis();
+      capScrewPauseTimer.start(STEP_PAUSE_CAP_SCREW_MS);
       capState = C_SCREW_PAUSE;
       break;
     case C_SCREW_PAUSE:
-      if (millis() - capScrewPauseStart >= STEP_PAUSE_CAP_SCREW_MS) {
-        valve5.onFor(CLOSE_CAP_HOLD_TIME);
+      if (!capScrewPauseTimer.isActive()) {
+        valve5.onForStroke(CLOSE_CAP_HOLD_TIME);
         capState = C_CLOSE;
       }
       break;
     case C_CLOSE:
-      if (!valve5.isTimerActive()) {
-        capClosePauseStart = millis();
+      if (valve5.strokeDone()) {
+        capClosePauseTimer.start(STEP_PAUSE_CAP_CLOSE_MS);
         capState = C_CLOSE_PAUSE;
       }
       break;
     case C_CLOSE_PAUSE:
-      if (millis() - capClosePauseStart >= STEP_PAUSE_CAP_CLOSE_MS) {
+      if (!capClosePauseTimer.isActive()) {
         valve4.off();
-        capIgnoreCount = JARS_IN_SET - 1;
+        stats.onSetCapped();
         capState = C_WAIT_SENSOR;
       }
       break;
   }
 }
 
-// Арбітраж керування конвеєром: обидві підсистеми мають рівні права зупинки
+// Арбітраж керування конвеєром: обидві підсистеми мають рівні права зупинки.
+// Поки станція працює — конвеєр стоїть. Станції, що чекають на свою спайку (P_DOCIAG,
+// C_BRAKE), задають точку зупинки, і конвеєр їде до найближчої з них (planStop()).
 void arbitrateConveyor() {
   if (machineState != MACHINE_RUNNING) return;
-  if (conveyor.isDociagActive()) return; // дотягування триває — не втручатися
 
-  bool paintRequiresStop = (paintState == P_DOCIAG || paintState == P_PISTON || paintState == P_PISTON_2 || paintState == P_DELAY);
-  bool capRequiresStop = (capState == C_SCREW_ON || capState == C_SCREW_PAUSE || capState == C_CLOSE || capState == C_CLOSE_PAUSE);
+  bool paintBusy = (paintState == P_PISTON || paintState == P_PISTON_2 || paintState == P_DELAY);
+  bool capBusy = (capState == C_SCREW_ON || capState == C_SCREW_PAUSE || capState == C_CLOSE || capState == C_CLOSE_PAUSE);
+  if (paintBusy || capBusy) {
+    if (conveyor.isRunning() && !conveyor.isDociagActive()) {
+      conveyor.brake();
+    }
+    return;
+  }
 
-  bool shouldRun = !(paintRequiresStop || capRequiresStop);
+  bool paintWaits = paintState == P_DOCIAG;
+  bool capWaits = capState == C_BRAKE;
+  if (!paintWaits && !capWaits) {
+    if (!conveyor.isRunning()) {
+      conveyor.start();
+    }
+    return;
+  }
 
-  if (!shouldRun) {
-    if (conveyor.isRunning()) {
-      conveyor.stop();
+  uint32_t first;
+  uint32_t target = planStop(paintWaits, capWaits, first);
+  if ((int32_t)(target - conveyor.odometer()) <= 0) {
+    // Точку вже досягнуто або пройдено (фронт прийшов запізно) — стати якнайшвидше
+    if (conveyor.isRunning() && !conveyor.isDociagActive()) conveyor.brake();
+  } else if (!conveyor.isDociagActive() || target != plannedStop) {
+    // Нова точка або рух до неї перервано паузою
+    uint32_t ahead = target - conveyor.odometer();
+    if (conveyor.stopAt(target)) {
+      telemetry::log<telemetry::EV_STOP_PLANNED>(ahead, paintWaits, capWaits);
+      if (target != first && target != plannedStop) {
+        telemetry::log<telemetry::EV_STOP_COALESCED>((float)(target - first) / STEPS_PER_MM_XY);
+      }
+    }
+  }
+  plannedStop = target;
+}
+
+// Спайка станції стоїть на місці: конвеєр зупинився в її точці або пройшов її
+bool stationInPosition(uint32_t target) {
+  return !conveyor.isRunning() && (int32_t)(conveyor.odometer() - target) >= 0;
+}
+
+// Точка зупинки: найближча з точок станцій, що чекають. Якщо інша станція стане на місце
+// не далі ніж через STOP_COALESCE_STEPS після неї, конвеєр їде далі до тієї точки і обидві
+// станції працюють за одну зупинку. Інша станція — це або вже задана точка, або спайка,
+// яку SetTracker чекає на датчику 2: тоді її точка лише розрахункова, тож конвеєр
+// доїжджає не далі за розрахунок плюс допуск приходу, а справжній фронт датчика 2
+// уточнює зупинку. first — найближча точка; відмінна від неї відповідь — зупинки об'єднано.
+uint32_t planStop(bool paintWaits, bool capWaits, uint32_t& first) {
+  uint32_t odometer = conveyor.odometer();
+  uint32_t other = 0;
+  bool haveOther = false;
+  bool expected = false;
+
+  if (paintWaits && capWaits) {
+    bool paintFirst = (int32_t)(paintTarget - odometer) <= (int32_t)(capTarget - odometer);
+    first = paintFirst ? paintTarget : capTarget;
+    other = paintFirst ? capTarget : paintTarget;
+    haveOther = true;
+  } else if (paintWaits) {
+    first = paintTarget;
+    uint32_t arrival;
+    if (capState == C_WAIT_SENSOR && sets.nextSensor2Arrival(arrival)) {
+      other = arrival + CAP_CENTERING_STEPS;
+      haveOther = true;
+      expected = true;
     }
   } else {
-    if (!conveyor.isRunning()) {
-      conveyor.start();
+    first = capTarget;
+  }
+
+  if (!haveOther) return first;
+  int32_t spread = (int32_t)(other - first);
+  if (spread < 0 || spread > (int32_t)STOP_COALESCE_STEPS) return first;
+  if (!expected) return other;
+  uint32_t limit = first + STOP_COALESCE_STEPS;
+  uint32_t latest = other + settrack::ARRIVAL_TOLERANCE_STEPS;
+  return (int32_t)(latest - limit) < 0 ? latest : limit;
+}
+
+// Швидкість конвеєра за прогнозом найранішого фронту датчиків: наступна спайка на датчику 1
+// не раніше ніж через SET_PITCH_MM після останньої, на датчику 2 — за обліком SetTracker.
+// Одразу після пуску між датчиками можуть бути спайки поза обліком, тож прогнозу немає,
+// доки ремінь не пройде відстань між датчиками.
+void planConveyorSpeed() {
+  uint32_t odometer = conveyor.odometer();
+  uint32_t next;
+  bool known = odometer - trackingStart >= settrack::SENSOR1_TO_SENSOR2_STEPS && sets.lastSensor1(next);
+  if (known) {
+    next += SET_PITCH_STEPS;
+    uint32_t arrival;
+    if (sets.nextSensor2Arrival(arrival)) {
+      arrival -= settrack::ARRIVAL_TOLERANCE_STEPS;
+      if ((int32_t)(arrival - odometer) < (int32_t)(next - odometer)) next = arrival;
     }
   }
+  conveyor.scheduleSpeed(known, next);
 }
 
 // Оновлення сигналів станка
@@ -296,12 +451,9 @@ void updateMachineSignals() {
   // і LOW коли зупинений (STOPPED) або на паузі (PAUSED).
   static MachineState lastState = MACHINE_STOPPED;
   bool machineActive = (machineState == MACHINE_RUNNING);
-  digitalWrite(START_STOP_PIN, machineActive ? HIGH : LOW);
+  FastPin<START_STOP_PIN>::write(machineActive);
   if (machineState != lastState) {
-    Serial.print("updateMachineSignals: state=");
-    Serial.print(machineState == MACHINE_STOPPED ? "STOPPED" : machineState == MACHINE_RUNNING ? "RUNNING" : "PAUSED");
-    Serial.print(", pin=");
-    Serial.println(machineActive ? "HIGH" : "LOW");
+    telemetry::log<telemetry::EV_MACHINE_SIGNAL>((uint8_t)machineState, machineActive);
     lastState = machineState;
   }
 }
@@ -317,28 +469,123 @@ void updateLEDs() {
   }
 }
 
-// Пауза всіх таймерів
-void pauseAllTimers() {
-  pauseStartTime = millis();
-  // Таймери пневмоклапанів автоматично зсуваються в update()
+// Стан станка для шини лінії: малий конвеєр отримує його в кожному опитуванні.
+// Прогноз «JARS_IN_SET баночок через T мс» — за середнім циклом спайки поточної зміни
+void publishLineStatus() {
+#if LINE_BUS_ENABLED
+  static unsigned long lastMs = 0;
+  if (millis() - lastMs < LINE_BUS_POLL_MS) return;
+  lastMs = millis();
+
+  StationStatus& s = lineBus.local();
+  s.state = machineState;
+  s.flags = 0;
+  if (machineState == MACHINE_RUNNING) s.flags |= linebus::RUNNING;
+  if (paintState > P_WAIT_SENSOR || capState > C_WAIT_SENSOR) s.flags |= linebus::BUSY;
+  s.counter = (uint16_t)stats.setsCapped();
+  uint32_t eta;
+  bool known = machineState == MACHINE_RUNNING && stats.nextSetEtaMs(eta);
+  s.incoming = known ? JARS_IN_SET : 0;
+  s.etaMs = !known ? linebus::ETA_UNKNOWN : eta < linebus::ETA_UNKNOWN ? (uint16_t)eta : linebus::ETA_UNKNOWN - 1;
+#endif
+}
+
+// Скасувати неблокуючі затримки станцій (повна зупинка)
+void cancelStationTimers() {
+  paintDelayTimer.cancel();
+  capScrewPauseTimer.cancel();
+  capClosePauseTimer.cancel();
 }
 
-// Відновлення всіх таймерів
-void resumeAllTimers() {
-  pauseDuration = millis() - pauseStartTime;
-  valve1.shiftTimers(pauseDuration);
-  valve2.shiftTimers(pauseDuration);
-  valve3.shiftTimers(pauseDuration);
-  valve4.shiftTimers(pauseDuration);
-  valve5.shiftTimers(pauseDuration);
-  
-  // Зсуваємо неблокуючі таймери
-  paintDelayStart += pauseDuration;
-  capScrewPauseStart += pauseDuration;
-  capClosePauseStart += pauseDuration;
+// Рядок команди набирається з того, що вже прийшло, без очікування: readStringUntil()
+// чекав би кінця рядка до 1 с усередині ітерації. true — рядок завершено '\n'
+bool readCommandLine(String& line) {
+  static char buffer[24];
+  static uint8_t length = 0;
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\n') {
+      buffer[length] = '\0';
+      line = buffer;
+      length = 0;
+      return true;
+    }
+    if (length < sizeof(buffer) - 1) buffer[length++] = c;   // довший рядок обрізається
+  }
+  return false;
 }
 
-// Зсув таймерів під час паузи
-void shiftAllTimers() {
-  // Таймери автоматично зсуваються в update() пневмоклапанів
-}
\ No newline at end of file
+// Команди з Serial (відповіді — текстом у потоці телеметрії)
+void checkSerialCommands() {
+  String command;
+  if (readCommandLine(command)) {
+    command.trim();
+    Print& out = Telemetry::text();
+
+    if (command == "loop") {
+      LoopProfiler::dump(out, {MACHINE_STATE_NAMES, PAINT_STATE_NAMES, CAP_STATE_NAMES});
+    } else if (command == "loop:reset") {
+      LoopProfiler::reset();
+      out.println("Loop profile reset");
+    } else if (command == "stats") {
+      stats.print(out);
+    } else if (command == "shift:new") {
+      stats.print(out);
+      stats.newShift();
+      out.println("New shift started");
+    } else if (command == "strokes") {
+      out.println("Strokes (ms): count last min/avg/max limit timeouts");
+      if (valve3.HAS_REED) printStrokeTimes(out, "paint piston", valve3.strokeTimes(), PAINT_PISTON_HOLD_TIME);
+      if (valve5.HAS_REED) printStrokeTimes(out, "cap close", valve5.strokeTimes(), CLOSE_CAP_HOLD_TIME);
+    } else if (command == "strokes:reset") {
+      valve3.resetStrokeTimes();
+      valve5.resetStrokeTimes();
+      out.println("Stroke statistics reset");
+    } else if (command == "trace") {
+      InputTrace::dump(out, {MACHINE_STATE_NAMES, PAINT_STATE_NAMES, CAP_STATE_NAMES});
+    } else if (command == "trace:clear") {
+      InputTrace::clear();
+      out.println("Trace cleared");
+#if LINE_BUS_ENABLED
+    } else if (command == "bus") {
+      lineBus.printStats(out);
+#endif
+    } else if (command == "help") {
+      out.println("Commands:");
+      out.println("loop - loop() timing histogram and worst iteration");
+      out.println("loop:reset - clear loop() timing statistics");
+      out.println("stats - production counters: lifetime and current shift");
+      out.println("shift:new - print and close the current shift, start a new one");
+      out.println("strokes - measured stroke times of valves with end-of-stroke sensors");
+      out.println("strokes:reset - clear stroke statistics");
+      out.println("trace - recorded input edges and state transitions");
+      out.println("trace:clear - start a new trace from the current state");
+#if LINE_BUS_ENABLED
+      out.println("bus - line bus link and the last status of the small conveyor and packaging");
+#endif
+      out.println("help - show this help");
+    }
+    // Відповідь триває довше за будь-яку робочу ітерацію
+    LoopProfiler::discardIteration();
+  }
+}
+
+// Рядок звіту strokes для одного клапана з кінцевим датчиком
+void printStrokeTimes(Print& out, const char* name, const StrokeTimes& t, uint16_t limit) {
+  out.print("  ");
+  out.print(name);
+  out.print(": ");
+  out.print(t.count);
+  out.print(" ");
+  out.print(t.lastMs);
+  out.print(" ");
+  out.print(t.minMs);
+  out.print("/");
+  out.print(t.count ? t.sumMs / t.count : 0);
+  out.print("/");
+  out.print(t.maxMs);
+  out.print(" ");
+  out.print(limit);
+  out.print(" ");
+  out.println(t.timeouts);
+}
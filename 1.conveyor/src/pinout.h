@@ -10,6 +10,7 @@
 //сигнали для інщих контролерів
 #define START_STOP_PIN     11  // сигнал для старту/стопу іншого контролера 
 #define START_CONVEYOR_PIN     6 // сигнал коли конвеєр рухається
+#define LINE_BUS_DE_PIN        3 // DE/RE трансивера RS-485 шини лінії (на платі як X_MIN_PIN)
 // мотор конвеєра x 
 #define X_STEP_PIN         54
 #define X_DIR_PIN          55
@@ -19,6 +20,10 @@
 #define sensor_1          14 //датчик наявності баночки під соплом роливу фарби(на платі як Y_MIN_PIN)
 #define sensor_2          15 //датчик наявності баночки під прессом закривання кришки(на платі як Y_MAX_PIN)
 
+// кінцеві датчики ходу (геркони, замикають на GND); NO_PIN — датчика немає, хід за часом
+#define PAINT_PISTON_REED_PIN  NO_PIN // поршень фарби в кінці ходу (розподілювач №3)
+#define CAP_CLOSE_REED_PIN     NO_PIN // прес закривання кришок опущений (розподілювач №5)
+
 // панель управління
 #define start_PIN         18 // кнопка для запуску станка  підключено до Z_MIN_PIN
 #define stop_PIN          19 // кнопка для зупинки станка  підключено до Z_MAX_PIN
@@ -2,63 +2,110 @@
 #define PNEUMATIC_VALVE_H
 
 #include <Arduino.h>
+#include "fast_gpio.h"
+#include "machine_clock.h"
+#include "telemetry.h"
 
+// Фактичні часи ходу циліндра до кінцевого датчика (мс часу станка)
+struct StrokeTimes {
+    uint16_t count;
+    uint16_t timeouts;
+    uint16_t lastMs;
+    uint16_t minMs;
+    uint16_t maxMs;
+    uint32_t sumMs;
+
+    void add(uint16_t ms) {
+        if (!count || ms < minMs) minMs = ms;
+        if (ms > maxMs) maxMs = ms;
+        lastMs = ms;
+        sumMs += ms;
+        count++;
+    }
+};
+
+// PIN та інверсія відомі при компіляції: on()/off() — один запис у порт.
+// Витримки onFor()/offFor() рахує MachineTimer на годиннику станка: на паузі вони
+// стоять самі, а авто-дію виконує TimerWheel::service() з loop().
+//
+// REED_PIN — необов'язковий кінцевий датчик ходу (геркон на GND, INPUT_PULLUP).
+// onForStroke(limit) вмикає клапан до підтвердження кінця ходу: strokeDone() з loop()
+// вимикає клапан, щойно датчик спрацював, і записує час ходу. Якщо за limit датчик не
+// спрацював, клапан вимикається за часом, як onFor(), а хід рахується як таймаут.
+// Без датчика onForStroke() — те саме, що onFor().
+template <uint8_t PIN, bool INVERTED = false, uint8_t REED_PIN = NO_PIN>
 class PneumaticValve {
   public:
-    PneumaticValve(uint8_t pin, bool inverted = false) : _pin(pin), _inverted(inverted) {}
+    using Pin = FastPin<PIN, INVERTED>;
+
+    PneumaticValve() : _timer(onTimer, this) {}
+
+    static constexpr bool HAS_REED = REED_PIN != NO_PIN;
 
     void begin() {
-      pinMode(_pin, OUTPUT);
+      Pin::mode(OUTPUT);
+      if constexpr (HAS_REED) FastPin<REED_PIN>::mode(INPUT_PULLUP);
       off();
     }
 
     void on() {
-      digitalWrite(_pin, _inverted ? LOW : HIGH);
+      Pin::set(true);
       _state = true;
-      _autoOff = false;
+      _timer.cancel();
+      _stroke = STROKE_NONE;
     }
 
     void off() {
-      digitalWrite(_pin, _inverted ? HIGH : LOW);
+      Pin::set(false);
       _state = false;
-      _autoOff = false;
+      _timer.cancel();
+      _stroke = STROKE_NONE;
     }
 
-    // Включити клапан на певний час (мс), потім автоматично вимкнути
+    // Включити клапан на певний час (мс часу станка), потім автоматично вимкнути
     void onFor(unsigned long duration) {
       on();
-      _autoOff = true;
-      _offTime = millis() + duration;
       _pendingAction = 0; // 0 - після таймера вимкнути
+      _timer.start(duration);
     }
 
-    // Вимкнути клапан на певний час (мс), потім автоматично увімкнути
+    // Вимкнути клапан на певний час (мс часу станка), потім автоматично увімкнути
     void offFor(unsigned long duration) {
       off();
-      _autoOff = true;
-      _offTime = millis() + duration;
       _pendingAction = 1; // 1 - після таймера увімкнути
+      _timer.start(duration);
     }
 
-    // Викликати цю функцію в loop() для обслуговування таймера
-    void update() {
-      if (_autoOff && millis() >= _offTime) {
-        if (_pendingAction == 0) {
-          off();
-        } else if (_pendingAction == 1) {
-          on();
-        }
-        _autoOff = false;
+    // Увімкнути до кінця ходу, але не довше за limit (мс часу станка)
+    void onForStroke(unsigned long limit) {
+      onFor(limit);
+      if constexpr (HAS_REED) {
+        // Датчик, активний ще до ходу, має спершу відпуститися — інакше залиплий геркон
+        // «підтверджував» би кожен хід миттєво
+        _stroke = reedActive() ? STROKE_LEAVING : STROKE_MOVING;
+        _strokeStart = MachineClock::now();
+        _strokeLimit = limit;
       }
     }
 
-    // Змістити таймер авто-дії на паузу (для коректного пауза/резюме)
-    void shiftTimers(unsigned long deltaMs) {
-      if (_autoOff) {
-        _offTime += deltaMs;
+    // Хід onForStroke() завершено: датчик підтвердив кінець ходу або вийшов час
+    bool strokeDone() {
+      if constexpr (HAS_REED) {
+        if (_stroke == STROKE_LEAVING && !reedActive()) {
+          _stroke = STROKE_MOVING;
+        } else if (_stroke == STROKE_MOVING && reedActive()) {
+          uint16_t ms = MachineClock::now() - _strokeStart;
+          off();
+          _times.add(ms);
+          telemetry::log<telemetry::EV_STROKE_CONFIRMED>(PIN, ms);
+        }
       }
+      return !_timer.isActive();
     }
 
+    const StrokeTimes& strokeTimes() const { return _times; }
+    void resetStrokeTimes() { _times = StrokeTimes(); }
+
     void toggle() {
       if (_state) off();
       else on();
@@ -70,20 +117,41 @@ class PneumaticValve {
 
     // Чи активний таймер авто-дії (onFor/offFor ще не завершився)
     bool isTimerActive() const {
-      return _autoOff;
+      return _timer.isActive();
     }
 
     uint8_t getPin() const {
-      return _pin;
+      return PIN;
     }
 
   private:
-    uint8_t _pin;
+    enum StrokeState : uint8_t { STROKE_NONE, STROKE_LEAVING, STROKE_MOVING };
+
+    static bool reedActive() {
+      if constexpr (HAS_REED) return !FastPin<REED_PIN>::read();
+      else return false;
+    }
+
+    static void onTimer(void* self) {
+      PneumaticValve* valve = static_cast<PneumaticValve*>(self);
+      if (valve->_stroke != STROKE_NONE) {
+        valve->_times.timeouts++;
+        telemetry::log<telemetry::EV_STROKE_TIMEOUT>(PIN, valve->_strokeLimit);
+      }
+      if (valve->_pendingAction == 0) {
+        valve->off();
+      } else {
+        valve->on();
+      }
+    }
+
     bool _state = false;
-    bool _autoOff = false;
-    unsigned long _offTime = 0;
+    MachineTimer _timer;
     uint8_t _pendingAction = 0; // 0 - off після onFor, 1 - on після offFor
-    bool _inverted = false;
+    StrokeState _stroke = STROKE_NONE;
+    uint32_t _strokeStart = 0;
+    uint16_t _strokeLimit = 0;
+    StrokeTimes _times = StrokeTimes();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,317 @@
+#pragma once
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <stddef.h>
+#include "config.h"
+#include "machine_clock.h"
+
+// Лічильники виробництва і показники доступності станка.
+//
+// Два набори лічильників — за весь час роботи станка (lifetime) і за поточну зміну (shift):
+// розлиті та закриті спайки, пуски, паузи, зупинки, час у роботі й на паузі, а також
+// мінімальний/середній/найбільший час циклу спайки — інтервал між двома закритими
+// спайками за годинником станка (паузи в цикл не входять, перший цикл після пуску не рахується).
+// З них: доступність = робота / (робота + пауза), продуктивність = баночок за годину роботи.
+//
+// Збереження в EEPROM: кільце записів Record, кожен з порядковим номером і CRC.
+// Кожне збереження пише наступний слот кільця, тож знос розподіляється по всіх слотах,
+// а обірваний вимкненням живлення запис не псує попередній — при старті береться
+// цілий запис з найбільшим номером. Запис іде по байту з loop(): поки EEPROM зайнята
+// попереднім байтом (3.4 мс), service() одразу повертається і станок не чекає.
+// Зберігається на паузі, при зупинці, при новій зміні і кожні STATS_SAVE_INTERVAL_S роботи.
+
+struct ProductionCounters {
+    uint32_t setsPainted;
+    uint32_t setsCapped;
+    uint32_t runningSec;        // час у MACHINE_RUNNING
+    uint32_t pausedSec;         // час у MACHINE_PAUSED
+    uint16_t starts;
+    uint16_t pauses;
+    uint16_t stops;
+    uint32_t cycles;            // виміряних циклів спайки
+    uint64_t cycleSumMs;
+    uint32_t cycleMinMs;
+    uint32_t cycleMaxMs;
+
+    void clear() { memset(this, 0, sizeof(*this)); }
+
+    void addCycle(uint32_t ms) {
+        if (!cycles || ms < cycleMinMs) cycleMinMs = ms;
+        if (ms > cycleMaxMs) cycleMaxMs = ms;
+        cycleSumMs += ms;
+        cycles++;
+    }
+};
+
+class ProductionStats {
+public:
+    // Прочитати останній цілий запис з EEPROM
+    void begin() {
+        lifetime.clear();
+        shift.clear();
+        shiftNumber = 1;
+        sequence = 0;
+        nextSlot = 0;
+
+        bool found = false;
+        Record r;
+        for (uint8_t slot = 0; slot < SLOTS; slot++) {
+            eeprom_read_block(&r, slotAddress(slot), sizeof(r));
+            if (r.version != RECORD_VERSION || r.crc != crc8(&r, offsetof(Record, crc))) continue;
+            if (found && (int32_t)(r.sequence - sequence) <= 0) continue;
+            found = true;
+            sequence = r.sequence;
+            nextSlot = (slot + 1) % SLOTS;
+            lifetime = r.lifetime;
+            shift = r.shift;
+            shiftNumber = r.shiftNumber;
+        }
+        mode = STOPPED;
+        lastUpdateMs = millis();
+    }
+
+    // --- Події станка (handleStartStopButtons) ---
+    void onStart() {
+        lifetime.starts++;
+        shift.starts++;
+        cycleStarted = false;
+        setMode(RUNNING);
+    }
+
+    void onResume() { setMode(RUNNING); }
+
+    void onPause() {
+        lifetime.pauses++;
+        shift.pauses++;
+        setMode(PAUSED);
+        save();
+    }
+
+    void onStop() {
+        lifetime.stops++;
+        shift.stops++;
+        setMode(STOPPED);
+        save();
+    }
+
+    // --- Події станцій ---
+    void onSetPainted() {
+        lifetime.setsPainted++;
+        shift.setsPainted++;
+    }
+
+    void onSetCapped() {
+        lifetime.setsCapped++;
+        shift.setsCapped++;
+        uint32_t now = MachineClock::now();
+        if (cycleStarted) {
+            lifetime.addCycle(now - lastCappedAt);
+            shift.addCycle(now - lastCappedAt);
+        }
+        cycleStarted = true;
+        lastCappedAt = now;
+    }
+
+    // Закритих спайок за весь час (для шини лінії)
+    uint32_t setsCapped() const { return lifetime.setsCapped; }
+
+    // Через скільки мс годинника станка закриється наступна спайка — за середнім циклом зміни.
+    // false — циклів у цій зміні ще не було. Цикл, довший за середній, дає 0
+    bool nextSetEtaMs(uint32_t& ms) const {
+        if (!cycleStarted || !shift.cycles) return false;
+        uint32_t mean = (uint32_t)(shift.cycleSumMs / shift.cycles);
+        uint32_t since = MachineClock::now() - lastCappedAt;
+        ms = since < mean ? mean - since : 0;
+        return true;
+    }
+
+    // Нова зміна: лічильники зміни з нуля (попередню варто спершу вивести через print())
+    void newShift() {
+        shift.clear();
+        shiftNumber++;
+        save();
+    }
+
+    // Викликати з кожної ітерації loop(): облік часу і запис у EEPROM по байту
+    void service() {
+        accumulateTime();
+        if (mode == RUNNING && runningSinceSave >= STATS_SAVE_INTERVAL_S) save();
+        writeNextByte();
+    }
+
+    void print(Print& out) {
+        accumulateTime();
+        out.print("Lifetime: ");
+        printCounters(out, lifetime);
+        out.print("Shift ");
+        out.print(shiftNumber);
+        out.print(": ");
+        printCounters(out, shift);
+        out.print("Saved records: ");
+        out.print(sequence);
+        out.print(writing ? " (writing)" : "");
+        out.println();
+    }
+
+private:
+    static constexpr uint8_t RECORD_VERSION = 1;
+
+    struct Record {
+        uint8_t version;
+        uint32_t sequence;
+        uint16_t shiftNumber;
+        ProductionCounters lifetime;
+        ProductionCounters shift;
+        uint8_t crc;                // CRC усіх попередніх полів
+    };
+
+    static constexpr uint8_t SLOTS = STATS_EEPROM_SIZE / sizeof(Record);
+    static_assert(SLOTS >= 2, "STATS_EEPROM_SIZE замалий для кільця записів статистики");
+
+    enum Mode : uint8_t { STOPPED, RUNNING, PAUSED };
+
+    ProductionCounters lifetime;
+    ProductionCounters shift;
+    uint16_t shiftNumber = 1;
+    Mode mode = STOPPED;
+    unsigned long lastUpdateMs = 0;
+    uint16_t msRemainder = 0;           // частка секунди, ще не додана до лічильників часу
+    uint32_t runningSinceSave = 0;      // секунд роботи від останнього збереження
+    bool cycleStarted = false;
+    uint32_t lastCappedAt = 0;          // MachineClock::now() останньої закритої спайки
+
+    // Запис у кільце
+    uint32_t sequence = 0;              // номер останнього збереженого (або того, що пишеться)
+    uint8_t nextSlot = 0;
+    Record pending;
+    uint8_t writeOffset = 0;
+    bool writing = false;
+    bool saveRequested = false;
+
+    static uint8_t* slotAddress(uint8_t slot) {
+        return (uint8_t*)(uintptr_t)(STATS_EEPROM_START + (uint16_t)slot * sizeof(Record));
+    }
+
+    static uint8_t crc8(const void* data, uint16_t length) {
+        const uint8_t* p = (const uint8_t*)data;
+        uint8_t crc = 0;
+        while (length--) {
+            crc ^= *p++;
+            for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+    void setMode(Mode m) {
+        accumulateTime();
+        mode = m;
+    }
+
+    void accumulateTime() {
+        unsigned long now = millis();
+        uint32_t elapsed = now - lastUpdateMs;
+        lastUpdateMs = now;
+        if (mode == STOPPED) return;
+        elapsed += msRemainder;
+        uint32_t seconds = elapsed / 1000;
+        msRemainder = elapsed % 1000;
+        if (!seconds) return;
+        if (mode == RUNNING) {
+            lifetime.runningSec += seconds;
+            shift.runningSec += seconds;
+            runningSinceSave += seconds;
+        } else {
+            lifetime.pausedSec += seconds;
+            shift.pausedSec += seconds;
+        }
+    }
+
+    void save() {
+        runningSinceSave = 0;
+        if (writing) {
+            saveRequested = true;       // знімок зробиться, щойно допишеться поточний
+            return;
+        }
+        accumulateTime();
+        sequence++;
+        memset(&pending, 0, sizeof(pending));
+        pending.version = RECORD_VERSION;
+        pending.sequence = sequence;
+        pending.shiftNumber = shiftNumber;
+        pending.lifetime = lifetime;
+        pending.shift = shift;
+        pending.crc = crc8(&pending, offsetof(Record, crc));
+        writeOffset = 0;
+        writing = true;
+    }
+
+    // Не більше одного фізичного запису за виклик; незмінені байти пропускаються
+    void writeNextByte() {
+        if (!writing || !eeprom_is_ready()) return;
+        uint8_t* base = slotAddress(nextSlot);
+        const uint8_t* src = (const uint8_t*)&pending;
+        while (writeOffset < sizeof(Record)) {
+            uint8_t i = writeOffset++;
+            if (eeprom_read_byte(base + i) != src[i]) {
+                eeprom_write_byte(base + i, src[i]);
+                return;
+            }
+        }
+        writing = false;
+        nextSlot = (nextSlot + 1) % SLOTS;
+        if (saveRequested) {
+            saveRequested = false;
+            save();
+        }
+    }
+
+    static void printDuration(Print& out, uint32_t sec) {
+        out.print(sec / 3600);
+        out.print(sec % 3600 / 60 < 10 ? ":0" : ":");
+        out.print(sec % 3600 / 60);
+        out.print(sec % 60 < 10 ? ":0" : ":");
+        out.print(sec % 60);
+    }
+
+    static void printCounters(Print& out, const ProductionCounters& c) {
+        out.print("painted ");
+        out.print(c.setsPainted);
+        out.print(", capped ");
+        out.print(c.setsCapped);
+        out.print(" sets (");
+        out.print(c.setsCapped * JARS_IN_SET);
+        out.println(" jars)");
+
+        out.print("  running ");
+        printDuration(out, c.runningSec);
+        out.print(", paused ");
+        printDuration(out, c.pausedSec);
+        out.print(", availability ");
+        uint32_t planned = c.runningSec + c.pausedSec;
+        out.print(planned ? 100.0f * c.runningSec / planned : 0.0f, 1);
+        out.print("%, ");
+        out.print(c.runningSec ? 3600.0f * c.setsCapped * JARS_IN_SET / c.runningSec : 0.0f, 0);
+        out.println(" jars/h");
+
+        out.print("  starts ");
+        out.print(c.starts);
+        out.print(", pauses ");
+        out.print(c.pauses);
+        out.print(", stops ");
+        out.println(c.stops);
+
+        out.print("  set cycle min/avg/max ");
+        if (c.cycles) {
+            out.print(c.cycleMinMs / 1000.0f, 2);
+            out.print("/");
+            out.print((float)c.cycleSumMs / c.cycles / 1000.0f, 2);
+            out.print("/");
+            out.print(c.cycleMaxMs / 1000.0f, 2);
+            out.print(" s over ");
+            out.print(c.cycles);
+            out.println(" cycles");
+        } else {
+            out.println("-");
+        }
+    }
+};
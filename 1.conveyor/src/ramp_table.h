@@ -0,0 +1,159 @@
+#pragma once
+#include <Arduino.h>
+#include <FixedKinematics.h>
+#include "config.h"
+
+// Таблиця розгону конвеєра, обчислена на етапі компіляції.
+//
+// ticks[k] — інтервал (у тіках Timer3) між k-м і (k+1)-м кроком під час розгону
+// з місця до RAMP_TOP_SPEED_XY_MM_PER_S з обмеженим прискоренням і ривком
+// (S-крива; при ривку 0 — звичайна трапеція). Гальмування проходить ту саму таблицю
+// у зворотньому порядку, тому в перериванні немає жодної плаваючої математики.
+//
+// Таблиця складена з ділянок: S-крива 0 -> BELT_SPEED_XY_MM_PER_S, далі S-крива
+// BELT_SPEED_XY_MM_PER_S -> BELT_TRANSIT_SPEED_XY_MM_PER_S. На межі ділянок прискорення
+// нульове, тож швидкість підходу — окреме плато: вихід на нього, зупинка з нього і перехід
+// транзит <-> підхід проходять повні S-криві, з обмеженим ривком.
+
+namespace ramp {
+
+// Параметри профілю в кроках: швидкість (кр/с), прискорення (кр/с²), ривок (кр/с³)
+struct Profile {
+    double v;
+    double a;       // пікове прискорення, що реально досягається
+    double j;
+    double tJerk;   // тривалість ділянки наростання прискорення
+    double tConst;  // тривалість ділянки з постійним прискоренням
+};
+
+constexpr double sqrtNewton(double x) {
+    if (x <= 0) return 0;
+    double r = x > 1 ? x : 1;
+    for (int i = 0; i < 64; i++) r = 0.5 * (r + x / r);
+    return r;
+}
+
+constexpr Profile makeProfile(double v, double a, double j) {
+    if (j <= 0) return Profile{v, a, 0, 0, v / a};                 // трапеція
+    if (v * j >= a * a) return Profile{v, a, j, a / j, v / a - a / j};
+    // швидкість досягається раніше, ніж прискорення виходить на максимум
+    double aPeak = sqrtNewton(v * j);
+    return Profile{v, aPeak, j, aPeak / j, 0};
+}
+
+constexpr double rampTime(const Profile& p) { return 2 * p.tJerk + p.tConst; }
+
+// Шлях розгону (симетричний профіль: середня швидкість = v/2)
+constexpr double rampDistance(const Profile& p) { return p.v * rampTime(p) / 2; }
+
+// Пройдений шлях (кроки) через t секунд від початку розгону
+constexpr double positionAt(const Profile& p, double t) {
+    if (p.tJerk == 0) return p.a * t * t / 2;
+
+    double v1 = p.j * p.tJerk * p.tJerk / 2;
+    double x1 = p.j * p.tJerk * p.tJerk * p.tJerk / 6;
+    if (t < p.tJerk) return p.j * t * t * t / 6;
+
+    if (t < p.tJerk + p.tConst) {
+        double tau = t - p.tJerk;
+        return x1 + v1 * tau + p.a * tau * tau / 2;
+    }
+
+    double tau = t - p.tJerk - p.tConst;
+    double v2 = v1 + p.a * p.tConst;
+    double x2 = x1 + v1 * p.tConst + p.a * p.tConst * p.tConst / 2;
+    return x2 + v2 * tau + p.a * tau * tau / 2 - p.j * tau * tau * tau / 6;
+}
+
+// Ділянка таблиці: розгін за профілем p (p.v — приріст швидкості), що починається зі швидкості v0
+struct Segment {
+    Profile p;
+    double v0;
+};
+
+// Кількість кроків ділянки (округлена: межа ділянки — ціле число кроків, рівень плато)
+constexpr uint16_t segmentSteps(const Segment& s) {
+    return (uint16_t)(s.v0 * rampTime(s.p) + rampDistance(s.p) + 0.5);
+}
+
+// Момент часу від початку ділянки, коли буде зроблено її крок n (бісекція по монотонному шляху)
+constexpr double stepTime(const Segment& s, double n) {
+    double lo = 0;
+    double hi = rampTime(s.p);
+    for (int i = 0; i < 48; i++) {
+        double mid = (lo + hi) / 2;
+        if (s.v0 * mid + positionAt(s.p, mid) < n) lo = mid;
+        else hi = mid;
+    }
+    return hi;
+}
+
+template <uint16_t N>
+struct Table {
+    uint16_t ticks[N];
+};
+
+// Ділянки йдуть одна за одною: кожна наступна починається зі швидкості, на якій скінчилась попередня
+template <uint16_t N>
+constexpr Table<N> buildTable(const Segment* segments, uint8_t count, double ticksPerSecond, uint16_t minTicks) {
+    Table<N> table{};
+    uint16_t k = 0;
+    for (uint8_t s = 0; s < count; s++) {
+        uint16_t steps = segmentSteps(segments[s]);
+        double prev = 0;
+        for (uint16_t n = 1; n <= steps && k < N; n++, k++) {
+            double next = stepTime(segments[s], n);
+            double ticks = (next - prev) * ticksPerSecond + 0.5;
+            if (ticks > 65535) table.ticks[k] = 65535;
+            else if (ticks < minTicks) table.ticks[k] = minTicks;
+            else table.ticks[k] = (uint16_t)ticks;
+            prev = next;
+        }
+    }
+    return table;
+}
+
+} // namespace ramp
+
+static_assert(BELT_TRANSIT_SPEED_XY_MM_PER_S >= BELT_SPEED_XY_MM_PER_S,
+              "BELT_TRANSIT_SPEED_XY_MM_PER_S не може бути меншою за BELT_SPEED_XY_MM_PER_S");
+
+// Ділянки розгону основного конвеєра: до швидкості підходу, далі до транзитної
+constexpr ramp::Segment RAMP_SEGMENTS_XY[] = {
+    {ramp::makeProfile(BELT_SPEED_XY_MM_PER_S * STEPS_PER_MM_XY,
+                       BELT_ACCEL_XY_MM_PER_S2 * STEPS_PER_MM_XY,
+                       BELT_JERK_XY_MM_PER_S3 * STEPS_PER_MM_XY),
+     0},
+    {ramp::makeProfile((RAMP_TOP_SPEED_XY_MM_PER_S - BELT_SPEED_XY_MM_PER_S) * STEPS_PER_MM_XY,
+                       BELT_ACCEL_XY_MM_PER_S2 * STEPS_PER_MM_XY,
+                       BELT_JERK_XY_MM_PER_S3 * STEPS_PER_MM_XY),
+     BELT_SPEED_XY_MM_PER_S * STEPS_PER_MM_XY},
+};
+
+// Рівні планування швидкості (кроків по таблиці розгону): підхід до датчиків — межа ділянок,
+// транзит між спайками — кінець таблиці. З рівня k гальмування до зупинки займає k кроків
+constexpr uint16_t RAMP_APPROACH_LEVEL_XY = ramp::segmentSteps(RAMP_SEGMENTS_XY[0]);
+constexpr uint16_t RAMP_TRANSIT_LEVEL_XY = RAMP_APPROACH_LEVEL_XY + ramp::segmentSteps(RAMP_SEGMENTS_XY[1]);
+
+// Кількість кроків розгону (вона ж — кількість кроків гальмування з повної швидкості)
+constexpr uint16_t RAMP_STEPS_XY = RAMP_TRANSIT_LEVEL_XY > 0 ? RAMP_TRANSIT_LEVEL_XY : 1;
+
+static_assert(RAMP_TRANSIT_LEVEL_XY < 2048,
+              "Таблиця розгону завелика - збільшіть BELT_ACCEL_XY_MM_PER_S2 або BELT_JERK_XY_MM_PER_S3");
+
+// Гальмівний шлях зі швидкості підходу, як у StepEngine::brake(): ще крок на поточному рівні,
+// далі по кроку на рівень
+constexpr uint16_t RAMP_APPROACH_BRAKE_STEPS_XY = RAMP_APPROACH_LEVEL_XY + 1;
+
+// Інтервал крейсерської швидкості в тіках Timer3
+constexpr uint16_t RAMP_CRUISE_TICKS_XY =
+    (uint16_t)kin::stepTicks(RAMP_TOP_SPEED_XY_MM_PER_S, STEPS_PER_MM_XY, 1000000.0 * STEP_TIMER_TICKS_PER_US);
+
+static constexpr ramp::Table<RAMP_STEPS_XY> rampTableXY PROGMEM =
+    ramp::buildTable<RAMP_STEPS_XY>(RAMP_SEGMENTS_XY, 2, 1000000.0 * STEP_TIMER_TICKS_PER_US, RAMP_CRUISE_TICKS_XY);
+
+// Інтервал для рівня швидкості level (кількість кроків, пройдених по розгону)
+inline uint16_t rampIntervalTicks(uint16_t level) {
+    if (level >= RAMP_STEPS_XY) return RAMP_CRUISE_TICKS_XY;
+    return pgm_read_word(&rampTableXY.ticks[level]);
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+#include "pinout.h"
+#include "config.h"
+#include "ramp_table.h"
+#include "step_engine.h"
+#include "fast_gpio.h"
+#if !defined(__AVR__)
+#include <ArduinoNative.h>
+#endif
+
+// Захоплення фронтів датчиків баночок у перериванні.
+//
+// sensor_1 (PJ1, PCINT10) і sensor_2 (PJ0, PCINT9) сидять на одному векторі PCINT1.
+// На кожен перехід датчика в активний стан переривання запам'ятовує час (мкс) і
+// положення конвеєра — лічильник кроків StepEngine. Антидребезг у Controls лишається
+// перевіркою: коли він підтверджує фронт, датчик уже стабільно активний від останнього
+// захопленого переходу, тож саме цей перехід і є початком баночки. Дотягування
+// відраховується від захопленого положення, а не від моменту, коли loop() побачив фронт, —
+// точність центрування не залежить ні від антидребезгу, ні від затримок loop().
+//
+// У збірці для ПК замість PCINT — слухач змін входів віртуальної плати.
+
+// Поки антидребезг підтверджує фронт (до одного періоду вибірки входів довше за сам антидребезг),
+// конвеєр їде далі; решти шляху має вистачити на гальмування.
+// До датчиків конвеєр підходить зі швидкістю підходу (Conveyor::scheduleSpeed)
+constexpr double SENSOR_CONFIRM_STEPS_XY =
+    (SENSOR_DEBOUNCE_TIME_MS + INPUT_SCAN_PERIOD_US / 1000.0) * BELT_SPEED_XY_MM_PER_S * STEPS_PER_MM_XY / 1000.0 + RAMP_APPROACH_BRAKE_STEPS_XY;
+static_assert(SENSOR_CONFIRM_STEPS_XY < JAR_CENTERING_MM * STEPS_PER_MM_XY,
+              "JAR_CENTERING_MM має бути більшим за шлях під час антидребезгу плюс гальмівний шлях");
+static_assert(SENSOR_CONFIRM_STEPS_XY < CAP_CENTERING_MM * STEPS_PER_MM_XY,
+              "CAP_CENTERING_MM має бути більшим за шлях під час антидребезгу плюс гальмівний шлях");
+
+class SensorCapture {
+public:
+    enum Channel : uint8_t {
+        SENSOR_1 = 0,
+        SENSOR_2 = 1,
+        CHANNELS = 2
+    };
+
+    // invert — як ControlsConfig::invertS1/invertS2
+    static void begin(bool invertS1, bool invertS2) {
+        noInterrupts();
+        invert[SENSOR_1] = invertS1;
+        invert[SENSOR_2] = invertS2;
+        active[SENSOR_1] = readActive<sensor_1>(invertS1);
+        active[SENSOR_2] = readActive<sensor_2>(invertS2);
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            edgePosition[ch] = StepEngine::positionIsr();
+            edgeMicros[ch] = micros();
+        }
+        enableInterrupts();
+        interrupts();
+    }
+
+    // Останній перехід каналу в активний стан
+    static void lastActivation(uint8_t ch, uint32_t& position, unsigned long& timeUs) {
+        noInterrupts();
+        position = edgePosition[ch];
+        timeUs = edgeMicros[ch];
+        interrupts();
+    }
+
+    // Обробник переривання (PCINT1 або слухач входів на ПК)
+    static void onPinChange() {
+        capture<sensor_1>(SENSOR_1);
+        capture<sensor_2>(SENSOR_2);
+    }
+
+private:
+    static inline volatile bool invert[CHANNELS] = {false, false};
+    static inline volatile bool active[CHANNELS] = {false, false};
+    static inline volatile uint32_t edgePosition[CHANNELS] = {0, 0};
+    static inline volatile unsigned long edgeMicros[CHANNELS] = {0, 0};
+
+    template <uint8_t PIN>
+    static bool readActive(bool inv) {
+        bool raw = !FastPin<PIN>::read();   // INPUT_PULLUP: активний = LOW
+        return inv ? !raw : raw;
+    }
+
+    // Викликати з ISR або з вимкненими перериваннями
+    template <uint8_t PIN>
+    static void capture(uint8_t ch) {
+        bool now = readActive<PIN>(invert[ch]);
+        if (now && !active[ch]) {
+            edgePosition[ch] = StepEngine::positionIsr();
+            edgeMicros[ch] = micros();
+        }
+        active[ch] = now;
+    }
+
+#if defined(__AVR__)
+    static_assert(sensor_1 == 14 && sensor_2 == 15,
+                  "SensorCapture: датчики мають бути на PJ1/PJ0 (PCINT10/PCINT9), інакше змініть маску PCINT");
+
+    static void enableInterrupts() {
+        PCMSK1 |= _BV(PCINT9) | _BV(PCINT10);
+        PCIFR = _BV(PCIF1);
+        PCICR |= _BV(PCIE1);
+    }
+#else
+    static void enableInterrupts() {
+        static bool attached = false;
+        if (attached) return;
+        attached = true;
+        native::Board* board = &native::board();
+        board->onInputChange([board](uint8_t pin, bool) {
+            if (pin != sensor_1 && pin != sensor_2) return;
+            native::BoardScope scope(*board);
+            onPinChange();
+        });
+    }
+#endif
+};
+
+#if defined(__AVR__)
+ISR(PCINT1_vect) { SensorCapture::onPinChange(); }
+#endif
@@ -0,0 +1,142 @@
+#pragma once
+#include <Arduino.h>
+#include <FixedKinematics.h>
+#include "config.h"
+
+// Облік спайок на ремені за одометром конвеєра.
+//
+// Кожна спайка, передню баночку якої побачив датчик 1, потрапляє в кільцевий буфер
+// з положенням фронту (кроки одометра Conveyor::odometer()). Баночки на ремені не
+// ковзають, тож усе інше — відстанями:
+//  - задні баночки спайки на датчику 1 лежать у вікні SET_SPAN від передньої;
+//  - передня баночка прийде на датчик 2 через SENSOR1_TO_SENSOR2_MM (± допуск),
+//    задні — у вікні SET_SPAN після неї.
+// Зайвий або пропущений фронт зачіпає лише свою спайку — наступні впізнаються
+// за відстанню, а не за лічильником фронтів.
+//
+// Спайка, що з'явилась на датчику 2 без запису (після перезапуску станка вона вже
+// була між датчиками), додається «заднім числом» з розрахованим положенням на датчику 1.
+
+namespace settrack {
+constexpr uint32_t mmToSteps(double mm) { return kin::mmToSteps(mm, STEPS_PER_MM_XY); }
+
+// Від фронту передньої баночки до фронту останньої + половина кроку запасу
+constexpr uint32_t SET_SPAN_STEPS = mmToSteps((JARS_IN_SET - 1) * JAR_PITCH_MM + JAR_PITCH_MM / 2);
+constexpr uint32_t SENSOR1_TO_SENSOR2_STEPS = mmToSteps(SENSOR1_TO_SENSOR2_MM);
+constexpr uint32_t ARRIVAL_TOLERANCE_STEPS = mmToSteps(SET_ARRIVAL_TOLERANCE_MM);
+
+static_assert(SET_ARRIVAL_TOLERANCE_MM < JAR_PITCH_MM / 2,
+              "SET_ARRIVAL_TOLERANCE_MM має бути меншим за половину кроку баночок");
+} // namespace settrack
+
+class SetTracker {
+public:
+    static constexpr uint8_t CAPACITY = 8;
+
+    enum Sensor2Match {
+        S2_LEADING,    // передня баночка очікуваної спайки — зупиняти і закривати
+        S2_TRAILING,   // задня баночка вже обробленої спайки — ігнорувати
+        S2_MISSED,     // задня баночка спайки, чию передню датчик 2 пропустив
+        S2_UNKNOWN     // спайки немає в обліку — взята на облік як нова
+    };
+
+    void clear() {
+        head = 0;
+        size = 0;
+    }
+
+    // Фронт датчика 1 у положенні position. true — передня баночка нової спайки
+    bool onSensor1(uint32_t position) {
+        if (size > 0 && position - newest().sensor1Position < settrack::SET_SPAN_STEPS) {
+            return false;
+        }
+        push(position);
+        return true;
+    }
+
+    // Фронт датчика 2 у положенні position
+    Sensor2Match onSensor2(uint32_t position) {
+        for (uint8_t i = 0; i < size; i++) {
+            Entry& set = at(i);
+            // Відхилення від очікуваного приходу передньої баночки (зі знаком)
+            int32_t d = (int32_t)(position - arrival(set));
+            if (d < -(int32_t)settrack::ARRIVAL_TOLERANCE_STEPS || d >= (int32_t)settrack::SET_SPAN_STEPS) continue;
+            if (set.reachedSensor2) return S2_TRAILING;
+            set.reachedSensor2 = true;
+            return d <= (int32_t)settrack::ARRIVAL_TOLERANCE_STEPS ? S2_LEADING : S2_MISSED;
+        }
+        // Така спайка їде попереду всіх, що ще між датчиками
+        pushOldest(position - settrack::SENSOR1_TO_SENSOR2_STEPS);
+        return S2_UNKNOWN;
+    }
+
+    // Прибрати спайки, що повністю пройшли датчик 2. Повертає кількість тих,
+    // яких датчик 2 так і не побачив.
+    uint8_t update(uint32_t odometer) {
+        uint8_t lost = 0;
+        while (size > 0) {
+            const Entry& set = at(0);
+            if ((int32_t)(odometer - arrival(set)) < (int32_t)settrack::SET_SPAN_STEPS) break;
+            if (!set.reachedSensor2) lost++;
+            head = (head + 1) % CAPACITY;
+            size--;
+        }
+        return lost;
+    }
+
+    // Очікуваний прихід на датчик 2 найближчої спайки, ще не обробленої там
+    bool nextSensor2Arrival(uint32_t& position) const {
+        for (uint8_t i = 0; i < size; i++) {
+            const Entry& set = entries[(head + i) % CAPACITY];
+            if (!set.reachedSensor2) {
+                position = arrival(set);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Фронт датчика 1 останньої взятої на облік спайки
+    bool lastSensor1(uint32_t& position) const {
+        if (!size) return false;
+        position = entries[(head + size - 1) % CAPACITY].sensor1Position;
+        return true;
+    }
+
+    uint8_t count() const { return size; }
+
+private:
+    struct Entry {
+        uint32_t sensor1Position;   // фронт передньої баночки на датчику 1 (кроки)
+        bool reachedSensor2;        // передня баночка вже пройшла датчик 2
+    };
+
+    Entry entries[CAPACITY];
+    uint8_t head = 0;
+    uint8_t size = 0;
+
+    static uint32_t arrival(const Entry& set) { return set.sensor1Position + settrack::SENSOR1_TO_SENSOR2_STEPS; }
+
+    Entry& at(uint8_t i) { return entries[(head + i) % CAPACITY]; }
+    Entry& newest() { return at(size - 1); }
+
+    void push(uint32_t sensor1Position) {
+        if (size == CAPACITY) {
+            // Переповнення: найстаріша спайка вже мала б піти з ременя
+            head = (head + 1) % CAPACITY;
+            size--;
+        }
+        Entry& set = entries[(head + size) % CAPACITY];
+        set.sensor1Position = sensor1Position;
+        set.reachedSensor2 = false;
+        size++;
+    }
+
+    void pushOldest(uint32_t sensor1Position) {
+        if (size == CAPACITY) return;
+        head = (head + CAPACITY - 1) % CAPACITY;
+        size++;
+        entries[head].sensor1Position = sensor1Position;
+        entries[head].reachedSensor2 = true;
+    }
+};
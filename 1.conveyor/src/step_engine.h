@@ -0,0 +1,240 @@
+#pragma once
+#include <Arduino.h>
+#include "pinout.h"
+#include "config.h"
+#include "ramp_table.h"
+#include "fast_gpio.h"
+#if !defined(__AVR__)
+#include <ArduinoNative.h>
+#endif
+
+// Апаратна генерація STEP-імпульсів конвеєра на Timer3 (ATmega2560).
+//
+// Таймер працює в режимі CTC: compare-match A задає період кроку і піднімає STEP,
+// compare-match B (через PULSE_WIDTH_TICKS після нього) опускає STEP.
+// Період не залежить від того, скільки часу займає loop(), а кожен крок
+// рахується в перериванні — тому і швидкість, і дотягування точні.
+//
+// Розгін і гальмування: «рівень» швидкості level — це кількість кроків, пройдених
+// по таблиці розгону (ramp_table.h). На кожному кроці рівень змінюється не більше ніж
+// на одиницю, тож прискорення не перевищує заданого в config.h. Ривок обмежений лише
+// там, де рух проходить таблицю від плато до плато: розгін, зупинка і зміна швидкості
+// між рівнями підходу й транзиту. Гальмування, почате посеред розгону (brake(), ціль
+// ближча за повний розгін), розвертає прискорення за один крок. Ціль ближча за гальмівний
+// шлях (рівень скидається стрибком) не обмежує і прискорення.
+// Для руху на задану відстань гальмування починається рівно тоді, коли кроків
+// до цілі залишилось стільки, скільки потрібно для зупинки з поточного рівня.
+//
+// У збірці для ПК ([env:native]) замість Timer3 працює native::CtcTimer з тим самим
+// тактом, тож кроки генеруються у віртуальному часі з тими ж інтервалами.
+
+static_assert(STEP_INTERVAL_XY_MICROS * STEP_TIMER_TICKS_PER_US < 65536.0,
+              "STEP_INTERVAL_XY_MICROS не вміщується в 16-бітний Timer3 - збільшіть STEP_TIMER_PRESCALER");
+static_assert(PULSE_WIDTH_TICKS < STEP_INTERVAL_XY_TICKS,
+              "Тривалість STEP імпульсу має бути меншою за інтервал між кроками");
+
+class StepEngine {
+    using StepPin = FastPin<X_STEP_PIN>;
+
+public:
+    // Налаштування таймера; генерація стартує лише після run()/moveTo()
+    static void begin() {
+        StepPin::mode(OUTPUT);
+        StepPin::low();
+
+        noInterrupts();
+        timerConfigure();
+        interrupts();
+
+        moving = false;
+        limited = false;
+        finishing = false;
+        stepsLeft = 0;
+        level = 0;
+        targetLevel = RAMP_STEPS_XY;
+    }
+
+    // Безперервний рух: розгін (або продовження руху) до крейсерської швидкості
+    static void run() {
+        noInterrupts();
+        limited = false;
+        finishing = false;
+        stepsLeft = 0;
+        if (!moving) startTimer();
+        interrupts();
+    }
+
+    // Крейсерська швидкість (рівень таблиці розгону) для run() і moveTo().
+    // Зміна на ходу — плавна: рівень іде до нового по одному на крок, по тій самій таблиці
+    static void setCruiseLevel(uint16_t cruise) {
+        noInterrupts();
+        targetLevel = cruise < RAMP_STEPS_XY ? cruise : RAMP_STEPS_XY;
+        interrupts();
+    }
+
+    // Зупинитись точно в положенні target (лічильник position()).
+    // Якщо конвеєр уже рухається — рахунок іде без перезапуску таймера (без ривка),
+    // а гальмування планується так, щоб останній крок припав точно на ціль.
+    // false — ціль уже пройдено, рух не змінено.
+    static bool moveTo(uint32_t target) {
+        noInterrupts();
+        uint32_t steps = target - stepPosition;
+        bool ahead = steps != 0 && steps < 0x80000000UL;   // ціль попереду (з урахуванням переповнення)
+        if (ahead) {
+            stepsLeft = steps;
+            limited = true;
+            finishing = false;
+            if (!moving) startTimer();
+        }
+        interrupts();
+        return ahead;
+    }
+
+    // Плавна зупинка на найкоротшій відстані, яку дозволяє профіль гальмування
+    static void brake() {
+        noInterrupts();
+        if (moving) {
+            // Поточний період уже йде на рівні level: ще крок на ньому, далі k кроків з рівня k
+            uint32_t brakeSteps = (uint32_t)level + 1;
+            if (!limited || stepsLeft > brakeSteps) {
+                stepsLeft = brakeSteps;
+                limited = true;
+            }
+        }
+        interrupts();
+    }
+
+    // Негайна зупинка генерації (аварійна зупинка / пауза)
+    static void stop() {
+        noInterrupts();
+        haltTimer();
+        interrupts();
+        StepPin::low();
+    }
+
+    static bool isMoving() { return moving; }
+
+    // Кількість кроків, виданих з моменту увімкнення
+    static uint32_t position() {
+        noInterrupts();
+        uint32_t p = stepPosition;
+        interrupts();
+        return p;
+    }
+
+    // Те саме з ISR (або з уже вимкненими перериваннями)
+    static uint32_t positionIsr() { return stepPosition; }
+
+    // Скільки кроків залишилось до кінця moveTo() (0 — безперервний рух або стоїмо)
+    static uint32_t remaining() {
+        noInterrupts();
+        uint32_t r = limited ? stepsLeft : 0;
+        interrupts();
+        return r;
+    }
+
+    // --- Обробники переривань Timer3 ---
+
+    // Початок кроку і вибір інтервалу до наступного
+    static void onPeriod() {
+        StepPin::high();
+        stepPosition++;
+
+        uint16_t cap = targetLevel;
+        if (limited) {
+            if (--stepsLeft == 0) {
+                finishing = true; // останній крок: зупинимось після спаду імпульсу
+                return;
+            }
+            // з рівня k зупинка займає рівно k кроків
+            if (stepsLeft - 1 < cap) cap = stepsLeft - 1;
+        }
+
+        if (level < cap) {
+            level++;
+        } else if (level > cap) {
+            // Якщо ціль ближче, ніж гальмівний шлях (коротке дотягування) — скидаємо
+            // швидкість стрибком до рівня, з якого ще можна зупинитись точно на цілі
+            if (limited && level > stepsLeft) level = cap;
+            else level--;
+        }
+        timerSetPeriod(rampIntervalTicks(level));
+    }
+
+    // Кінець STEP імпульсу
+    static void onPulseEnd() {
+        StepPin::low();
+        if (finishing) {
+            haltTimer();
+        }
+    }
+
+private:
+    static inline volatile bool moving = false;
+    static inline volatile bool limited = false;
+    static inline volatile bool finishing = false;
+    static inline volatile uint32_t stepsLeft = 0;
+    static inline volatile uint32_t stepPosition = 0;
+    static inline volatile uint16_t level = 0;        // поточна швидкість (індекс таблиці розгону)
+    static inline volatile uint16_t targetLevel = RAMP_STEPS_XY;
+
+    // Викликати з вимкненими перериваннями. Старт завжди з місця (рівень 0)
+    static void startTimer() {
+        level = 0;
+        timerStart(rampIntervalTicks(0));
+        moving = true;
+    }
+
+    // Викликати з вимкненими перериваннями (або з ISR)
+    static void haltTimer() {
+        timerHalt();
+        moving = false;
+        limited = false;
+        finishing = false;
+        stepsLeft = 0;
+        level = 0;
+    }
+
+#if defined(__AVR__)
+    static void timerConfigure() {
+        TCCR3A = 0;
+        TCCR3B = _BV(WGM32);            // CTC, TOP = OCR3A, тактування вимкнене
+        TCNT3 = 0;
+        OCR3A = rampIntervalTicks(0);
+        OCR3B = PULSE_WIDTH_TICKS;
+        TIMSK3 = 0;
+    }
+
+    static void timerStart(uint16_t ticks) {
+        TCNT3 = 0;
+        OCR3A = ticks;
+        TIFR3 = _BV(OCF3A) | _BV(OCF3B);          // скинути старі прапорці
+        TIMSK3 = _BV(OCIE3A) | _BV(OCIE3B);
+        TCCR3B = _BV(WGM32) | STEP_TIMER_CLOCK_SELECT;
+    }
+
+    static void timerSetPeriod(uint16_t ticks) { OCR3A = ticks; }
+
+    static void timerHalt() {
+        TCCR3B = _BV(WGM32);
+        TIMSK3 = 0;
+    }
+#else
+    static inline native::CtcTimer timer{1000 / STEP_TIMER_TICKS_PER_US};
+
+    static void timerConfigure() {
+        timer.stop();
+        timer.onCompareA(onPeriod);
+        timer.onCompareB(onPulseEnd);
+    }
+
+    static void timerStart(uint16_t ticks) { timer.start(ticks, PULSE_WIDTH_TICKS); }
+    static void timerSetPeriod(uint16_t ticks) { timer.setTop(ticks); }
+    static void timerHalt() { timer.stop(); }
+#endif
+};
+
+#if defined(__AVR__)
+ISR(TIMER3_COMPA_vect) { StepEngine::onPeriod(); }
+ISR(TIMER3_COMPB_vect) { StepEngine::onPulseEnd(); }
+#endif
@@ -0,0 +1,257 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "telemetry_events.h"
+#include <StallWatchdog.h>
+
+// Діагностика без блокування loop().
+//
+// Замість тексту в Serial прошивка пише короткі двійкові записи подій:
+//   [номер події][micros(), 4 байти LE][аргументи][CRC-8]
+// Аргументи — varint/zigzag/float за форматом події з telemetry_events.h, сам текст
+// повідомлення знає лише декодер на ПК (tools/telemetry_decode). Запис кодується COBS
+// і закінчується байтом 0x00, тож декодер знаходить межі кадрів у будь-якому місці потоку.
+//
+// Кадри складаються в кільцевий буфер, а в Serial переходять лише стільки байтів, скільки
+// вміщує апаратний буфер передачі (availableForWrite()) — з service() у loop() і одразу
+// після кожної події. Якщо кільце повне, подія відкидається і рахується; лічильник
+// відкинутих приходить окремою подією DROPPED, щойно звільниться місце.
+//
+// Рівень кожної події заданий у таблиці; події, детальніші за TELEMETRY_LEVEL, не
+// компілюються взагалі. Виклик: telemetry::log<telemetry::EV_CAP_SET_LOST>(lost);
+// Не викликати з переривань.
+//
+// Відповіді на команди Serial (звіти stats, loop) — текст через Telemetry::text():
+// він іде подіями TEXT у тому ж потоці. Лише тут запис чекає на місце в кільці —
+// звіт на запит оператора має дійти цілим.
+
+namespace telemetry {
+
+enum Level : uint8_t {
+    LEVEL_OFF = 0,
+    LEVEL_ERROR = 1,
+    LEVEL_WARN = 2,
+    LEVEL_INFO = 3,
+    LEVEL_DEBUG = 4
+};
+
+enum EventId : uint8_t {
+#define TELEMETRY_EVENT_ID(name, level, format) EV_##name,
+    TELEMETRY_EVENTS(TELEMETRY_EVENT_ID)
+#undef TELEMETRY_EVENT_ID
+    EVENT_COUNT
+};
+
+constexpr Level LEVELS[] = {
+#define TELEMETRY_EVENT_LEVEL(name, level, format) LEVEL_##level,
+    TELEMETRY_EVENTS(TELEMETRY_EVENT_LEVEL)
+#undef TELEMETRY_EVENT_LEVEL
+};
+
+constexpr const char* FORMATS[] = {
+#define TELEMETRY_EVENT_FORMAT(name, level, format) format,
+    TELEMETRY_EVENTS(TELEMETRY_EVENT_FORMAT)
+#undef TELEMETRY_EVENT_FORMAT
+};
+
+// --- Перевірка аргументів проти формату (лише при компіляції) ---
+
+// Символ n-ї підстановки у форматі, 0 — якщо її немає
+constexpr char conversion(const char* f, uint8_t n) {
+    for (; *f; f++) {
+        if (*f != '%') continue;
+        if (f[1] == '%') {
+            f++;
+            continue;
+        }
+        if (n == 0) return f[1];
+        n--;
+    }
+    return 0;
+}
+
+constexpr char conversionOf(bool) { return 'u'; }
+constexpr char conversionOf(unsigned char) { return 'u'; }
+constexpr char conversionOf(unsigned short) { return 'u'; }
+constexpr char conversionOf(unsigned int) { return 'u'; }
+constexpr char conversionOf(unsigned long) { return 'u'; }
+constexpr char conversionOf(signed char) { return 'd'; }
+constexpr char conversionOf(short) { return 'd'; }
+constexpr char conversionOf(int) { return 'd'; }
+constexpr char conversionOf(long) { return 'd'; }
+constexpr char conversionOf(float) { return 'f'; }
+constexpr char conversionOf(double) { return 'f'; }
+
+template <uint8_t I>
+constexpr bool argsMatch(const char* f) { return conversion(f, I) == 0; }
+
+template <uint8_t I, typename T, typename... Rest>
+constexpr bool argsMatch(const char* f) {
+    return conversion(f, I) == conversionOf(T()) && argsMatch<I + 1, Rest...>(f);
+}
+
+} // namespace telemetry
+
+class Telemetry {
+public:
+    static constexpr uint8_t MAX_RAW = 48;     // найдовший кадр до кодування COBS
+
+    static void begin() {
+        Serial.begin(TELEMETRY_BAUD);
+        head = tail = 0;
+        dropped = 0;
+    }
+
+    // Передати в Serial усе, що вміщується в апаратний буфер, не чекаючи
+    static void service() {
+        int room = Serial.availableForWrite();
+        while (room-- > 0 && tail != head) Serial.write(ring[tail++]);
+        if (dropped) reportDropped();
+    }
+
+    template <typename... Args>
+    static void emit(telemetry::EventId id, Args... args) {
+        if (dropped) reportDropped();
+        Frame f(id);
+        int expand[] = {0, (f.put(args), 0)...};
+        (void)expand;
+        if (!push(f)) dropped++;
+        service();
+    }
+
+    // Текст у потоці телеметрії (відповіді на команди)
+    static Print& text() {
+        static TextPrint textPrint;
+        return textPrint;
+    }
+
+private:
+    class Frame {
+    public:
+        explicit Frame(uint8_t id) {
+            bytes[0] = id;
+            uint32_t t = micros();
+            for (uint8_t i = 1; i <= 4; i++, t >>= 8) bytes[i] = (uint8_t)t;
+            length = 5;
+        }
+
+        void put(bool v) { putVarint(v); }
+        void put(unsigned char v) { putVarint(v); }
+        void put(unsigned short v) { putVarint(v); }
+        void put(unsigned int v) { putVarint(v); }
+        void put(unsigned long v) { putVarint((uint32_t)v); }
+        void put(signed char v) { putSigned(v); }
+        void put(short v) { putSigned(v); }
+        void put(int v) { putSigned(v); }
+        void put(long v) { putSigned((int32_t)v); }
+        void put(double v) { put((float)v); }
+        void put(float v) {
+            uint8_t raw[4];
+            memcpy(raw, &v, 4);
+            for (uint8_t i = 0; i < 4; i++) putByte(raw[i]);
+        }
+
+        void putByte(uint8_t b) {
+            if (length < MAX_RAW - 1) bytes[length++] = b;   // останній байт — під CRC
+        }
+
+        uint8_t bytes[MAX_RAW];
+        uint8_t length;
+
+    private:
+        void putVarint(uint32_t v) {
+            while (v >= 0x80) {
+                putByte((uint8_t)v | 0x80);
+                v >>= 7;
+            }
+            putByte((uint8_t)v);
+        }
+        void putSigned(int32_t v) { putVarint(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+    };
+
+    class TextPrint : public Print {
+    public:
+        size_t write(uint8_t c) override {
+            if (c == '\r') return 1;
+            line[length++] = c;
+            if (c == '\n' || length == sizeof(line)) flush();
+            return 1;
+        }
+        using Print::write;
+
+    private:
+        void flush() {
+            Frame f(telemetry::EV_TEXT);
+            for (uint8_t i = 0; i < length; i++) f.putByte(line[i]);
+            length = 0;
+            while (!push(f)) drainBlocking();
+            service();
+        }
+
+        char line[32];
+        uint8_t length = 0;
+    };
+
+    static inline uint8_t ring[256];           // індекси uint8_t обертаються самі
+    static inline uint8_t head = 0;
+    static inline uint8_t tail = 0;
+    static inline uint16_t dropped = 0;
+
+    static uint8_t crc8(const uint8_t* p, uint8_t n) {
+        uint8_t crc = 0;
+        while (n--) {
+            crc ^= *p++;
+            for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+    // COBS: кожен нуль кадру замінюється відстанню до наступного, 0x00 — лише кінець кадру
+    static bool push(Frame& f) {
+        f.bytes[f.length] = crc8(f.bytes, f.length);
+        uint8_t n = f.length + 1;
+        uint8_t need = n + 2;                  // код першої групи + роздільник (кадр < 254 байтів)
+        if ((uint8_t)(255 - (uint8_t)(head - tail)) < need) return false;
+
+        uint8_t codeAt = head++;
+        uint8_t code = 1;
+        for (uint8_t i = 0; i < n; i++) {
+            if (f.bytes[i] == 0) {
+                ring[codeAt] = code;
+                codeAt = head++;
+                code = 1;
+            } else {
+                ring[head++] = f.bytes[i];
+                code++;
+            }
+        }
+        ring[codeAt] = code;
+        ring[head++] = 0;
+        return true;
+    }
+
+    static void reportDropped() {
+        Frame f(telemetry::EV_DROPPED);
+        f.put((unsigned int)dropped);
+        if (push(f)) dropped = 0;
+    }
+
+    // Лише для TEXT: звільнити місце, дочекавшись апаратного буфера Serial.
+    // Великий звіт (trace) так чекає сотні мс — ітерація законно довга, сторож не скидає плату
+    static void drainBlocking() {
+        StallWatchdog::feed();
+        if (tail != head) Serial.write(ring[tail++]);
+    }
+};
+
+namespace telemetry {
+
+template <EventId ID, typename... Args>
+inline void log(Args... args) {
+    static_assert(argsMatch<0, Args...>(FORMATS[ID]), "Аргументи події не відповідають її формату в telemetry_events.h");
+    if constexpr (LEVELS[ID] != LEVEL_OFF && LEVELS[ID] <= TELEMETRY_LEVEL) {
+        Telemetry::emit(ID, args...);
+    }
+}
+
+} // namespace telemetry
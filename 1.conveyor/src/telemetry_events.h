@@ -0,0 +1,32 @@
+#pragma once
+
+// Таблиця подій телеметрії 1.conveyor — спільна для прошивки (telemetry.h) і декодера
+// на ПК (tools/telemetry_decode). Номер події — її місце в таблиці, тож нові події
+// додаються лише в кінець, а змінена подія отримує новий рядок. Подія, яку прошивка більше
+// не пише, лишається в таблиці як RESERVED_<номер> зі старим форматом — для старих журналів.
+//
+// X(назва, рівень, формат). Формат живе тільки на ПК — у прошивку (і у флеш) він
+// не потрапляє, а лише перевіряється при компіляції проти типів аргументів:
+//   %u — беззнакове ціле (varint), %d — ціле зі знаком (zigzag varint), %f — float (4 байти).
+// TEXT несе довільний текст (відповіді на команди Serial) і не має аргументів.
+
+#define TELEMETRY_EVENTS(X) \
+    X(TEXT,                 ERROR, "") \
+    X(DROPPED,              WARN,  "Telemetry: %u events dropped (buffer full)") \
+    X(MACHINE_INITIALIZED,  INFO,  "Machine initialized") \
+    X(MACHINE_STARTED,      INFO,  "Machine started") \
+    X(MACHINE_RESUMED,      INFO,  "Machine resumed") \
+    X(MACHINE_PAUSED,       INFO,  "Machine paused") \
+    X(MACHINE_STOPPED,      INFO,  "Machine stopped") \
+    X(MACHINE_SIGNAL,       DEBUG, "updateMachineSignals: state=%u (0 STOPPED, 1 RUNNING, 2 PAUSED), pin=%u") \
+    X(CONVEYOR_STARTED,     DEBUG, "Conveyor started") \
+    X(RESERVED_9,           DEBUG, "Conveyor stopWithDociag %f mm: %u steps after sensor edge (was running %u, dociag %u)") \
+    X(DOCIAG_TARGET_PASSED, WARN,  "Conveyor dociag target already passed by %u steps") \
+    X(DOCIAG_COMPLETED,     DEBUG, "Conveyor dociag completed - fully stopped") \
+    X(CAP_SET_MISSED,       WARN,  "Cap: set leading jar missed at sensor 2, set skipped") \
+    X(CAP_SET_LOST,         WARN,  "Cap: %u set(s) never reached sensor 2") \
+    X(STROKE_CONFIRMED,     DEBUG, "Valve pin %u: end of stroke in %u ms") \
+    X(STROKE_TIMEOUT,       WARN,  "Valve pin %u: no end-of-stroke signal within %u ms") \
+    X(STOP_PLANNED,         DEBUG, "Conveyor stop planned %u steps ahead (paint waits %u, cap waits %u)") \
+    X(STOP_COALESCED,       DEBUG, "Conveyor: paint and cap in one stop, targets %f mm apart") \
+    X(CONVEYOR_SPEED,       DEBUG, "Conveyor cruise speed: %u (0 approach, 1 transit)")
@@ -0,0 +1,235 @@
+// Тести src/input_scan.h: стратегії антидребезгу Debouncer і вибірка InputScan на ПК.
+//
+//   pio test -e native -f test_input_scan
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <unity.h>
+
+#include "../../src/input_scan.h"
+
+#include <stdlib.h>
+
+void setUp() {}
+void tearDown() {}
+
+typedef Debouncer<uint8_t, 4> Small;        // поріг до 15 вибірок
+
+// Подати послідовність рівнів одного входу (біт 0); рядок фронтів: '^' — фронт, '.' — ні
+static std::string feed(Small& d, const char* levels) {
+    std::string edges;
+    for (const char* p = levels; *p; p++) edges += d.update(*p == '1' ? 1 : 0) ? '^' : '.';
+    return edges;
+}
+
+// --- DEBOUNCE_STABLE ---
+
+void test_stable_edge_after_n_equal_samples() {
+    Small d;
+    d.reset(0);
+    d.configure(1, DEBOUNCE_STABLE, 3);
+    TEST_ASSERT_EQUAL_STRING("..^..", feed(d, "11111").c_str());
+    TEST_ASSERT_EQUAL(1, d.level());
+    TEST_ASSERT_EQUAL_STRING("..^", feed(d, "000").c_str());
+    TEST_ASSERT_EQUAL(0, d.level());
+}
+
+void test_stable_ignores_bounce_shorter_than_n() {
+    Small d;
+    d.reset(0);
+    d.configure(1, DEBOUNCE_STABLE, 3);
+    TEST_ASSERT_EQUAL_STRING("..........", feed(d, "1101011010").c_str());
+    TEST_ASSERT_EQUAL(0, d.level());
+    TEST_ASSERT_EQUAL_STRING("....^", feed(d, "10111").c_str());     // лічба — з останнього відскоку
+}
+
+// --- DEBOUNCE_LOCKOUT ---
+
+void test_lockout_edge_on_first_sample_then_deaf() {
+    Small d;
+    d.reset(0);
+    d.configure(1, DEBOUNCE_LOCKOUT, 4);
+    // Фронт одразу; наступні 3 вибірки (разом з фронтом — 4) вхід не слухається
+    TEST_ASSERT_EQUAL_STRING("^...", feed(d, "1010").c_str());
+    TEST_ASSERT_EQUAL(1, d.level());
+    // Після блокування рівень, що встиг змінитись, дає фронт на першій же вибірці
+    TEST_ASSERT_EQUAL_STRING("^", feed(d, "0").c_str());
+    TEST_ASSERT_EQUAL(0, d.level());
+}
+
+void test_lockout_holds_level_while_input_stays() {
+    Small d;
+    d.reset(1);
+    d.configure(1, DEBOUNCE_LOCKOUT, 2);
+    TEST_ASSERT_EQUAL_STRING("^.....", feed(d, "000000").c_str());
+    TEST_ASSERT_EQUAL(0, d.level());
+}
+
+// --- DEBOUNCE_INTEGRATOR ---
+
+void test_integrator_needs_n_more_active_than_idle() {
+    Small d;
+    d.reset(0);
+    d.configure(1, DEBOUNCE_INTEGRATOR, 4);
+    // +1 +1 -1 +1 -1 +1 +1 +1: до 4 лічильник доходить на останній вибірці
+    TEST_ASSERT_EQUAL_STRING(".......^", feed(d, "11010111").c_str());
+    TEST_ASSERT_EQUAL(1, d.level());
+}
+
+void test_integrator_saturates_at_n() {
+    Small d;
+    d.reset(0);
+    d.configure(1, DEBOUNCE_INTEGRATOR, 3);
+    TEST_ASSERT_EQUAL_STRING("..^.......", feed(d, "1111111111").c_str());
+    // Поодинокі провали не вимикають; після насичення до нуля — рівно 3 неактивні вибірки
+    TEST_ASSERT_EQUAL_STRING(".....", feed(d, "01011").c_str());
+    TEST_ASSERT_EQUAL_STRING("..^", feed(d, "000").c_str());
+    TEST_ASSERT_EQUAL(0, d.level());
+}
+
+// --- Налаштування ---
+
+void test_threshold_is_clamped() {
+    Small d;
+    d.reset(0);
+    d.configure(1, DEBOUNCE_STABLE, 0);             // менше 1 — 1
+    TEST_ASSERT_EQUAL_STRING("^", feed(d, "1").c_str());
+    d.reset(0);
+    d.configure(1, DEBOUNCE_STABLE, 1000);          // більше MAX_SAMPLES — 15
+    std::string ones(15, '1');
+    TEST_ASSERT_EQUAL_STRING("..............^", feed(d, ones.c_str()).c_str());
+}
+
+void test_reset_sets_level_without_edges() {
+    Small d;
+    d.reset(0x05);
+    TEST_ASSERT_EQUAL_HEX8(0x05, d.level());
+    TEST_ASSERT_EQUAL_HEX8(0, d.update(0x05));
+}
+
+// Перемикання стратегії скидає лічильники лише своїх входів
+void test_configure_keeps_other_inputs_counting() {
+    Small d;
+    d.reset(0);
+    d.configure(0x03, DEBOUNCE_STABLE, 3);
+    d.update(0x03);
+    d.update(0x03);
+    d.configure(0x02, DEBOUNCE_STABLE, 3);
+    TEST_ASSERT_EQUAL_HEX8(0x01, d.update(0x03));
+    TEST_ASSERT_EQUAL_HEX8(0x00, d.update(0x03));
+    TEST_ASSERT_EQUAL_HEX8(0x02, d.update(0x03));
+}
+
+// --- Усі стратегії разом проти простої моделі одного входу ---
+
+struct Model {
+    DebounceMode mode;
+    uint16_t n;
+    bool state;
+    uint16_t count;
+
+    bool update(bool s) {
+        switch (mode) {
+        case DEBOUNCE_STABLE:
+            if (s == state) {
+                count = 0;
+                return false;
+            }
+            if (++count < n) return false;
+            count = 0;
+            state = s;
+            return true;
+        case DEBOUNCE_LOCKOUT:
+            if (count == 0) {
+                if (s == state) return false;
+                state = s;
+                count = n > 1 ? 1 : 0;
+                return true;
+            }
+            if (++count == n) count = 0;
+            return false;
+        case DEBOUNCE_INTEGRATOR:
+            if (s && count < n) count++;
+            else if (!s && count > 0) count--;
+            if (count == n && !state) return state = true;
+            if (count == 0 && state) return !(state = false);
+            return false;
+        }
+        return false;
+    }
+};
+
+void test_mixed_modes_match_model() {
+    // Як у прошивці: 8-розрядні лічильники; 16 входів, кожен зі своєю стратегією і порогом
+    typedef Debouncer<uint16_t, 8> Wide;
+    const DebounceMode modes[] = {DEBOUNCE_STABLE, DEBOUNCE_LOCKOUT, DEBOUNCE_INTEGRATOR};
+    const uint16_t thresholds[] = {1, 2, 3, 7, 50, 100, 255};
+
+    srand(12345);
+    for (int round = 0; round < 20; round++) {
+        Wide d;
+        Model m[16];
+        uint16_t level = (uint16_t)rand();
+        d.reset(level);
+        for (uint8_t i = 0; i < 16; i++) {
+            m[i] = {modes[rand() % 3], thresholds[rand() % 7], (bool)((level >> i) & 1), 0};
+            d.configure((uint16_t)1 << i, m[i].mode, m[i].n);
+        }
+        // Кожен вхід перемикається з власною ймовірністю: від дребезгу на кожній вибірці
+        // до рівня, що тримається сотні вибірок
+        uint16_t raw = level;
+        uint16_t flipChance[16];
+        for (uint8_t i = 0; i < 16; i++) flipChance[i] = (uint16_t)(1 + rand() % 600);
+        for (int t = 0; t < 5000; t++) {
+            for (uint8_t i = 0; i < 16; i++) {
+                if (rand() % 1000 < flipChance[i]) raw ^= (uint16_t)1 << i;
+            }
+            uint16_t expected = 0;
+            for (uint8_t i = 0; i < 16; i++) {
+                if (m[i].update((raw >> i) & 1)) expected |= (uint16_t)1 << i;
+            }
+            uint16_t changed = d.update(raw);
+            TEST_ASSERT_EQUAL_HEX16(expected, changed);
+        }
+        uint16_t modelLevel = 0;
+        for (uint8_t i = 0; i < 16; i++) modelLevel |= (uint16_t)m[i].state << i;
+        TEST_ASSERT_EQUAL_HEX16(modelLevel, d.level());
+    }
+}
+
+// --- InputScan на ПК: кожен пін — у свій біт, у порядку списку ---
+
+void test_scan_bits_follow_pin_list() {
+    typedef InputScan<18, 3, 54> Scan;
+    TEST_ASSERT_EQUAL(1, sizeof(Scan::Mask));
+    TEST_ASSERT_EQUAL_HEX8(0x01, Scan::mask<18>());
+    TEST_ASSERT_EQUAL_HEX8(0x02, Scan::mask<3>());
+    TEST_ASSERT_EQUAL_HEX8(0x04, Scan::mask<54>());
+    TEST_ASSERT_EQUAL_HEX8(0x07, Scan::ALL);
+
+    pinMode(18, INPUT_PULLUP);
+    pinMode(3, INPUT_PULLUP);
+    pinMode(54, INPUT_PULLUP);
+    TEST_ASSERT_EQUAL_HEX8(0x07, Scan::sample());
+    native::board().setInput(3, LOW);
+    TEST_ASSERT_EQUAL_HEX8(0x05, Scan::sample());
+    native::board().setInput(54, LOW);
+    native::board().releaseInput(3);
+    TEST_ASSERT_EQUAL_HEX8(0x03, Scan::sample());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_stable_edge_after_n_equal_samples);
+    RUN_TEST(test_stable_ignores_bounce_shorter_than_n);
+    RUN_TEST(test_lockout_edge_on_first_sample_then_deaf);
+    RUN_TEST(test_lockout_holds_level_while_input_stays);
+    RUN_TEST(test_integrator_needs_n_more_active_than_idle);
+    RUN_TEST(test_integrator_saturates_at_n);
+    RUN_TEST(test_threshold_is_clamped);
+    RUN_TEST(test_reset_sets_level_without_edges);
+    RUN_TEST(test_configure_keeps_other_inputs_counting);
+    RUN_TEST(test_mixed_modes_match_model);
+    RUN_TEST(test_scan_bits_follow_pin_list);
+    return UNITY_END();
+}
@@ -0,0 +1,130 @@
+// Тести розгону і гальмування: src/ramp_table.h і StepEngine на віртуальному Timer3.
+// Інтервали між фронтами STEP — у тіках таймера, як їх видає таблиця.
+//
+//   pio test -e native -f test_ramp
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <unity.h>
+
+#include "../../src/step_engine.h"
+
+#include <stdlib.h>
+#include <vector>
+
+static constexpr uint64_t TICK_NS = 1000 / STEP_TIMER_TICKS_PER_US;
+
+static std::vector<uint64_t> stepTimes;    // моменти фронтів STEP, нс
+static bool listening = false;
+
+// Інтервали (тіки) між сусідніми кроками, починаючи з кроку from
+static std::vector<long> intervals(size_t from = 0) {
+    std::vector<long> result;
+    for (size_t i = from + 1; i < stepTimes.size(); i++) {
+        result.push_back((long)((stepTimes[i] - stepTimes[i - 1]) / TICK_NS));
+    }
+    return result;
+}
+
+// Крутити час, поки генератор не зупиниться
+static void runUntilStopped() {
+    for (int ms = 0; ms < 2000 && StepEngine::isMoving(); ms++) native::advanceMillis(1);
+}
+
+// Вийти на плато рівня level з місця і відкинути записані кроки розгону
+static void cruiseAt(uint16_t level) {
+    StepEngine::setCruiseLevel(level);
+    StepEngine::run();
+    native::advanceMillis(1000);
+    stepTimes.clear();
+    native::advanceMillis(20);
+}
+
+// Найбільша зміна різниці сусідніх інтервалів (друга різниця — ривок) на вікні з count інтервалів
+static long maxSecondDifference(const std::vector<long>& iv, size_t from, size_t count) {
+    long worst = 0;
+    for (size_t i = from + 2; i < from + count && i < iv.size(); i++) {
+        long d2 = labs(iv[i] - 2 * iv[i - 1] + iv[i - 2]);
+        if (d2 > worst) worst = d2;
+    }
+    return worst;
+}
+
+void setUp() {
+    native::resetClock();
+    StepEngine::begin();
+    if (!listening) {
+        native::board().onOutputChange([](uint8_t pin, bool level) {
+            if (pin == X_STEP_PIN && level) stepTimes.push_back(native::nanos());
+        });
+        listening = true;
+    }
+    stepTimes.clear();
+}
+
+void tearDown() { StepEngine::stop(); }
+
+// Рівні плато — межі ділянок таблиці: на них інтервал дорівнює інтервалу крейсерської швидкості
+void test_plateaus_are_segment_boundaries() {
+    const long approachTicks = (long)(1000000.0 * STEP_TIMER_TICKS_PER_US / (BELT_SPEED_XY_MM_PER_S * STEPS_PER_MM_XY) + 0.5);
+    TEST_ASSERT_EQUAL(RAMP_STEPS_XY, RAMP_TRANSIT_LEVEL_XY);
+    TEST_ASSERT_TRUE(RAMP_APPROACH_LEVEL_XY < RAMP_TRANSIT_LEVEL_XY);
+    TEST_ASSERT_INT_WITHIN(1, approachTicks, rampIntervalTicks(RAMP_APPROACH_LEVEL_XY - 1));
+    TEST_ASSERT_INT_WITHIN(1, approachTicks, rampIntervalTicks(RAMP_APPROACH_LEVEL_XY));
+    TEST_ASSERT_INT_WITHIN(1, RAMP_CRUISE_TICKS_XY, rampIntervalTicks(RAMP_TRANSIT_LEVEL_XY - 1));
+
+    // Гальмівний шлях з плато підходу — повна S-крива: v*(v/a + a/j)/2
+    const double v = BELT_SPEED_XY_MM_PER_S, a = BELT_ACCEL_XY_MM_PER_S2, j = BELT_JERK_XY_MM_PER_S3;
+    TEST_ASSERT_INT_WITHIN(1, (long)(v * (v / a + a / j) / 2 * STEPS_PER_MM_XY + 0.5), RAMP_APPROACH_LEVEL_XY);
+}
+
+// Зупинка зі швидкості підходу: прискорення наростає плавно, без стрибка на першому кроці гальмування
+void test_brake_from_approach_is_jerk_limited() {
+    cruiseAt(RAMP_APPROACH_LEVEL_XY);
+    size_t brakeAt = stepTimes.size();
+    uint32_t from = StepEngine::position();
+    StepEngine::brake();
+    runUntilStopped();
+
+    TEST_ASSERT_EQUAL_UINT32(RAMP_APPROACH_BRAKE_STEPS_XY, StepEngine::position() - from);
+    std::vector<long> iv = intervals();
+    // Перші 8 кроків гальмування: ривок 8000 мм/с³ за 4 мс дає лише ~1 тік приросту інтервалу;
+    // стрибок до повного прискорення дав би ~4 тіки на кожен крок
+    TEST_ASSERT_INT_WITHIN(3, iv[brakeAt - 2], iv[brakeAt + 6]);
+    TEST_ASSERT_LESS_OR_EQUAL(2, maxSecondDifference(iv, brakeAt - 8, 60));
+}
+
+// Зупинка в заданому положенні з плато підходу (дотягування) — той самий плавний профіль
+void test_stop_at_from_approach_is_jerk_limited() {
+    cruiseAt(RAMP_APPROACH_LEVEL_XY);
+    size_t last = stepTimes.size();
+    uint32_t target = StepEngine::position() + RAMP_APPROACH_BRAKE_STEPS_XY + 40;
+    TEST_ASSERT_TRUE(StepEngine::moveTo(target));
+    runUntilStopped();
+
+    TEST_ASSERT_EQUAL_UINT32(target, StepEngine::position());
+    std::vector<long> iv = intervals();
+    TEST_ASSERT_LESS_OR_EQUAL(2, maxSecondDifference(iv, last - 8, 100));
+}
+
+// Транзит -> підхід: уповільнення по своїй S-кривій і вихід на плато без стрибка прискорення
+void test_transit_to_approach_is_jerk_limited() {
+    cruiseAt(RAMP_TRANSIT_LEVEL_XY);
+    StepEngine::setCruiseLevel(RAMP_APPROACH_LEVEL_XY);
+    native::advanceMillis(400);
+
+    std::vector<long> iv = intervals();
+    // Вікно — від плато транзиту до плато підходу разом з виходом на нього
+    TEST_ASSERT_GREATER_THAN(RAMP_TRANSIT_LEVEL_XY - RAMP_APPROACH_LEVEL_XY + 100, iv.size());
+    TEST_ASSERT_LESS_OR_EQUAL(2, maxSecondDifference(iv, 0, iv.size()));
+    TEST_ASSERT_EQUAL(rampIntervalTicks(RAMP_APPROACH_LEVEL_XY), iv.back());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_plateaus_are_segment_boundaries);
+    RUN_TEST(test_brake_from_approach_is_jerk_limited);
+    RUN_TEST(test_stop_at_from_approach_is_jerk_limited);
+    RUN_TEST(test_transit_to_approach_is_jerk_limited);
+    return UNITY_END();
+}
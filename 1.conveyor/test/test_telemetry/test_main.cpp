@@ -0,0 +1,166 @@
+// Тести телеметрії: кадри src/telemetry.h (COBS, CRC-8) розбирає декодер ПК
+// (tools/telemetry_decode) — той самий, що читає порт.
+//
+//   pio test -e native -f test_telemetry
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <unity.h>
+
+#include "../../src/telemetry.h"
+#include "../../../tools/telemetry_decode/src/telemetry_decoder.h"
+
+#include <string>
+#include <vector>
+
+static std::vector<std::string> lines;
+
+static std::string& wire() { return native::board().serialOutput(); }
+
+// Дочекатися, поки кільце вийде в Serial (115200 — 11.5 байта за мс)
+static void drain() {
+    for (int ms = 0; ms < 100; ms++) {
+        native::advanceMillis(1);
+        Telemetry::service();
+    }
+}
+
+// Розібрати все, що вийшло в Serial, і повернути кількість зіпсованих кадрів
+static unsigned decode(const std::string& bytes) {
+    lines.clear();
+    TelemetryDecoder decoder([](const std::string& line) { lines.push_back(line); });
+    decoder.feed((const uint8_t*)bytes.data(), bytes.size());
+    decoder.finish();
+    return decoder.badFrames();
+}
+
+// Рядок журналу без часу: "<рівень> <повідомлення>"
+static std::string message(const std::string& line) { return line.substr(13); }
+
+void setUp() {
+    native::resetClock();
+    Telemetry::begin();
+    wire().clear();
+}
+
+void tearDown() {}
+
+void test_event_arguments_round_trip() {
+    native::advanceMicros(1234567);
+    telemetry::log<telemetry::EV_STOP_PLANNED>(300u, 1u, 0u);
+    telemetry::log<telemetry::EV_STOP_COALESCED>(12.5f);
+    drain();
+    TEST_ASSERT_EQUAL(0, decode(wire()));
+    TEST_ASSERT_EQUAL(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING("    1.234567 DEBUG Conveyor stop planned 300 steps ahead (paint waits 1, cap waits 0)\n",
+                             lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("    1.234567 DEBUG Conveyor: paint and cap in one stop, targets 12.50 mm apart\n",
+                             lines[1].c_str());
+}
+
+// Нулі в часі (0x000F4240) і в аргументах — COBS прибирає їх із кадру
+void test_zero_bytes_are_stuffed() {
+    native::advanceMicros(1000000);
+    telemetry::log<telemetry::EV_STOP_PLANNED>(0u, 0u, 256u);
+    drain();
+    size_t zeros = 0;
+    for (char c : wire()) zeros += c == 0;
+    TEST_ASSERT_EQUAL(1, zeros);                     // лише роздільник кадру
+    TEST_ASSERT_EQUAL(0, wire().back());
+    TEST_ASSERT_EQUAL(0, decode(wire()));
+    TEST_ASSERT_EQUAL(1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("    1.000000 DEBUG Conveyor stop planned 0 steps ahead (paint waits 0, cap waits 256)\n",
+                             lines[0].c_str());
+}
+
+// Varint на всю ширину: 1, 2, 3 і 5 байтів
+void test_varint_widths() {
+    telemetry::log<telemetry::EV_STOP_PLANNED>(127u, 128u, 300000UL);
+    telemetry::log<telemetry::EV_STROKE_TIMEOUT>((uint8_t)255, 0xFFFFFFFFUL);
+    drain();
+    TEST_ASSERT_EQUAL(0, decode(wire()));
+    TEST_ASSERT_EQUAL(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING("DEBUG Conveyor stop planned 127 steps ahead (paint waits 128, cap waits 300000)\n",
+                             message(lines[0]).c_str());
+    TEST_ASSERT_EQUAL_STRING("WARN  Valve pin 255: no end-of-stroke signal within 4294967295 ms\n",
+                             message(lines[1]).c_str());
+}
+
+// Зіпсований байт: кадр відкидається за CRC, наступний розбирається
+void test_corrupted_frame_is_rejected() {
+    telemetry::log<telemetry::EV_MACHINE_STARTED>();
+    telemetry::log<telemetry::EV_MACHINE_PAUSED>();
+    drain();
+    std::string bytes = wire();
+    size_t end = bytes.find('\0');
+    TEST_ASSERT_TRUE(end != std::string::npos && end > 3);
+    bytes[end - 2] ^= 0x10;
+    TEST_ASSERT_EQUAL(1, decode(bytes));
+    TEST_ASSERT_EQUAL(1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("INFO  Machine paused\n", message(lines[0]).c_str());
+}
+
+// Кадр, обірваний підключенням до порту посередині, не заважає наступному
+void test_decoder_resyncs_after_partial_frame() {
+    telemetry::log<telemetry::EV_MACHINE_STOPPED>();
+    telemetry::log<telemetry::EV_MACHINE_RESUMED>();
+    drain();
+    std::string bytes = wire().substr(3);
+    decode(bytes);
+    TEST_ASSERT_EQUAL(1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("INFO  Machine resumed\n", message(lines[0]).c_str());
+}
+
+// Повне кільце: події відкидаються, але жодна не губиться без сліду — DROPPED несе решту
+void test_dropped_events_are_counted() {
+    const unsigned N = 100;
+    for (unsigned i = 0; i < N; i++) telemetry::log<telemetry::EV_STOP_PLANNED>(i, 0u, 0u);
+    drain();
+    TEST_ASSERT_EQUAL(0, decode(wire()));
+    unsigned planned = 0, dropped = 0;
+    for (const std::string& l : lines) {
+        unsigned n;
+        if (sscanf(message(l).c_str(), "WARN  Telemetry: %u events dropped", &n) == 1) dropped += n;
+        else if (message(l).find("stop planned") != std::string::npos) planned++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, dropped);
+    TEST_ASSERT_EQUAL(N, planned + dropped);
+}
+
+// Текст відповідей: рядки довші за буфер TextPrint (32) склеюються декодером, '\r' прибирається
+void test_text_lines_are_reassembled() {
+    Telemetry::text().println(F("stats: 1234 sets, availability 97.5% since power-on"));
+    Telemetry::text().print(F("loop max "));
+    Telemetry::text().println(1500);
+    drain();
+    TEST_ASSERT_EQUAL(0, decode(wire()));
+    TEST_ASSERT_EQUAL(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING("stats: 1234 sets, availability 97.5% since power-on\n", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("loop max 1500\n", lines[1].c_str());
+}
+
+// micros() плати переповнюється кожні 71.6 хв — декодер розгортає час
+void test_time_unwraps_after_micros_overflow() {
+    native::advanceMicros(4294000000ULL);
+    telemetry::log<telemetry::EV_MACHINE_STARTED>();
+    native::advanceMicros(2000000);                 // 4296 с: micros() плати вже переповнився
+    telemetry::log<telemetry::EV_MACHINE_STOPPED>();
+    drain();
+    TEST_ASSERT_EQUAL(0, decode(wire()));
+    TEST_ASSERT_EQUAL(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING(" 4294.000000 INFO  Machine started\n", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(" 4296.000000 INFO  Machine stopped\n", lines[1].c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_event_arguments_round_trip);
+    RUN_TEST(test_zero_bytes_are_stuffed);
+    RUN_TEST(test_varint_widths);
+    RUN_TEST(test_corrupted_frame_is_rejected);
+    RUN_TEST(test_decoder_resyncs_after_partial_frame);
+    RUN_TEST(test_dropped_events_are_counted);
+    RUN_TEST(test_text_lines_are_reassembled);
+    RUN_TEST(test_time_unwraps_after_micros_overflow);
+    return UNITY_END();
+}
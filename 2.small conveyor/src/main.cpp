@@ -1,4 +1,10 @@
 #include <Arduino.h>
+#include <FixedKinematics.h>
+#include <StallWatchdog.h>
+#include <LineBus.h>
+#if !defined(__AVR__)
+#include <ArduinoNative.h>
+#endif
 
 /*
  * Конвеєр з розподілювачем №6 для упаковки баночок у шахматному порядку
@@ -9,6 +15,11 @@
  * - Пневмоклапан: пін 12
  * - Сигнальний світлодіод: пін 13
  * 
+ * Кроки генерує kin::DdaRamp (common/FixedKinematics) з переривання Timer1 (STEPPER_TICK_HZ
+ * разів на секунду), тож розгін, гальмування і дотягування йдуть незалежно від loop(): датчик,
+ * START/STOP і Serial обслуговуються весь час, у тому числі під час дотягування.
+ * У перериванні лише цілі числа: мм переводяться в кроки при зміні налаштувань.
+ * 
  * Налаштування мікростепів драйвера:
  * - 1x = повний крок (найшвидше, менша точність)
  * - 8x = 1/8 кроку (баланс швидкості та точності)
@@ -17,7 +28,7 @@
  * Команди через Serial Monitor (9600 baud):
  * - micro:1, micro:8, micro:16 - змінити мікростепи
  * - speed:XX - змінити швидкість (мм/с)
- * - decel:XX - змінити коефіцієнт гальмування (0.1-1.0)
+ * - accel:XX - змінити прискорення розгону/гальмування (мм/с²)
  * - status - показати поточний стан
  * - help - показати всі команди
  */
@@ -35,8 +46,8 @@ const int SIGNAL_PIN = 13;        // Пін сигналу готовності
 const int START_STOP_PIN = 11;  // сигнал для старту/стопу іншого контролера
 
 // Параметри двигуна
-const float PULLEY_DIAMETER_MM = 40.0;    // Діаметр шківа в мм
-const float DESIRED_SPEED_MM_S = 60.0;    // Бажана швидкість в мм/с
+constexpr float PULLEY_DIAMETER_MM = 40.0;    // Діаметр шківа в мм
+const float DESIRED_SPEED_MM_S = 60.0;    // Бажана швидкість в мм/с (до MAX_STEP_RATE кроків/с)
 const int STEPS_PER_REVOLUTION = 200;     // Кроків на оберт (повний крок)
 
 // Налаштування мікростепів драйвера
@@ -44,13 +55,13 @@ const int STEPS_PER_REVOLUTION = 200;     // Кроків на оберт (по
 int MICROSTEPS = 8;                       // Мікростепи (1 = повний крок, 8 = 1/8 кроку, 16 = 1/16 кроку)
 
 // Параметри дотягування для шахматного порядку
-const float CONVEYOR_Z_OFFSET_MM_FIRST = 10.0;   // Дотягування для 1-ї та 3-ї партії (мм)
-const float CONVEYOR_Z_OFFSET_MM_SECOND = 2.0;  // Дотягування для 2-ї та 4-ї партії (мм)
+const int32_t CONVEYOR_Z_OFFSET_UM_FIRST = kin::mmToUm(10.0);   // Дотягування для 1-ї та 3-ї партії (мм)
+const int32_t CONVEYOR_Z_OFFSET_UM_SECOND = kin::mmToUm(2.0);   // Дотягування для 2-ї та 4-ї партії (мм)
 
-// Параметри плавного гальмування
-const float MIN_DECELERATION_DISTANCE_MM = 0.5;  // Мінімальна відстань для гальмування (мм)
-const float MAX_DECELERATION_DISTANCE_MM = 8.0;  // Максимальна відстань для гальмування (мм)
-float DECELERATION_FACTOR = 0.3;                 // Коефіцієнт гальмування (0.1 = дуже плавно, 0.5 = швидко)
+// Параметри розгону і гальмування
+// Якщо з поточної швидкості не встигаємо загальмувати на дотягуванні з цим прискоренням,
+// гальмування на цьому дотягуванні робиться різкішим — конвеєр не проїжджає ціль.
+float ACCELERATION_MM_S2 = 300.0;                // Прискорення розгону/гальмування (мм/с²)
 
 // Параметри пневматики
 const unsigned long PNEUMATIC_DELAY_MS = 2000;   // Час роботи пневматики (мс) для партій 1–3
@@ -60,21 +71,44 @@ const unsigned long CYL_HOLD_TIME_MS = 2000;     // Час утримання у
 // Параметри сигналу
 const unsigned long SIGNAL_DELAY_MS = 5000;      // Час сигналу після 4 партій (мс)
 
+// Сторож зависань loop() (StallWatchdog): довша ітерація — скидання плати і звіт після старту.
+// Найдовша законна ітерація — відповідь на команду Serial (рядок команди не чекається)
+const uint16_t WATCHDOG_STALL_MS = 1500;
+const uint16_t WATCHDOG_EEPROM_ADDRESS = 0;      // звіт останнього зависання
+
+// Шина лінії (common/LineBus): малий конвеєр — ведений 1, Mega опитує його і передає свій стан.
+// Шина займає Serial (єдиний UART Uno) на LINE_BUS_BAUD: команди Serial тоді не працюють,
+// повідомлення йдуть у USB, поки трансивер не передає.
+#ifndef LINE_BUS_ENABLED
+#define LINE_BUS_ENABLED 0
+#endif
+const uint8_t LINE_BUS_ADDRESS = 1;
+const unsigned long LINE_BUS_BAUD = 115200;
+const uint8_t LINE_BUS_DE_PIN = 2;               // DE/RE трансивера RS-485
+
 // ========== РОЗРАХУНКОВІ ПАРАМЕТРИ ==========
 
-// Розрахунок кроків на мм (буде перераховано при зміні мікростепів)
-float MM_PER_STEP;
-float STEPS_PER_MM;
+// Кроків на мм при повному кроці (Q16.16, рахується при компіляції)
+const kin::q16_t FULL_STEPS_PER_MM_Q16 = kin::toQ16(STEPS_PER_REVOLUTION / (PULLEY_DIAMETER_MM * PI));
 
-// Розрахунок затримки між кроками для бажаної швидкості (буде перераховано)
-unsigned long STEP_DELAY_US;
+// Масштаб мкм <-> кроки (буде перераховано при зміні мікростепів)
+kin::StepScale stepScale;
+uint32_t stepRate;                               // Крейсерська швидкість, кроків/с
 
-// Мінімальна затримка між кроками (для стабільності)
-const unsigned long MIN_STEP_DELAY_US = 1000; // 1мс мінімум
+// Генератор кроків: Timer1 у режимі CTC (дільник 8) викликає stepperTick().
+// Крок робиться на тіку, тому інтервал між кроками кратний періоду переривання (50 мкс);
+// імпульс STEP триває один тік. Переривання має вкладатися в малу частку тіку (800 тактів):
+// у ньому лише цілочисельний kin::DdaRamp::tick() і запис у порт STEP, без float і digitalWrite().
+const unsigned long STEPPER_TICK_HZ = 20000;
+const uint16_t STEPPER_TIMER_TICKS = F_CPU / 8 / STEPPER_TICK_HZ;
+const uint32_t MAX_STEP_RATE = STEPPER_TICK_HZ / 3;  // Максимум кроків/с: не менше 3 тіків на крок
+const long CONTINUOUS_MOVE_STEPS = 1000000000L;  // Ціль «дуже далеко» для безперервного руху
 
 // Змінна для налаштування швидкості (можна змінювати через серіальний порт)
 float currentSpeed = DESIRED_SPEED_MM_S;
 
+kin::DdaRamp stepper(STEPPER_TICK_HZ);
+
 // ========== ЗМІННІ СТАНУ ==========
 
 enum ConveyorState {
@@ -91,8 +125,13 @@ int batchCount = 0;                    // Лічильник партій
 bool sensorState = false;              // Поточний стан датчика
 bool lastSensorState = false;          // Попередній стан датчика
 unsigned long stateStartTime = 0;      // Час початку поточного стану
-float currentOffset = 0;               // Поточне дотягування
+int32_t currentOffset = 0;             // Поточне дотягування, мкм
+long triggerPosition = 0;              // Положення двигуна (кроки) у момент спрацювання датчика
 bool ignoreSensor = false;             // Ігнорувати датчик під час роботи пневматики
+uint16_t batchesTotal = 0;             // Партій від увімкнення (для шини лінії)
+#if LINE_BUS_ENABLED
+LineBus lineBus(Serial, LINE_BUS_ADDRESS, LINE_BUS_DE_PIN);
+#endif
 
 // ========== ПРОТОТИПИ ФУНКЦІЙ ==========
 
@@ -102,11 +141,14 @@ void handleSensorTriggeredState();
 void handlePullingState();
 void handlePneumaticWorkingState();
 void handleSignalActiveState();
-void performPull(float offsetMm);
-void performSmoothPull(float offsetMm);
-float calculateDecelerationDistance(float totalDistance);
+void startStepperTimer();
+void startMoving();
+void startPull(int32_t offsetUm);
+void stopMotor();
 void checkSerialCommands();
+bool readCommandLine(String& line);
 void recalculateParameters();
+void serviceLineBus();
 
 // ========== ФУНКЦІЇ ==========
 
@@ -122,38 +164,52 @@ void setup() {
 
   // Початкові стани
   digitalWrite(ENABLE_PIN, HIGH);      // Вимкнути драйвер
+  digitalWrite(DIR_PIN, HIGH);         // Напрямок руху
   digitalWrite(PNEUMATIC_PIN, HIGH);   // Вимкнути пневматику (інвертований сигнал)
   digitalWrite(SIGNAL_PIN, LOW);       // Вимкнути сигнал
   
   // Налаштування серіального порту для налагодження
+#if LINE_BUS_ENABLED
+  Serial.begin(LINE_BUS_BAUD);
+  lineBus.begin();
+#else
   Serial.begin(9600);
+#endif
   
-  // Розрахувати початкові параметри
+  // Розрахувати початкові параметри і запустити генератор кроків
   recalculateParameters();
+  startStepperTimer();
   
   Serial.println("Конвеєр з розподілювачем №6 запущено");
   Serial.println("Параметри:");
-  Serial.print("Швидкість: "); Serial.print(DESIRED_SPEED_MM_S); Serial.println(" мм/с");
+  Serial.print("Швидкість: "); Serial.print(currentSpeed); Serial.println(" мм/с");
   Serial.print("Мікростепи: "); Serial.print(MICROSTEPS); Serial.println("x");
-  Serial.print("Кроків на мм: "); Serial.println(STEPS_PER_MM);
-  Serial.print("Розрахована затримка: "); Serial.print(STEP_DELAY_US); Serial.println(" мкс");
-  Serial.print("Мінімальна затримка: "); Serial.print(MIN_STEP_DELAY_US); Serial.println(" мкс");
-  Serial.print("Фактична затримка: "); Serial.print(max(STEP_DELAY_US - 10, MIN_STEP_DELAY_US)); Serial.println(" мкс");
-  Serial.print("Коефіцієнт гальмування: "); Serial.println(DECELERATION_FACTOR);
-  Serial.print("Відстань гальмування: "); Serial.print(MIN_DECELERATION_DISTANCE_MM); 
-  Serial.print(" - "); Serial.print(MAX_DECELERATION_DISTANCE_MM); Serial.println(" мм");
+  Serial.print("Кроків на мм: "); Serial.println(kin::toFloat(stepScale.stepsPerMm()));
+  Serial.print("Кроків за секунду: "); Serial.println(stepRate);
+  Serial.print("Прискорення: "); Serial.print(ACCELERATION_MM_S2); Serial.println(" мм/с²");
+  Serial.print("Відстань гальмування: "); 
+  Serial.print(currentSpeed * currentSpeed / (2.0 * ACCELERATION_MM_S2)); Serial.println(" мм");
   
   currentState = IDLE;
+
+  if (StallWatchdog::begin(WATCHDOG_STALL_MS, WATCHDOG_EEPROM_ADDRESS)) StallWatchdog::printReport(Serial);
 }
 
+// Окрема функція і при LTO: tools/avr_bench міряє період loop() за входом у неї
+void loop() __attribute__((noinline));
+
 void loop() {
+  StallWatchdog::kick(currentState, batchCount);
+  // Відповідати ведучому і на зупинці
+  serviceLineBus();
+
   // Перевірка дозволу роботи з відслідковуванням фронту сигналу START/STOP
   static bool lastStartSignalHigh = false; // запам'ятовуємо попередній стан сигналу
   bool startSignalHigh = (digitalRead(START_STOP_PIN) == HIGH);
 
   if (!startSignalHigh) {
     // При низькому рівні зупиняємо все
-    digitalWrite(ENABLE_PIN, HIGH);      // Вимкнути драйвер
+    stopMotor();                         // Миттєва зупинка і вимкнення драйвера
     digitalWrite(PNEUMATIC_PIN, HIGH);   // Вимкнути пневматику
     digitalWrite(SIGNAL_PIN, LOW);       // Вимкнути сигнал
     lastStartSignalHigh = false;         // фіксуємо, що сигнал був LOW
@@ -168,8 +224,10 @@ void loop() {
   }
   lastStartSignalHigh = startSignalHigh;
 
-  // Перевірка команд через серіальний порт
+  // Перевірка команд через серіальний порт (з шиною Serial зайнятий нею)
+#if !LINE_BUS_ENABLED
   checkSerialCommands();
+#endif
   
   // Читання стану датчика
   sensorState = digitalRead(SENSOR_PIN) == LOW; // LOW = спрацював (підтяжка до VCC)
@@ -203,56 +261,45 @@ void loop() {
   
   // Оновлення попереднього стану датчика
   lastSensorState = sensorState;
-  
-  // Невелика затримка тільки для станів, де не потрібен постійний рух
-  if (currentState != MOVING && currentState != PULLING) {
-    delay(10);
-  }
 }
 
 void handleIdleState() {
-  // Увімкнути драйвер і почати рух
-  digitalWrite(ENABLE_PIN, LOW);
-  digitalWrite(DIR_PIN, HIGH); // Напрямок руху
+  // Увімкнути драйвер і почати рух з розгоном
+  startMoving();
   currentState = MOVING;
   stateStartTime = millis();
   Serial.println("Конвеєр почав рух");
 }
 
 void handleMovingState() {
-  // Виконання кроку
-  digitalWrite(STEP_PIN, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(STEP_PIN, LOW);
-  
-  // Розрахувати затримку на основі поточної швидкості та поточних мікростепів
-  unsigned long stepDelay = (unsigned long)(1000000.0 / (currentSpeed * STEPS_PER_MM));
-  unsigned long actualDelay = max(stepDelay - 10, MIN_STEP_DELAY_US);
-  delayMicroseconds(actualDelay);
-  
-  // Перевірка датчика (тільки якщо не ігноруємо)
+  // Кроки робить переривання, тут лише перевірка датчика (тільки якщо не ігноруємо)
   if (!ignoreSensor && sensorState && !lastSensorState) {
-    // Датчик спрацював
+    // Датчик спрацював: запам'ятати місце, від якого рахується дотягування
+    noInterrupts();
+    triggerPosition = stepper.position();
+    interrupts();
     currentState = SENSOR_TRIGGERED;
     stateStartTime = millis();
-    Serial.println("Датчик спрацював!");
   }
 }
 
 void handleSensorTriggeredState() {
-  // Зупинити конвеєр
-  digitalWrite(ENABLE_PIN, HIGH);
-  
   // Визначити яка це партія і відповідне дотягування
   batchCount++;
+  batchesTotal++;
   if (batchCount == 1 || batchCount == 3) {
-    currentOffset = CONVEYOR_Z_OFFSET_MM_FIRST;
+    currentOffset = CONVEYOR_Z_OFFSET_UM_FIRST;
   } else {
-    currentOffset = CONVEYOR_Z_OFFSET_MM_SECOND;
+    currentOffset = CONVEYOR_Z_OFFSET_UM_SECOND;
   }
   
+  // Дотягування від місця спрацювання датчика з гальмуванням до цілі.
+  // Конвеєр їде, поки друкуються повідомлення, тож ціль задається до них.
+  startPull(currentOffset);
+  
+  Serial.println("Датчик спрацював!");
   Serial.print("=== ПАРТІЯ "); Serial.print(batchCount); Serial.println(" ===");
-  Serial.print("Дотягування: "); Serial.print(currentOffset); Serial.println(" мм");
+  Serial.print("Дотягування: "); Serial.print(currentOffset / 1000.0); Serial.println(" мм");
   Serial.println("Пневматика буде активна на цій зупинці");
   
   // Встановити ігнорування датчика
@@ -263,8 +310,15 @@ void handleSensorTriggeredState() {
 }
 
 void handlePullingState() {
-  // Виконати плавне дотягування
-  performSmoothPull(currentOffset);
+  // Чекати, поки конвеєр дійде до цілі дотягування
+  noInterrupts();
+  bool arrived = !stepper.isMoving();
+  interrupts();
+  if (!arrived) return;
+  
+  // Вимкнути драйвер на час роботи пневматики
+  digitalWrite(ENABLE_PIN, HIGH);
+  Serial.println("Плавне дотягування завершено");
   
   // Перейти до роботи пневматики
   currentState = PNEUMATIC_WORKING;
@@ -352,45 +406,74 @@ void handleSignalActiveState() {
   }
 }
 
-void performPull(float offsetMm) {
-  // Розрахувати кількість кроків для дотягування
-  int steps = (int)(offsetMm * STEPS_PER_MM);
-  
-  Serial.print("Виконуємо дотягування на "); Serial.print(offsetMm); 
-  Serial.print(" мм ("); Serial.print(steps); Serial.println(" кроків)");
-  
-  // Увімкнути драйвер
-  digitalWrite(ENABLE_PIN, LOW);
-  digitalWrite(DIR_PIN, HIGH); // Напрямок дотягування
-  
-  // Виконати кроки
-  for (int i = 0; i < steps; i++) {
-    digitalWrite(STEP_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(STEP_PIN, LOW);
-    
-    // Розрахувати затримку на основі поточної швидкості та поточних мікростепів
-    unsigned long stepDelay = (unsigned long)(1000000.0 / (currentSpeed * STEPS_PER_MM));
-    unsigned long actualDelay = max(stepDelay - 10, MIN_STEP_DELAY_US);
-    delayMicroseconds(actualDelay);
+// Стан для шини лінії і повідомлення про роботу конвеєра перед малим: скільки спайок
+// закрито і коли прийде наступна (прогноз Mega за середнім циклом)
+void serviceLineBus() {
+#if LINE_BUS_ENABLED
+  StationStatus& s = lineBus.local();
+  s.state = currentState;
+  s.flags = 0;
+  if (digitalRead(START_STOP_PIN) == HIGH) s.flags |= linebus::RUNNING;
+  if (digitalRead(SIGNAL_PIN) == HIGH) s.flags |= linebus::READY;
+  if (currentState == SENSOR_TRIGGERED || currentState == PULLING || currentState == PNEUMATIC_WORKING) {
+    s.flags |= linebus::BUSY;
   }
-  
-  // Вимкнути драйвер
-  digitalWrite(ENABLE_PIN, HIGH);
+  s.counter = batchesTotal;
+  s.incoming = batchCount;               // партій на платформі для наступного пакету
+  s.etaMs = linebus::ETA_UNKNOWN;
+  lineBus.update();
+
+  static uint16_t lastCapped = 0;
+  static bool wasOnline = false;
+  bool online = lineBus.upstreamOnline();
+  if (online != wasOnline) {
+    Serial.println(online ? "Шина: конвеєр на зв'язку" : "Шина: немає зв'язку з конвеєром");
+    wasOnline = online;
+  }
+  const StationStatus& up = lineBus.upstream();
+  if (online && up.counter != lastCapped) {
+    lastCapped = up.counter;
+    Serial.print("Шина: конвеєр закрив спайок: "); Serial.print(up.counter);
+    if (up.etaMs != linebus::ETA_UNKNOWN) {
+      Serial.print(", наступна через "); Serial.print(up.etaMs); Serial.print(" мс");
+    }
+    Serial.println();
+  }
+#endif
+}
+
+// Рядок команди набирається з того, що вже прийшло, без очікування: readStringUntil()
+// чекав би кінця рядка до 1 с усередині ітерації. true — рядок завершено '\n'
+bool readCommandLine(String& line) {
+  static char buffer[24];
+  static uint8_t length = 0;
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\n') {
+      buffer[length] = '\0';
+      line = buffer;
+      length = 0;
+      return true;
+    }
+    if (length < sizeof(buffer) - 1) buffer[length++] = c;   // довший рядок обрізається
+  }
+  return false;
 }
 
 void checkSerialCommands() {
-  if (Serial.available()) {
-    String command = Serial.readStringUntil('\n');
+  String command;
+  if (readCommandLine(command)) {
     command.trim();
     
     if (command.startsWith("speed:")) {
       float newSpeed = command.substring(6).toFloat();
-      if (newSpeed > 0 && newSpeed <= 200) {
+      if (newSpeed > 0 && newSpeed <= 200 && (uint32_t)stepScale.steps(newSpeed * 1000) <= MAX_STEP_RATE) {
         currentSpeed = newSpeed;
+        recalculateParameters();
         Serial.print("Швидкість змінено на: "); Serial.print(currentSpeed); Serial.println(" мм/с");
       } else {
-        Serial.println("Невірна швидкість! Діапазон: 0.1 - 200 мм/с");
+        Serial.print("Невірна швидкість! Діапазон: 0.1 - ");
+        Serial.print(min(200.0, stepScale.um(MAX_STEP_RATE) / 1000.0)); Serial.println(" мм/с");
       }
     } else if (command.startsWith("micro:")) {
       int newMicrosteps = command.substring(6).toInt();
@@ -399,31 +482,32 @@ void checkSerialCommands() {
         MICROSTEPS = newMicrosteps;
         recalculateParameters();
         Serial.print("Мікростепи змінено на: "); Serial.print(MICROSTEPS); Serial.println("x");
-        Serial.print("Нові кроки на мм: "); Serial.println(STEPS_PER_MM);
-        Serial.print("Нова затримка: "); Serial.print(STEP_DELAY_US); Serial.println(" мкс");
+        Serial.print("Нові кроки на мм: "); Serial.println(kin::toFloat(stepScale.stepsPerMm()));
+        Serial.print("Швидкість: "); Serial.print(currentSpeed); Serial.println(" мм/с");
       } else {
         Serial.println("Невірні мікростепи! Доступні: 1, 2, 4, 8, 16");
       }
-    } else if (command.startsWith("decel:")) {
-      float newDecelFactor = command.substring(6).toFloat();
-      if (newDecelFactor >= 0.1 && newDecelFactor <= 1.0) {
-        DECELERATION_FACTOR = newDecelFactor;
-        Serial.print("Коефіцієнт гальмування змінено на: "); Serial.println(DECELERATION_FACTOR);
+    } else if (command.startsWith("accel:")) {
+      float newAcceleration = command.substring(6).toFloat();
+      if (newAcceleration >= 10 && newAcceleration <= 5000) {
+        ACCELERATION_MM_S2 = newAcceleration;
+        recalculateParameters();
+        Serial.print("Прискорення змінено на: "); Serial.print(ACCELERATION_MM_S2); Serial.println(" мм/с²");
       } else {
-        Serial.println("Невірний коефіцієнт гальмування! Діапазон: 0.1 - 1.0");
+        Serial.println("Невірне прискорення! Діапазон: 10 - 5000 мм/с²");
       }
     } else if (command == "status") {
       Serial.print("Поточна швидкість: "); Serial.print(currentSpeed); Serial.println(" мм/с");
       Serial.print("Мікростепи: "); Serial.print(MICROSTEPS); Serial.println("x");
-      Serial.print("Кроків на мм: "); Serial.println(STEPS_PER_MM);
-      Serial.print("Коефіцієнт гальмування: "); Serial.println(DECELERATION_FACTOR);
+      Serial.print("Кроків на мм: "); Serial.println(kin::toFloat(stepScale.stepsPerMm()));
+      Serial.print("Прискорення: "); Serial.print(ACCELERATION_MM_S2); Serial.println(" мм/с²");
       Serial.print("Стан: "); Serial.println(currentState);
       Serial.print("Партія: "); Serial.println(batchCount);
     } else if (command == "help") {
       Serial.println("Команди:");
       Serial.println("speed:XX - встановити швидкість (наприклад: speed:30)");
       Serial.println("micro:XX - встановити мікростепи (1, 2, 4, 8, 16)");
-      Serial.println("decel:XX - встановити коефіцієнт гальмування (0.1-1.0)");
+      Serial.println("accel:XX - встановити прискорення, мм/с² (наприклад: accel:300)");
       Serial.println("status - показати поточний стан");
       Serial.println("help - показати цю довідку");
     }
@@ -431,90 +515,102 @@ void checkSerialCommands() {
 }
 
 void recalculateParameters() {
-  // Перерахунок кроків на мм
-  MM_PER_STEP = (PULLEY_DIAMETER_MM * PI) / (STEPS_PER_REVOLUTION * MICROSTEPS);
-  STEPS_PER_MM = 1.0 / MM_PER_STEP;
-  
-  // Перерахунок затримки між кроками
-  STEP_DELAY_US = (unsigned long)(1000000.0 / (DESIRED_SPEED_MM_S * STEPS_PER_MM));
-}
-
-float calculateDecelerationDistance(float totalDistance) {
-  // Розрахувати відстань гальмування на основі загальної відстані
-  // Для коротких відстаней - більш різке гальмування
-  // Для довгих відстаней - більш плавне гальмування
-  
-  float decelDistance;
-  
-  if (totalDistance <= 3.0) {
-    // Для коротких відстаней (до 3 мм) - швидке гальмування
-    decelDistance = MIN_DECELERATION_DISTANCE_MM;
-  } else if (totalDistance <= 8.0) {
-    // Для середніх відстаней (3-8 мм) - пропорційне гальмування
-    decelDistance = MIN_DECELERATION_DISTANCE_MM + 
-                   (totalDistance - 3.0) * (MAX_DECELERATION_DISTANCE_MM - MIN_DECELERATION_DISTANCE_MM) / 5.0;
-  } else {
-    // Для довгих відстаней (більше 8 мм) - максимальне плавне гальмування
-    decelDistance = MAX_DECELERATION_DISTANCE_MM;
+  // Перерахунок кроків на мм: множення Q16.16 на ціле, без ділення
+  stepScale = kin::StepScale(FULL_STEPS_PER_MM_Q16 * MICROSTEPS);
+  stepRate = stepScale.steps(currentSpeed * 1000);
+  
+  // Швидкість обмежена частотою тіків генератора кроків
+  if (stepRate > MAX_STEP_RATE) {
+    stepRate = MAX_STEP_RATE;
+    currentSpeed = stepScale.um(MAX_STEP_RATE) / 1000.0;
+    Serial.print("Швидкість обмежено до "); Serial.print(currentSpeed); Serial.println(" мм/с");
   }
   
-  // Переконатися, що відстань гальмування не перевищує половину загальної відстані
-  decelDistance = min(decelDistance, totalDistance * 0.5);
-  
-  return decelDistance;
+  // Передати швидкість і прискорення генератору кроків
+  noInterrupts();
+  stepper.setMaxSpeed(stepRate);
+  stepper.setAcceleration(stepScale.steps(ACCELERATION_MM_S2 * 1000));
+  interrupts();
 }
 
-void performSmoothPull(float offsetMm) {
-  // Розрахувати кількість кроків для дотягування
-  int totalSteps = (int)(offsetMm * STEPS_PER_MM);
-  
-  // Розрахувати відстань гальмування
-  float decelDistanceMm = calculateDecelerationDistance(offsetMm);
-  int decelSteps = (int)(decelDistanceMm * STEPS_PER_MM);
-  
-  // Кроки з постійною швидкістю
-  int constantSpeedSteps = totalSteps - decelSteps;
-  
-  Serial.print("Виконуємо плавне дотягування на "); Serial.print(offsetMm); 
-  Serial.print(" мм ("); Serial.print(totalSteps); Serial.println(" кроків)");
-  Serial.print("Відстань гальмування: "); Serial.print(decelDistanceMm); 
-  Serial.print(" мм ("); Serial.print(decelSteps); Serial.println(" кроків)");
-  
-  // Увімкнути драйвер
+void startMoving() {
   digitalWrite(ENABLE_PIN, LOW);
-  digitalWrite(DIR_PIN, HIGH); // Напрямок дотягування
+  noInterrupts();
+  stepper.moveTo(stepper.position() + CONTINUOUS_MOVE_STEPS);
+  interrupts();
+}
+
+void startPull(int32_t offsetUm) {
+  long steps = stepScale.steps(offsetUm);
   
-  // Розрахувати базову затримку для поточної швидкості
-  unsigned long baseStepDelay = (unsigned long)(1000000.0 / (currentSpeed * STEPS_PER_MM));
-  baseStepDelay = max(baseStepDelay - 10, MIN_STEP_DELAY_US);
+  // Якщо з поточної швидкості не встигаємо стати на цілі з ACCELERATION_MM_S2,
+  // генератор сам гальмує різкіше — конвеєр не проїжджає ціль
+  noInterrupts();
+  stepper.moveTo(triggerPosition + steps);
+  uint32_t deceleration = stepper.deceleration();
+  interrupts();
   
-  // Етап 1: Рух з постійною швидкістю
-  for (int i = 0; i < constantSpeedSteps; i++) {
-    digitalWrite(STEP_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(STEP_PIN, LOW);
-    delayMicroseconds(baseStepDelay);
+  Serial.print("Виконуємо плавне дотягування на "); Serial.print(offsetUm / 1000.0); 
+  Serial.print(" мм ("); Serial.print(steps); Serial.println(" кроків)");
+  Serial.print("Гальмування: "); Serial.print(stepScale.um(deceleration) / 1000.0); Serial.println(" мм/с²");
+}
+
+void stopMotor() {
+  // Скинути ціль і швидкість: переривання більше не робить кроків
+  noInterrupts();
+  stepper.stop();
+  interrupts();
+  digitalWrite(ENABLE_PIN, HIGH);
+}
+
+#if defined(__AVR__)
+// Порт і біт STEP_PIN — один раз у startStepperTimer(): digitalWrite() у перериванні щоразу
+// шукає їх у таблицях flash і перевіряє ШІМ
+volatile uint8_t* stepPort;
+uint8_t stepMask;
+
+inline void stepPinWrite(bool level) {
+  if (level) *stepPort |= stepMask;      // переривання вже вимкнені — запис атомарний
+  else *stepPort &= ~stepMask;
+}
+#else
+inline void stepPinWrite(bool level) { digitalWrite(STEP_PIN, level); }
+#endif
+
+// Раз на тік Timer1: зняти імпульс попереднього кроку і, якщо настав час, зробити наступний
+void stepperTick() {
+  static bool stepPulse = false;
+  if (stepPulse) {
+    stepPinWrite(LOW);
+    stepPulse = false;
   }
-  
-  // Етап 2: Плавне гальмування
-  for (int i = 0; i < decelSteps; i++) {
-    digitalWrite(STEP_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(STEP_PIN, LOW);
-    
-    // Розрахувати поточну затримку для гальмування
-    // Використовуємо квадратичну функцію для плавного збільшення затримки
-    float progress = (float)i / (float)decelSteps; // 0.0 до 1.0
-    float decelFactor = 1.0 + (progress * progress * DECELERATION_FACTOR * 10.0);
-    
-    unsigned long currentDelay = (unsigned long)(baseStepDelay * decelFactor);
-    currentDelay = max(currentDelay, MIN_STEP_DELAY_US);
-    
-    delayMicroseconds(currentDelay);
+  if (stepper.tick()) {
+    stepPinWrite(HIGH);
+    stepPulse = true;
   }
-  
-  // Вимкнути драйвер
-  digitalWrite(ENABLE_PIN, HIGH);
-  
-  Serial.println("Плавне дотягування завершено");
 }
+
+#if defined(__AVR__)
+void startStepperTimer() {
+  stepPort = portOutputRegister(digitalPinToPort(STEP_PIN));
+  stepMask = digitalPinToBitMask(STEP_PIN);
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS11);     // CTC, TOP = OCR1A, дільник 8
+  TCNT1 = 0;
+  OCR1A = STEPPER_TIMER_TICKS - 1;
+  TIFR1 = _BV(OCF1A);
+  TIMSK1 = _BV(OCIE1A);
+  interrupts();
+}
+
+ISR(TIMER1_COMPA_vect) { stepperTick(); }
+#else
+native::CtcTimer stepperTimer(8000000000ULL / F_CPU);
+
+void startStepperTimer() {
+  stepperTimer.onCompareA(stepperTick);
+  stepperTimer.start(STEPPER_TIMER_TICKS, STEPPER_TIMER_TICKS);
+}
+#endif
+
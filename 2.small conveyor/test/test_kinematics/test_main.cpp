@@ -0,0 +1,269 @@
+// Тести common/FixedKinematics на масштабах малого конвеєра: округлення Q16.16, перетворення
+// мкм <-> кроки і зупинка DdaRamp рівно на цілі.
+//
+//   pio test -e native -f test_kinematics
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <FixedKinematics.h>
+#include <StallWatchdog.h>
+#include <LineBus.h>
+#include <unity.h>
+
+#include <math.h>
+#include <vector>
+
+// Прошивка — у своєму просторі імен, як у двійнику лінії: масштаби беруться з її констант
+namespace fw {
+#include "../../src/main.cpp"
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Масштаб прошивки для мікростепів m — як у recalculateParameters()
+static kin::StepScale firmwareScale(int m) { return kin::StepScale(fw::FULL_STEPS_PER_MM_Q16 * m); }
+
+// Масштаби прошивки для всіх мікростепів, які приймає команда micro:
+static std::vector<kin::StepScale> roundTripScales() {
+    std::vector<kin::StepScale> scales;
+    for (int m : {1, 2, 4, 8, 16}) scales.push_back(firmwareScale(m));
+    // Регресія: 80.2 кроку на мм (шків 12.7 мм, 1/16) — з відкиданням дробу в StepScale
+    // кроки -> мкм -> кроки збивались на крок уже за 200000 кроків
+    scales.push_back(kin::StepScale(kin::toQ16(16 * 200.0 / (12.7 * M_PI))));
+    return scales;
+}
+
+// --- Q16.16 і константи при компіляції ---
+
+void test_to_q16_rounds_to_nearest() {
+    TEST_ASSERT_EQUAL_INT32(65536, kin::toQ16(1.0));
+    TEST_ASSERT_EQUAL_INT32(40L * 65536, kin::toQ16(40.0));
+    TEST_ASSERT_EQUAL_INT32(21845, kin::toQ16(1.0 / 3));            // 21845.33
+    TEST_ASSERT_EQUAL_INT32(43691, kin::toQ16(2.0 / 3));            // 43690.67
+    TEST_ASSERT_EQUAL_INT32(1, kin::toQ16(0.5 / 65536));            // половина — від нуля
+    TEST_ASSERT_EQUAL_INT32(-1, kin::toQ16(-0.5 / 65536));
+    TEST_ASSERT_EQUAL_INT32(-43691, kin::toQ16(-2.0 / 3));
+}
+
+void test_mm_to_um_rounds_to_nearest() {
+    TEST_ASSERT_EQUAL_INT32(1234, kin::mmToUm(1.2344));
+    TEST_ASSERT_EQUAL_INT32(1235, kin::mmToUm(1.2346));
+    TEST_ASSERT_EQUAL_INT32(-1235, kin::mmToUm(-1.2346));
+    TEST_ASSERT_EQUAL_INT32(400000, kin::mmToUm(400.0));
+}
+
+void test_compile_time_steps_and_ticks() {
+    static_assert(kin::mmToSteps(10.0, 40.0) == 400, "mmToSteps");
+    static_assert(kin::stepTicks(50.0, 40.0, 2000000.0) == 1000, "stepTicks");
+    TEST_ASSERT_EQUAL_UINT32(13, kin::mmToSteps(0.33, 40.0));       // 13.2
+    TEST_ASSERT_EQUAL_UINT32(14, kin::mmToSteps(0.34, 40.0));       // 13.6
+    TEST_ASSERT_EQUAL_UINT32(333, kin::stepTicks(50.0, 40.0, 666666.0));   // 333.33
+}
+
+void test_to_float_for_reports() {
+    TEST_ASSERT_TRUE(fabsf(kin::toFloat(kin::toQ16(62.5)) - 62.5f) < 1e-6f);
+}
+
+void test_isqrt_rounds_down() {
+    TEST_ASSERT_EQUAL_UINT32(0, kin::isqrt(0));
+    TEST_ASSERT_EQUAL_UINT32(1, kin::isqrt(3));
+    TEST_ASSERT_EQUAL_UINT32(2, kin::isqrt(4));
+    TEST_ASSERT_EQUAL_UINT32(65535, kin::isqrt(0xFFFFFFFFUL));
+    for (uint32_t x = 1; x < 0xFFFF0000UL; x += 65521) {
+        uint32_t r = kin::isqrt(x);
+        TEST_ASSERT_TRUE((uint64_t)r * r <= x && (uint64_t)(r + 1) * (r + 1) > x);
+    }
+}
+
+// --- StepScale ---
+
+// Кроки з мкм — найближче ціле до точного значення (похибка масштабу Q0.32 — менше 0.001 кроку)
+void test_step_scale_steps_match_exact() {
+    const kin::StepScale scales[] = {firmwareScale(1), firmwareScale(16), kin::StepScale(kin::toQ16(999.0))};  // 999 — межа бібліотеки
+    for (const kin::StepScale& scale : scales) {
+        double q = scale.stepsPerMm() / 65536.0;
+        for (int32_t um = -2000000; um <= 2000000; um += 997) {
+            double exact = um * q / 1000.0;
+            TEST_ASSERT_TRUE(fabs(scale.steps(um) - exact) <= 0.5 + 1e-3);
+        }
+    }
+}
+
+// Кроки -> мкм -> кроки повертає те саме число на мільйоні кроків в обидва боки (39 м на
+// 1/16). Масштаби округлені до найближчого, тож похибка мкм на крок не набігає
+void test_step_scale_round_trip_from_steps() {
+    for (const kin::StepScale& scale : roundTripScales()) {
+        for (int32_t steps = -1000000; steps <= 1000000; steps += 7) {
+            TEST_ASSERT_EQUAL_INT32(steps, scale.steps(scale.um(steps)));
+        }
+    }
+}
+
+// Мкм -> кроки -> мкм — не далі за півкроку від початкової відстані
+void test_step_scale_round_trip_from_um() {
+    for (const kin::StepScale& scale : roundTripScales()) {
+        int32_t halfStepUm = (int32_t)(500.0 * 65536 / scale.stepsPerMm()) + 1;
+        for (int32_t um = -1000000; um <= 1000000; um += 131) {
+            TEST_ASSERT_INT32_WITHIN(halfStepUm, um, scale.um(scale.steps(um)));
+        }
+    }
+}
+
+// Шків прошивки і дотягування партій при мікростепах за замовчуванням
+void test_step_scale_known_values() {
+    const double stepsPerMm = fw::MICROSTEPS * fw::STEPS_PER_REVOLUTION / (fw::PULLEY_DIAMETER_MM * M_PI);
+    TEST_ASSERT_EQUAL_INT32(8, fw::MICROSTEPS);
+    kin::StepScale scale = firmwareScale(fw::MICROSTEPS);           // 12.73 кроку на мм
+    TEST_ASSERT_TRUE(fabs(scale.stepsPerMm() / 65536.0 - stepsPerMm) < 1e-3);
+    TEST_ASSERT_EQUAL_INT32(lround(fw::CONVEYOR_Z_OFFSET_UM_FIRST * stepsPerMm / 1000), scale.steps(fw::CONVEYOR_Z_OFFSET_UM_FIRST));
+    TEST_ASSERT_EQUAL_INT32(lround(fw::CONVEYOR_Z_OFFSET_UM_SECOND * stepsPerMm / 1000), scale.steps(fw::CONVEYOR_Z_OFFSET_UM_SECOND));
+    TEST_ASSERT_EQUAL_INT32(127, scale.steps(10000));               // 127.32 кроку
+    TEST_ASSERT_EQUAL_INT32(25, scale.steps(2000));                 // 25.46 кроку
+    TEST_ASSERT_EQUAL_INT32(79, scale.um(1));                       // 78.54 мкм
+    TEST_ASSERT_EQUAL_INT32(-79, scale.um(-1));
+}
+
+// --- DdaRamp ---
+
+struct RampRun {
+    uint32_t ticks = 0;
+    uint32_t steps = 0;
+    int32_t maxPosition = 0;
+    bool adjacentSteps = false;     // два кроки на сусідніх тіках — імпульс STEP без паузи
+    uint32_t lastStepSpeed = 0;     // швидкість перед останнім кроком, кроків/с
+};
+
+// Тікати до зупинки (не довше за limit тіків)
+static RampRun runRamp(kin::DdaRamp& ramp, uint32_t limit) {
+    RampRun r;
+    r.maxPosition = ramp.position();
+    uint32_t lastStepTick = 0xFFFFFFFFUL;
+    while (ramp.isMoving() && r.ticks < limit) {
+        uint32_t speed = ramp.speed();
+        r.ticks++;
+        if (!ramp.tick()) continue;
+        r.steps++;
+        if (lastStepTick != 0xFFFFFFFFUL && r.ticks - lastStepTick < 2) r.adjacentSteps = true;
+        lastStepTick = r.ticks;
+        r.lastStepSpeed = speed;
+        if (ramp.position() > r.maxPosition) r.maxPosition = ramp.position();
+    }
+    return r;
+}
+
+static const uint32_t TICK_HZ = fw::STEPPER_TICK_HZ;       // Timer1 прошивки
+
+void test_ramp_stops_exactly_on_target() {
+    const int32_t targets[] = {1, 2, 3, 10, 100, 1000, 5000, 40000};
+    for (int32_t target : targets) {
+        kin::DdaRamp ramp(TICK_HZ);
+        ramp.setMaxSpeed(TICK_HZ / 3);
+        ramp.setAcceleration(20000);
+        ramp.moveTo(target);
+        RampRun r = runRamp(ramp, 20 * TICK_HZ);
+        TEST_ASSERT_FALSE(ramp.isMoving());
+        TEST_ASSERT_EQUAL_INT32(target, ramp.position());
+        TEST_ASSERT_EQUAL_INT32(target, r.maxPosition);
+        TEST_ASSERT_EQUAL_UINT32(0, ramp.speed());
+        TEST_ASSERT_FALSE(r.adjacentSteps);
+    }
+}
+
+// Гальмування плавне: останній крок — на швидкості, з якої можна стати за три кроки
+void test_ramp_brakes_down_before_target() {
+    kin::DdaRamp ramp(TICK_HZ);
+    ramp.setMaxSpeed(5000);
+    ramp.setAcceleration(20000);
+    ramp.moveTo(20000);
+    RampRun r = runRamp(ramp, 20 * TICK_HZ);
+    TEST_ASSERT_EQUAL_INT32(20000, ramp.position());
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32((uint32_t)sqrt(2.0 * 20000 * 3), r.lastStepSpeed);
+}
+
+// Нова ціль ближча за гальмівний шлях: гальмування різкіше, але ціль не проїжджається
+void test_ramp_short_retarget_does_not_overshoot() {
+    const int32_t extras[] = {1, 5, 20, 100};
+    for (int32_t extra : extras) {
+        kin::DdaRamp ramp(TICK_HZ);
+        ramp.setMaxSpeed(6000);
+        ramp.setAcceleration(10000);
+        ramp.moveTo(100000);
+        for (uint32_t i = 0; i < TICK_HZ; i++) ramp.tick();     // за секунду — на крейсерській
+        int32_t target = ramp.position() + extra;
+        ramp.moveTo(target);
+        RampRun r = runRamp(ramp, 20 * TICK_HZ);
+        TEST_ASSERT_EQUAL_INT32(target, ramp.position());
+        TEST_ASSERT_EQUAL_INT32(target, r.maxPosition);
+        TEST_ASSERT_FALSE(ramp.isMoving());
+    }
+}
+
+// Продовження руху з ходу (як CONTINUOUS_MOVE_STEPS малого конвеєра) не скидає швидкість
+void test_ramp_extended_target_keeps_speed() {
+    kin::DdaRamp ramp(TICK_HZ);
+    ramp.setMaxSpeed(4000);
+    ramp.setAcceleration(20000);
+    ramp.moveTo(2000);
+    while (ramp.position() < 1000) ramp.tick();
+    uint32_t before = ramp.speed();
+    ramp.moveTo(10000);
+    ramp.tick();
+    TEST_ASSERT_UINT32_WITHIN(2, before, ramp.speed());
+    runRamp(ramp, 20 * TICK_HZ);
+    TEST_ASSERT_EQUAL_INT32(10000, ramp.position());
+}
+
+void test_ramp_target_behind_stops_at_once() {
+    kin::DdaRamp ramp(TICK_HZ);
+    ramp.setMaxSpeed(4000);
+    ramp.setAcceleration(20000);
+    ramp.moveTo(1000);
+    for (int i = 0; i < 2000; i++) ramp.tick();
+    int32_t position = ramp.position();
+    ramp.moveTo(position - 10);
+    TEST_ASSERT_FALSE(ramp.isMoving());
+    TEST_ASSERT_FALSE(ramp.tick());
+    TEST_ASSERT_EQUAL_INT32(position, ramp.position());
+    TEST_ASSERT_EQUAL_UINT32(0, ramp.speed());
+}
+
+// Швидкість не перевищує заданої і півкроку на тік
+void test_ramp_speed_limits() {
+    kin::DdaRamp ramp(TICK_HZ);
+    ramp.setMaxSpeed(3000);
+    ramp.setAcceleration(50000);
+    ramp.moveTo(100000);
+    uint32_t top = 0;
+    for (int i = 0; i < 20000; i++) {
+        ramp.tick();
+        if (ramp.speed() > top) top = ramp.speed();
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 3000, top);
+
+    ramp.stop();
+    ramp.setMaxSpeed(TICK_HZ);
+    ramp.moveTo(ramp.position() + 100000);
+    RampRun r = runRamp(ramp, 50000);
+    TEST_ASSERT_FALSE(r.adjacentSteps);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_to_q16_rounds_to_nearest);
+    RUN_TEST(test_mm_to_um_rounds_to_nearest);
+    RUN_TEST(test_compile_time_steps_and_ticks);
+    RUN_TEST(test_to_float_for_reports);
+    RUN_TEST(test_isqrt_rounds_down);
+    RUN_TEST(test_step_scale_steps_match_exact);
+    RUN_TEST(test_step_scale_round_trip_from_steps);
+    RUN_TEST(test_step_scale_round_trip_from_um);
+    RUN_TEST(test_step_scale_known_values);
+    RUN_TEST(test_ramp_stops_exactly_on_target);
+    RUN_TEST(test_ramp_brakes_down_before_target);
+    RUN_TEST(test_ramp_short_retarget_does_not_overshoot);
+    RUN_TEST(test_ramp_extended_target_keeps_speed);
+    RUN_TEST(test_ramp_target_behind_stops_at_once);
+    RUN_TEST(test_ramp_speed_limits);
+    return UNITY_END();
+}
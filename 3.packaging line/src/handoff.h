@@ -0,0 +1,104 @@
+#pragma once
+#include <Arduino.h>
+#if !defined(__AVR__)
+#include <ArduinoNative.h>
+#endif
+
+// Сигнали від сусідніх контролерів: START_STOP (A2) від конвеєра і SIGNAL (A0) від малого
+// конвеєра — у перериванні PCINT1.
+//
+// Обидва входи сидять на порту C (A0 — PCINT8, A2 — PCINT10). На кожен підйом рівня
+// переривання запам'ятовує час (мкс) і ставить прапорець фронту; loop() забирає фронт
+// через take() і реагує одразу, навіть якщо сама ітерація затрималась (друк відповіді
+// на команду Serial). Фронт забирається один раз: SIGNAL малий конвеєр тримає HIGH
+// кілька секунд, і рівень міг би запустити пакування повторно, а фронт — ні.
+//
+// Якщо на момент take() вхід уже знову LOW, фронт вважається завадою на дроті й
+// відкидається. Якщо вхід HIGH уже при begin() (плату ввімкнули, коли сигнал тримається),
+// це теж фронт — його момент дорівнює моменту begin().
+//
+// У збірці для ПК замість PCINT — слухач змін входів віртуальної плати.
+
+namespace handoff {
+
+const uint8_t CHANNELS = 2;
+
+static uint8_t pins[CHANNELS] = {0, 0};
+static volatile bool high[CHANNELS] = {false, false};
+static volatile bool pending[CHANNELS] = {false, false};
+static volatile unsigned long edgeMicros[CHANNELS] = {0, 0};
+
+} // namespace handoff
+
+class HandoffInputs {
+public:
+    enum Channel : uint8_t {
+        READY = 0,      // SIGNAL_PIN: 4 спайки на платформі
+        START = 1       // START_STOP_PIN: лінія працює
+    };
+
+    static void begin(uint8_t readyPin, uint8_t startPin) {
+        handoff::pins[READY] = readyPin;
+        handoff::pins[START] = startPin;
+        noInterrupts();
+        for (uint8_t ch = 0; ch < handoff::CHANNELS; ch++) {
+            handoff::high[ch] = false;
+            handoff::pending[ch] = false;
+        }
+        onPinChange();
+        enableInterrupts();
+        interrupts();
+    }
+
+    // Забрати фронт каналу: true — вхід піднімався після попереднього take() і досі HIGH.
+    // edgeUs — micros() у момент фронту
+    static bool take(uint8_t ch, unsigned long& edgeUs) {
+        noInterrupts();
+        bool edge = handoff::pending[ch];
+        handoff::pending[ch] = false;
+        edgeUs = handoff::edgeMicros[ch];
+        interrupts();
+        return edge && digitalRead(handoff::pins[ch]) == HIGH;
+    }
+
+    // Обробник переривання (PCINT1 або слухач входів на ПК)
+    static void onPinChange() {
+        for (uint8_t ch = 0; ch < handoff::CHANNELS; ch++) {
+            bool now = digitalRead(handoff::pins[ch]) == HIGH;
+            if (now && !handoff::high[ch]) {
+                handoff::edgeMicros[ch] = micros();
+                handoff::pending[ch] = true;
+            }
+            handoff::high[ch] = now;
+        }
+    }
+
+private:
+#if defined(__AVR__)
+    static void enableInterrupts() {
+        for (uint8_t ch = 0; ch < handoff::CHANNELS; ch++) {
+            // Обробник один — PCINT1_vect, тож обидва входи мають бути на A0-A5
+            if (digitalPinToPCICRbit(handoff::pins[ch]) != PCIE1) continue;
+            *digitalPinToPCMSK(handoff::pins[ch]) |= _BV(digitalPinToPCMSKbit(handoff::pins[ch]));
+        }
+        PCIFR = _BV(PCIF1);
+        PCICR |= _BV(PCIE1);
+    }
+#else
+    static void enableInterrupts() {
+        static bool attached = false;
+        if (attached) return;
+        attached = true;
+        native::Board* board = &native::board();
+        board->onInputChange([board](uint8_t pin, bool) {
+            if (pin != handoff::pins[READY] && pin != handoff::pins[START]) return;
+            native::BoardScope scope(*board);
+            onPinChange();
+        });
+    }
+#endif
+};
+
+#if defined(__AVR__)
+ISR(PCINT1_vect) { HandoffInputs::onPinChange(); }
+#endif
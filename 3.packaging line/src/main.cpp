@@ -1,4 +1,8 @@
 #include <Arduino.h>
+#include "sequence.h"
+#include "handoff.h"
+#include <StallWatchdog.h>
+#include <LineBus.h>
 /*
  * Оновлена логіка управління вакуумним краном:
  * - Пін 10: Керування пневморозподілювачем (2 положення)
@@ -33,6 +37,31 @@ const int DELAY_PARALLEL_CYLINDERS = 50; // Затримка між актива
 
 const int DELAY_BETWEEN_CYCLES = 2000;  // 2 секунди паузи між циклами
 
+// Сторож зависань loop() (StallWatchdog): довша ітерація — скидання плати і звіт після старту.
+// Найдовша законна ітерація — відповідь на команду Serial (рядок команди не чекається)
+const uint16_t WATCHDOG_STALL_MS = 1500;
+const uint16_t WATCHDOG_EEPROM_ADDRESS = 0;   // звіт останнього зависання
+
+// Шина лінії (common/LineBus): пакування — ведений 2, Mega передає в опитуванні стан
+// малого конвеєра. Шина займає Serial (єдиний UART Uno): команди Serial тоді не працюють,
+// повідомлення йдуть у USB, поки трансивер не передає.
+#ifndef LINE_BUS_ENABLED
+#define LINE_BUS_ENABLED 0
+#endif
+const uint8_t LINE_BUS_ADDRESS = 2;
+const unsigned long LINE_BUS_BAUD = 115200;
+const uint8_t LINE_BUS_DE_PIN = A1;           // DE/RE трансивера RS-485
+#if LINE_BUS_ENABLED
+LineBus lineBus(Serial, LINE_BUS_ADDRESS, LINE_BUS_DE_PIN);
+#endif
+
+// Конвеєрний режим: підготовка наступного пакету (забір, переміщення, відкривання)
+// починається ще під час хвоста поточного циклу — охолодження ленти, повернення сопла
+// і штовхача, скидання пакету. Паузи між циклами в цьому режимі немає.
+// Конфліктні рухи розводять блокування циліндрів (stepAllowed).
+// Увімкнути після перевірки на лінії.
+bool PIPELINED_CYCLES = false;
+
 enum VacuumValvePosition {
     VALVE_POS_1 = 1, // Подача вакууму на присоски для захвату пакету
     VALVE_POS_2 = 2  // Переключення на вакуумування пакету
@@ -53,6 +82,35 @@ enum VacuumValvePosition {
 
 #define SIGNAL_PIN A0        // Пін сигналу готовності 4 спайок
 #define START_STOP_PIN A2  // сигнал для старту/стопу  контролера
+// Фронти обох сигналів ловить переривання PCINT1 (handoff.h)
+
+// Кінцеві датчики ходу циліндрів (геркони), необов'язкові.
+// Геркон замикає вхід на GND (INPUT_PULLUP, активний LOW); NO_PIN — датчика немає.
+// Без датчика хід вважається завершеним через час кроку, як і раніше. З датчиком крок
+// переходить далі, щойно хід підтверджено, а timeoutMs — лише межа: хід, не підтверджений
+// за цей час, рахується як збій, і послідовність іде далі за часом.
+// Вільні входи Uno: A1, A3, A4, A5, 13.
+#define NO_PIN 255
+
+struct CylinderReeds {
+  uint8_t cylinder;
+  const char* name;
+  uint8_t extendedPin;    // датчик висунутого положення
+  uint8_t retractedPin;   // датчик засунутого положення
+  uint16_t timeoutMs;     // найдовший допустимий повний хід
+};
+
+const CylinderReeds CYLINDER_REEDS[] = {
+  {DIST_7,  "DIST_7",  NO_PIN, NO_PIN, DELAY_DIST_7_MOVE},
+  {DIST_8,  "DIST_8",  NO_PIN, NO_PIN, DELAY_DIST_8_UP_DOWN},
+  {DIST_9,  "DIST_9",  NO_PIN, NO_PIN, DELAY_DIST_9_MOVE},
+  {DIST_10, "DIST_10", NO_PIN, NO_PIN, DELAY_DIST_10_MOVE},
+  {DIST_11, "DIST_11", NO_PIN, NO_PIN, DELAY_DIST_11_MOVE},
+  {DIST_12, "DIST_12", NO_PIN, NO_PIN, DELAY_DIST_12_MOVE},
+  {DIST_13, "DIST_13", NO_PIN, NO_PIN, DELAY_DIST_13_MOVE},
+  {DIST_14, "DIST_14", NO_PIN, NO_PIN, DELAY_DIST_14_MOVE},
+};
+const uint8_t CYLINDER_COUNT = sizeof(CYLINDER_REEDS) / sizeof(CYLINDER_REEDS[0]);
 
 void setup() {
   // Налаштування пінів як виходи
@@ -69,6 +127,14 @@ void setup() {
   pinMode(PIN_IN_RELE, OUTPUT);
   pinMode(SIGNAL_PIN, INPUT);
   pinMode(START_STOP_PIN, INPUT);
+  for (uint8_t i = 0; i < CYLINDER_COUNT; i++) {
+    if (CYLINDER_REEDS[i].extendedPin != NO_PIN) pinMode(CYLINDER_REEDS[i].extendedPin, INPUT_PULLUP);
+    if (CYLINDER_REEDS[i].retractedPin != NO_PIN) pinMode(CYLINDER_REEDS[i].retractedPin, INPUT_PULLUP);
+  }
+  Serial.begin(LINE_BUS_BAUD);
+#if LINE_BUS_ENABLED
+  lineBus.begin();
+#endif
 
   // Всі розподілювачі вимкнені (інвертовано для циліндрів)
   digitalWrite(DIST_7, HIGH);  // Інвертовано: циліндри в початковому положенні (засунуті)
@@ -82,6 +148,9 @@ void setup() {
   digitalWrite(VACUUM_VALVE_PIN, HIGH);  // Вакуум і клапан скидання залишаються без змін
   digitalWrite(PRESSURE_RELEASE_VALVE_PIN, HIGH);
   digitalWrite(PIN_IN_RELE, LOW);
+  HandoffInputs::begin(SIGNAL_PIN, START_STOP_PIN);
+
+  if (StallWatchdog::begin(WATCHDOG_STALL_MS, WATCHDOG_EEPROM_ADDRESS)) StallWatchdog::printReport(Serial);
 }
 
 inline void setVacuumValve(uint8_t position) {
@@ -104,32 +173,57 @@ inline void setVacuumValve(uint8_t position) {
 inline void setPressureReleaseValve(bool state) {
     digitalWrite(PRESSURE_RELEASE_VALVE_PIN, state ? HIGH : LOW);
 }
-void cylinderActivate(int pin, int duration,bool flagState) {
-  if(flagState){
-      digitalWrite(pin, LOW);  // Інвертовано: true = LOW (висування)
-  }else{
-      digitalWrite(pin, HIGH); // Інвертовано: false = HIGH (засування)
-  }
-  
-  delay(duration); // затримка в мілісекундах
-}
 
-// Функція для паралельної активації двох циліндрів
-void cylindersActivateParallel(int pin1, int pin2, int duration1, int duration2, bool flagState1, bool flagState2, int delay_between = 0) {
-  // Активація першого циліндра (інвертовано)
-  digitalWrite(pin1, flagState1 ? LOW : HIGH);
-  
-  // Затримка між активаціями (якщо потрібна)
-  if (delay_between > 0) {
-    delay(delay_between);
-  }
-  
-  // Активація другого циліндра (інвертовано)
-  digitalWrite(pin2, flagState2 ? LOW : HIGH);
-  
-  // Очікування завершення роботи обох циліндрів (беремо максимальний час)
-  delay(max(duration1, duration2));
-}
+// Коди дій кроків послідовності (виконує performStep)
+enum PackAction : uint8_t {
+    ACT_WAIT,            // лише очікування
+    ACT_EXTEND,          // циліндр висувається (інвертовано: LOW)
+    ACT_RETRACT,         // циліндр засувається (інвертовано: HIGH)
+    ACT_VACUUM_GRIP,     // клапан вакууму: позиція 1 (присоски)
+    ACT_VACUUM_BAG,      // клапан вакууму: позиція 2 (вакуумування пакету)
+    ACT_HEAT_ON,         // розжарювання ленти
+    ACT_HEAT_OFF,        // вимкнення нагріву
+    ACT_RELEASE_ON,      // клапан скидання тиску відкрито
+    ACT_RELEASE_OFF      // клапан скидання тиску закрито
+};
+
+// Режими, у яких виконується крок (поле modes)
+#define MODE_SEQ   0x01  // послідовний цикл
+#define MODE_PIPE  0x02  // конвеєрний цикл
+#define MODE_ALL   (MODE_SEQ | MODE_PIPE)
+
+// Стан циліндрів для блокувань: куди скомандовано і коли закінчиться хід
+const uint8_t CYLINDER_FIRST = DIST_7;
+const uint8_t CYLINDER_LAST = DIST_14;
+bool cylinderExtended[CYLINDER_LAST + 1];
+unsigned long cylinderMoveStart[CYLINDER_LAST + 1];
+uint16_t cylinderMoveMs[CYLINDER_LAST + 1];
+
+// Хід до кінцевого датчика
+enum StrokeState : uint8_t {
+  STROKE_TIMED,       // датчика немає — хід завершується за часом кроку
+  STROKE_LEAVING,     // датчик ще активний з початку ходу — чекаємо, поки відпуститься
+  STROKE_MOVING,      // чекаємо на датчик
+  STROKE_CONFIRMED,   // датчик підтвердив кінець ходу
+  STROKE_TIMEOUT      // датчик не спрацював за timeoutMs
+};
+StrokeState strokeState[CYLINDER_LAST + 1];
+
+// Фактичні часи ходу для кожного циліндра і напрямку (0 — засування, 1 — висування)
+struct StrokeStats {
+  uint16_t count;
+  uint16_t timeouts;
+  uint16_t lastMs;
+  uint16_t minMs;
+  uint16_t maxMs;
+  uint32_t sumMs;
+};
+StrokeStats strokeStats[CYLINDER_COUNT][2];
+
+// Зона завантаження: порожня → пакет відкрито (наповнюється) → пакет запаяно → скинуто
+enum LoadingZone : uint8_t { ZONE_EMPTY, ZONE_OPEN, ZONE_SEALED };
+LoadingZone loadingZone = ZONE_EMPTY;
+bool bagVacuumActive = false;   // клапан вакууму віддано пакету: від вакуумування до запайки
 
 void vacuumPackage() {
   // Переключення на вакуумування пакету
@@ -146,112 +240,422 @@ void heatingOff() {
   digitalWrite(PIN_IN_RELE, LOW);
 }
 
-void coolingOn() {
-  // Включення охолодження ленти
-  cylinderActivate(DIST_14, DELAY_DIST_14_MOVE, true);
-  delay(DELAY_COOLING); // час охолодження в мілісекундах
-  cylinderActivate(DIST_14, DELAY_DIST_14_MOVE, false);
+bool isCylinderPin(uint8_t pin) {
+  return pin >= CYLINDER_FIRST && pin <= CYLINDER_LAST;
 }
 
-// Функція підготовки пакету (сигнал СТАРТ)
-void preparePackage() {
-  // Початкове положення: платформа з присосками над складом з пакетами
-  
-  // 2.1. Опускання платформи з присосками
-  cylinderActivate(DIST_8, DELAY_DIST_8_UP_DOWN, true);
-  
-  // 2.2. Подання вакууму на присоски
-  setVacuumValve(VALVE_POS_1);
-  
-  // 2.3. Піднімання платформи разом із пакетом
-  cylinderActivate(DIST_8, DELAY_DIST_8_UP_DOWN, false);
-  
-  // 3.1. Пересування платформи з пакетом у зону завантаження
-  cylinderActivate(DIST_7, DELAY_DIST_7_MOVE, true);
-  
-  // 3.2. Опускання платформи з пакетом, пакет ще закритий
-  cylinderActivate(DIST_8, DELAY_DIST_8_OUT_PACET, true);
-  
-  // 3.3. Відкривання пакету: піднімання платформи з присосками, пакет відкрито
-  cylinderActivate(DIST_8, DELAY_DIST_8_OUT_PACET, false);
-  
-  // Результат: відкритий порожній пакет готовий для завантаження
+const CylinderReeds& reedsOf(uint8_t pin) {
+  uint8_t i = 0;
+  while (i < CYLINDER_COUNT - 1 && CYLINDER_REEDS[i].cylinder != pin) i++;
+  return CYLINDER_REEDS[i];
 }
 
-// Функція пакування (сигнал ГОТОВНІСТЬ)
-void packageSpikes() {
-  // 1.1. Засування спайок з платформи в пакет (циліндр вперед, утримання положення)
-  cylinderActivate(DIST_9, DELAY_DIST_9_MOVE, true);
-  
-  // 1.2. Фіксація пакету: циліндр утримання висунутий
-  cylinderActivate(DIST_10, DELAY_DIST_10_MOVE, true);
-  
-  // 2.1. Сопло відходить назад до початку пакету
-  cylinderActivate(DIST_11, DELAY_DIST_11_MOVE, true);
-  
-  // 2.2. Клапан у режим вакуумування пакету, початок відкачки повітря
-  //vacuumPackage();
-  setVacuumValve(VALVE_POS_2);
-  // 2.3. Водночас присоски відпускають пакет
-  //setVacuumValve(VALVE_POS_1);
- // тут затримка 500 мс//////////////////////////////////////////////////////
-  delay(DELAY_VACUM_SOPLO);
-  // 3.1. Опускання силіконової планки
-  cylinderActivate(DIST_12, DELAY_DIST_12_MOVE, true);
-  
-  // 3.2. Розжарювання ленти (активація нагріву)
-  heatingOn();
-  delay(DELAY_HEATING); // час нагріву в мілісекундах
-  heatingOff();
-  delay(DELAY_HEATING_POSLE); // час нагріву в мілісекундах після виключення нагріву
-  // 3.3. Вимкнення вакууму, клапан у положення "атмосфера"
-  //setVacuumValve(VALVE_POS_1);
-  
-  // 3.4. Піднімання планки
-  cylinderActivate(DIST_12, DELAY_DIST_12_MOVE, false);
-  
-  // 3.5. Активація клапана скидання тиску після піднімання силіконової планки
-  setPressureReleaseValve(true);
-
-  // 3.6. Увімкнення охолодження ленти на заданий час
-  coolingOn();
-  
-  // 4.2-4.3. Паралельна робота: сопло рухається вперед + циліндр засовування спайок повертається
-  // Невелика затримка між активаціями для безпеки
-  cylindersActivateParallel(DIST_11, DIST_9, DELAY_DIST_11_MOVE, DELAY_DIST_9_MOVE, false, false, DELAY_PARALLEL_CYLINDERS);
-  
-
-  // 4.4. Платформа з присосками повертається над склад з пакетами
-  cylinderActivate(DIST_7, DELAY_DIST_7_MOVE, false);
-     // 4.1. Піднімання циліндра утримання пакету
-  cylinderActivate(DIST_10, DELAY_DIST_10_MOVE, false);
-
-  // 4.5. Скидання готового пакету з платформи
-  cylinderActivate(DIST_13, DELAY_DIST_13_MOVE, true);  // Висування циліндра скидання
-  cylinderActivate(DIST_13, DELAY_DIST_13_MOVE, false); // Засування циліндра скидання
-  setVacuumValve(VALVE_POS_1);// Відновлення подачі вакууму на присоски для захвату пакету
-  setPressureReleaseValve(false);// Вимкнення клапана скидання тиску
-  // Результат: спайки упаковані, пакет запаяний, готовий виріб скинуто
+uint8_t reedPin(uint8_t pin, bool extended) {
+  return extended ? reedsOf(pin).extendedPin : reedsOf(pin).retractedPin;
 }
 
-void loop() {
-  // Перевіряємо сигнал START_STOP_PIN
-  if (digitalRead(START_STOP_PIN) == HIGH) {
-    // Запускаємо підготовку пакету
-    preparePackage();
-    
-    // Чекаємо поки обидва сигнали будуть активні
-    while (true) {
-      if (digitalRead(START_STOP_PIN) == HIGH && digitalRead(SIGNAL_PIN) == HIGH) {
-        // Якщо обидва сигнали активні - запускаємо пакування
-        packageSpikes();
-        
-        // Пауза перед наступним циклом
-        delay(DELAY_BETWEEN_CYCLES);
-        break;  // Виходимо з внутрішнього циклу
+bool reedActive(uint8_t reed) {
+  return digitalRead(reed) == LOW;
+}
+
+// Почати хід циліндра (до оновлення cylinderExtended)
+void startStroke(uint8_t pin, bool extend) {
+  uint8_t reed = reedPin(pin, extend);
+  if (reed == NO_PIN) {
+    strokeState[pin] = STROKE_TIMED;
+  } else if (!reedActive(reed)) {
+    strokeState[pin] = STROKE_MOVING;
+  } else if (cylinderExtended[pin] == extend) {
+    strokeState[pin] = STROKE_CONFIRMED;  // вже в цьому положенні — ходу немає
+  } else {
+    strokeState[pin] = STROKE_LEAVING;    // датчик мав би бути відпущений: чекаємо, поки відпуститься
+  }
+}
+
+void recordStroke(uint8_t pin, uint16_t ms) {
+  StrokeStats& s = strokeStats[pin - CYLINDER_FIRST][cylinderExtended[pin]];
+  if (!s.count || ms < s.minMs) s.minMs = ms;
+  if (ms > s.maxMs) s.maxMs = ms;
+  s.lastMs = ms;
+  s.sumMs += ms;
+  s.count++;
+}
+
+// Опитування кінцевих датчиків циліндрів, що рухаються (з кожної ітерації loop())
+void serviceStrokes() {
+  for (uint8_t pin = CYLINDER_FIRST; pin <= CYLINDER_LAST; pin++) {
+    StrokeState state = strokeState[pin];
+    if (state != STROKE_LEAVING && state != STROKE_MOVING) continue;
+    unsigned long elapsed = millis() - cylinderMoveStart[pin];
+    bool active = reedActive(reedPin(pin, cylinderExtended[pin]));
+    if (state == STROKE_LEAVING && !active) {
+      strokeState[pin] = STROKE_MOVING;
+    } else if (state == STROKE_MOVING && active) {
+      strokeState[pin] = STROKE_CONFIRMED;
+      recordStroke(pin, elapsed);
+    } else if (elapsed >= reedsOf(pin).timeoutMs) {
+      strokeState[pin] = STROKE_TIMEOUT;
+      strokeStats[pin - CYLINDER_FIRST][cylinderExtended[pin]].timeouts++;
+      Serial.print(F("Stroke timeout: "));
+      Serial.print(reedsOf(pin).name);
+      Serial.print(cylinderExtended[pin] ? F(" extend, ") : F(" retract, "));
+      Serial.print(elapsed);
+      Serial.println(F(" ms"));
+    }
+  }
+}
+
+// Циліндр у заданому положенні і завершив хід
+bool cylinderAt(uint8_t pin, bool extended) {
+  if (cylinderExtended[pin] != extended) return false;
+  switch (strokeState[pin]) {
+    case STROKE_TIMED:     return millis() - cylinderMoveStart[pin] >= cylinderMoveMs[pin];
+    case STROKE_CONFIRMED:
+    case STROKE_TIMEOUT:   return true;  // після таймауту — далі за часом, як без датчика
+    default:               return false;
+  }
+}
+
+void performStep(const SequenceStep& step) {
+  switch (step.action) {
+    case ACT_EXTEND:
+    case ACT_RETRACT: {
+      bool extend = step.action == ACT_EXTEND;
+      digitalWrite(step.pin, extend ? LOW : HIGH);  // Інвертовано: true = LOW (висування)
+      if (isCylinderPin(step.pin)) {
+        startStroke(step.pin, extend);
+        cylinderExtended[step.pin] = extend;
+        cylinderMoveStart[step.pin] = millis();
+        cylinderMoveMs[step.pin] = step.waitMs;
       }
-      delay(100);  // Невелика затримка щоб не навантажувати процесор
+      if (step.pin == DIST_7 && extend) loadingZone = ZONE_OPEN;                            // пакет на місці
+      if (step.pin == DIST_12 && !extend && loadingZone == ZONE_OPEN) loadingZone = ZONE_SEALED; // запаяно
+      if (step.pin == DIST_12 && !extend) bagVacuumActive = false;
+      if (step.pin == DIST_13 && !extend) loadingZone = ZONE_EMPTY;                         // скинуто
+      break;
+    }
+    case ACT_VACUUM_GRIP: setVacuumValve(VALVE_POS_1); break;
+    case ACT_VACUUM_BAG:  vacuumPackage(); bagVacuumActive = true; break;
+    case ACT_HEAT_ON:     heatingOn(); break;
+    case ACT_HEAT_OFF:    heatingOff(); break;
+    case ACT_RELEASE_ON:  setPressureReleaseValve(true); break;
+    case ACT_RELEASE_OFF: setPressureReleaseValve(false); break;
+    default: break;
+  }
+}
+
+// Блокування: чи можна виконати крок, не зачепивши інші механізми.
+// У послідовному режимі умови виконуються самі собою (порядок кроків і ті самі
+// часи ходу), у конвеєрному — саме вони розводять підготовку і пакування.
+bool stepAllowed(const SequenceStep& step) {
+  switch (step.action) {
+    case ACT_EXTEND:
+      switch (step.pin) {
+        case DIST_8:   // опускання присосок — лише над складом або над відкритим пакетом, не в русі
+          return cylinderAt(DIST_7, cylinderExtended[DIST_7]);
+        case DIST_7:   // пакет у зону завантаження — зона вільна, механізми пакування відведені
+          return loadingZone == ZONE_EMPTY && cylinderAt(DIST_8, false) && cylinderAt(DIST_9, false) &&
+                 cylinderAt(DIST_10, false) && cylinderAt(DIST_11, false) && cylinderAt(DIST_13, false);
+        case DIST_9:   // засування спайок — відкритий пакет на місці
+          return loadingZone == ZONE_OPEN && cylinderAt(DIST_7, true) && cylinderAt(DIST_8, false);
+        default:
+          return true;
+      }
+    case ACT_RETRACT:
+      if (step.pin == DIST_7) {
+        // платформа з присосками йде над склад — відкритого пакету в зоні немає, присоски підняті
+        return loadingZone != ZONE_OPEN && cylinderAt(DIST_12, false) && cylinderAt(DIST_8, false);
+      }
+      return true;
+    case ACT_VACUUM_GRIP:
+      // клапан вакууму спільний: поки пакет вакуумується, присоски його не отримують
+      return !bagVacuumActive;
+    default:
+      return true;
+  }
+}
+
+// Дія кроку завершилась раніше за його час: циліндр кроку підтвердив датчиком кінець ходу,
+// а жоден інший не рухається (паралельні ходи 4.2-4.3 чекають один одного).
+// Інший циліндр без датчика вважається в русі до кінця часу свого кроку.
+bool stepConfirmed(const SequenceStep& step) {
+  if ((step.action != ACT_EXTEND && step.action != ACT_RETRACT) || !isCylinderPin(step.pin)) return false;
+  if (strokeState[step.pin] != STROKE_CONFIRMED) return false;
+  for (uint8_t pin = CYLINDER_FIRST; pin <= CYLINDER_LAST; pin++) {
+    if (!cylinderAt(pin, cylinderExtended[pin])) return false;
+  }
+  return true;
+}
+
+// Фактичні часи ходу (команда strokes)
+void printStrokes() {
+  Serial.println(F("Strokes (ms): cylinder direction count last min/avg/max timeouts"));
+  for (uint8_t i = 0; i < CYLINDER_COUNT; i++) {
+    for (uint8_t extended = 0; extended < 2; extended++) {
+      uint8_t reed = extended ? CYLINDER_REEDS[i].extendedPin : CYLINDER_REEDS[i].retractedPin;
+      if (reed == NO_PIN) continue;
+      const StrokeStats& s = strokeStats[i][extended];
+      Serial.print(F("  "));
+      Serial.print(CYLINDER_REEDS[i].name);
+      Serial.print(extended ? F(" extend ") : F(" retract "));
+      Serial.print(s.count);
+      Serial.print(' ');
+      Serial.print(s.lastMs);
+      Serial.print(' ');
+      Serial.print(s.minMs);
+      Serial.print('/');
+      Serial.print(s.count ? s.sumMs / s.count : 0);
+      Serial.print('/');
+      Serial.print(s.maxMs);
+      Serial.print(F(" (limit "));
+      Serial.print(CYLINDER_REEDS[i].timeoutMs);
+      Serial.print(F(") "));
+      Serial.println(s.timeouts);
     }
   }
-  delay(100);  // Затримка в головному циклі
-}
\ No newline at end of file
+}
+
+// Реакція на сигнали сусідів: від фронту (момент з переривання) до дії послідовностей.
+// Для SIGNAL — від фронту або від відкриття пакету, якщо пакет ще готувався
+struct HandoffStats {
+  uint16_t count;
+  uint16_t waited;          // SIGNAL прийшов раніше, ніж відкрився пакет
+  unsigned long lastUs;
+  unsigned long maxUs;
+};
+
+HandoffStats handoffStats[2];
+
+void recordHandoff(uint8_t channel, unsigned long fromUs, bool waited) {
+  HandoffStats& s = handoffStats[channel];
+  unsigned long us = micros() - fromUs;
+  s.count++;
+  if (waited) s.waited++;
+  s.lastUs = us;
+  if (us > s.maxUs) s.maxUs = us;
+}
+
+void printHandoff() {
+  static const char* const NAMES[] = {"SIGNAL -> pack", "START -> run"};
+  Serial.println(F("Handoff: edge -> sequencer, count last/max us"));
+  for (uint8_t i = 0; i < 2; i++) {
+    const HandoffStats& s = handoffStats[i];
+    Serial.print(NAMES[i]);
+    Serial.print(' ');
+    Serial.print(s.count);
+    Serial.print(' ');
+    Serial.print(s.lastUs);
+    Serial.print('/');
+    Serial.print(s.maxUs);
+    if (i == HandoffInputs::READY) {
+      Serial.print(F(", waited for bag "));
+      Serial.print(s.waited);
+    }
+    Serial.println();
+  }
+}
+
+// Рядок команди набирається з того, що вже прийшло, без очікування: readStringUntil()
+// чекав би кінця рядка до 1 с усередині ітерації. true — рядок завершено '\n'
+bool readCommandLine(String& line) {
+  static char buffer[24];
+  static uint8_t length = 0;
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\n') {
+      buffer[length] = '\0';
+      line = buffer;
+      length = 0;
+      return true;
+    }
+    if (length < sizeof(buffer) - 1) buffer[length++] = c;   // довший рядок обрізається
+  }
+  return false;
+}
+
+void checkSerialCommands() {
+  String command;
+  if (!readCommandLine(command)) return;
+  command.trim();
+  if (command == "strokes") {
+    printStrokes();
+  } else if (command == "strokes:reset") {
+    memset(strokeStats, 0, sizeof(strokeStats));
+    Serial.println(F("Stroke statistics reset"));
+  } else if (command == "handoff") {
+    printHandoff();
+  } else if (command == "handoff:reset") {
+    memset(handoffStats, 0, sizeof(handoffStats));
+    Serial.println(F("Handoff statistics reset"));
+  } else if (command == "help") {
+    Serial.println(F("Commands:"));
+    Serial.println(F("strokes - measured cylinder stroke times (cylinders with end-of-stroke sensors)"));
+    Serial.println(F("strokes:reset - clear stroke statistics"));
+    Serial.println(F("handoff - latency from SIGNAL/START_STOP edges to the sequencer"));
+    Serial.println(F("handoff:reset - clear handoff statistics"));
+    Serial.println(F("help - show this help"));
+  }
+}
+
+// Підготовка пакету (сигнал СТАРТ)
+// Початкове положення: платформа з присосками над складом з пакетами
+const SequenceStep PREPARE_SEQUENCE[] PROGMEM = {
+  {ACT_RETRACT,     DIST_7, DELAY_DIST_7_MOVE, MODE_PIPE},    // 4.4. Платформа попереднього пакету повертається над склад
+  {ACT_EXTEND,      DIST_8, DELAY_DIST_8_UP_DOWN, MODE_ALL},  // 2.1. Опускання платформи з присосками
+  {ACT_VACUUM_GRIP, 0,      0, MODE_ALL},                     // 2.2. Подання вакууму на присоски
+  {ACT_RETRACT,     DIST_8, DELAY_DIST_8_UP_DOWN, MODE_ALL},  // 2.3. Піднімання платформи разом із пакетом
+  {ACT_EXTEND,      DIST_7, DELAY_DIST_7_MOVE, MODE_ALL},     // 3.1. Пересування платформи з пакетом у зону завантаження
+  {ACT_EXTEND,      DIST_8, DELAY_DIST_8_OUT_PACET, MODE_ALL},// 3.2. Опускання платформи з пакетом, пакет ще закритий
+  {ACT_RETRACT,     DIST_8, DELAY_DIST_8_OUT_PACET, MODE_ALL},// 3.3. Відкривання пакету: піднімання платформи, пакет відкрито
+  // Результат: відкритий порожній пакет готовий для завантаження
+};
+
+// Пакування (сигнал ГОТОВНІСТЬ)
+const SequenceStep PACK_SEQUENCE[] PROGMEM = {
+  {ACT_EXTEND,      DIST_9,  DELAY_DIST_9_MOVE, MODE_ALL},    // 1.1. Засування спайок з платформи в пакет
+  {ACT_EXTEND,      DIST_10, DELAY_DIST_10_MOVE, MODE_ALL},   // 1.2. Фіксація пакету: циліндр утримання висунутий
+  {ACT_EXTEND,      DIST_11, DELAY_DIST_11_MOVE, MODE_ALL},   // 2.1. Сопло відходить назад до початку пакету
+  {ACT_VACUUM_BAG,  0,       DELAY_VACUM_SOPLO, MODE_ALL},    // 2.2. Клапан у режим вакуумування пакету
+  {ACT_EXTEND,      DIST_12, DELAY_DIST_12_MOVE, MODE_ALL},   // 3.1. Опускання силіконової планки
+  {ACT_HEAT_ON,     0,       DELAY_HEATING, MODE_ALL},        // 3.2. Розжарювання ленти
+  {ACT_HEAT_OFF,    0,       DELAY_HEATING_POSLE, MODE_ALL},  //      передача тепла від ленти після виключення нагріву
+  {ACT_RETRACT,     DIST_12, DELAY_DIST_12_MOVE, MODE_ALL},   // 3.4. Піднімання планки
+  {ACT_RELEASE_ON,  0,       0, MODE_ALL},                    // 3.5. Скидання тиску після піднімання силіконової планки
+  {ACT_EXTEND,      DIST_14, DELAY_DIST_14_MOVE, MODE_ALL},   // 3.6. Охолодження ленти
+  {ACT_WAIT,        0,       DELAY_COOLING, MODE_ALL},
+  {ACT_RETRACT,     DIST_14, DELAY_DIST_14_MOVE, MODE_ALL},
+  // 4.2-4.3. Паралельно: сопло вперед + циліндр засовування спайок повертається
+  {ACT_RETRACT,     DIST_11, DELAY_PARALLEL_CYLINDERS, MODE_ALL},
+  {ACT_RETRACT,     DIST_9,  DELAY_DIST_9_MOVE > DELAY_DIST_11_MOVE ? DELAY_DIST_9_MOVE : DELAY_DIST_11_MOVE, MODE_ALL},
+  {ACT_RETRACT,     DIST_7,  DELAY_DIST_7_MOVE, MODE_SEQ},    // 4.4. Платформа з присосками повертається над склад
+  {ACT_RETRACT,     DIST_10, DELAY_DIST_10_MOVE, MODE_ALL},   // 4.1. Піднімання циліндра утримання пакету
+  {ACT_EXTEND,      DIST_13, DELAY_DIST_13_MOVE, MODE_ALL},   // 4.5. Скидання готового пакету з платформи
+  {ACT_RETRACT,     DIST_13, DELAY_DIST_13_MOVE, MODE_ALL},
+  {ACT_VACUUM_GRIP, 0,       0, MODE_ALL},                    // Відновлення подачі вакууму на присоски
+  {ACT_RELEASE_OFF, 0,       0, MODE_ALL},                    // Вимкнення клапана скидання тиску
+  {ACT_WAIT,        0,       DELAY_BETWEEN_CYCLES, MODE_SEQ}, // Пауза перед наступним циклом
+  // Результат: спайки упаковані, пакет запаяний, готовий виріб скинуто
+};
+
+#define SEQUENCE_LENGTH(s) ((uint8_t)(sizeof(s) / sizeof(s[0])))
+
+SequenceRunner prepareRunner(performStep, stepAllowed, stepConfirmed);
+SequenceRunner packRunner(performStep, stepAllowed, stepConfirmed);
+bool bagReady = false;        // відкритий порожній пакет чекає на спайки
+unsigned long bagReadyUs = 0; // коли пакет відкрився
+bool readyEdge = false;       // фронт SIGNAL чекає на відкритий пакет
+unsigned long readyEdgeUs = 0;
+bool heatingFrozen = false;   // нагрів вимкнено на час паузи, відновити при продовженні
+uint16_t bagsPacked = 0;      // запущених пакувань від увімкнення (для шини лінії)
+
+#if LINE_BUS_ENABLED
+// Стан для шини лінії і повідомлення про малий конвеєр: скільки спайок уже на його платформі
+void serviceLineBus() {
+  StationStatus& s = lineBus.local();
+  s.state = packRunner.isRunning() ? packRunner.stepIndex() : 0xFF;
+  s.flags = 0;
+  if (digitalRead(START_STOP_PIN) == HIGH) s.flags |= linebus::RUNNING;
+  if (bagReady) s.flags |= linebus::READY;
+  if (packRunner.isRunning()) s.flags |= linebus::BUSY;
+  s.counter = bagsPacked;
+  s.incoming = 0;                           // пакування — остання станція
+  s.etaMs = linebus::ETA_UNKNOWN;
+  lineBus.update();
+
+  static uint8_t lastBatches = 0;
+  static bool wasOnline = false;
+  bool online = lineBus.upstreamOnline();
+  if (online != wasOnline) {
+    Serial.println(online ? F("Line bus: small conveyor online") : F("Line bus: small conveyor offline"));
+    wasOnline = online;
+  }
+  const StationStatus& up = lineBus.upstream();
+  if (online && up.incoming != lastBatches) {
+    lastBatches = up.incoming;
+    Serial.print(F("Line bus: small conveyor has "));
+    Serial.print(up.incoming);
+    Serial.println(F("/4 spikes for the next bag"));
+  }
+}
+#endif
+
+uint8_t cycleMode() {
+  return PIPELINED_CYCLES ? MODE_PIPE : MODE_SEQ;
+}
+
+void freezeSequences() {
+  prepareRunner.freeze();
+  packRunner.freeze();
+  heatingFrozen = digitalRead(PIN_IN_RELE) == HIGH;
+  if (heatingFrozen) heatingOff();
+}
+
+void resumeSequences() {
+  if (heatingFrozen) heatingOn();
+  heatingFrozen = false;
+  prepareRunner.resume();
+  packRunner.resume();
+}
+
+// Окрема функція і при LTO: tools/avr_bench міряє період loop() за входом у неї
+void loop() __attribute__((noinline));
+
+void loop() {
+  // Стани для звіту сторожа — кроки обох послідовностей (255 — не виконується)
+  StallWatchdog::kick(prepareRunner.isRunning() ? prepareRunner.stepIndex() : 0xFF,
+                      packRunner.isRunning() ? packRunner.stepIndex() : 0xFF);
+
+  // Кінцеві датчики опитуються й на паузі: циліндри доходять свій хід
+  serviceStrokes();
+#if LINE_BUS_ENABLED
+  serviceLineBus();
+#else
+  checkSerialCommands();
+#endif
+
+  // Фронт SIGNAL лишається до запуску пакування, навіть якщо пакет ще готується
+  unsigned long edgeUs;
+  if (HandoffInputs::take(HandoffInputs::READY, edgeUs)) {
+    readyEdge = true;
+    readyEdgeUs = edgeUs;
+  }
+  bool startEdge = HandoffInputs::take(HandoffInputs::START, edgeUs);
+
+  bool startSignal = digitalRead(START_STOP_PIN) == HIGH;
+  bool active = prepareRunner.isRunning() || packRunner.isRunning();
+
+  // START_STOP_PIN впав посеред циклу — заморожуємо послідовності.
+  // Циліндри лишаються на місці, а нагрів вимикаємо, щоб не перепалити пакет.
+  if (!startSignal) {
+    if (active && !prepareRunner.isFrozen() && !packRunner.isFrozen()) freezeSequences();
+    return;
+  }
+  if (prepareRunner.isFrozen() || packRunner.isFrozen()) resumeSequences();
+  if (startEdge) recordHandoff(HandoffInputs::START, edgeUs, false);
+
+  bool preparing = prepareRunner.isRunning();
+  prepareRunner.update();
+  packRunner.update();
+
+  // Підготовка завершилась — пакет відкрито
+  if (preparing && !prepareRunner.isRunning()) {
+    bagReady = true;
+    bagReadyUs = micros();
+  }
+
+  // Наступний пакет: у послідовному режимі — після завершення циклу,
+  // у конвеєрному — одразу, далі його кроки стримують блокування
+  if (!bagReady && !prepareRunner.isRunning() && (PIPELINED_CYCLES || !packRunner.isRunning())) {
+    prepareRunner.start(PREPARE_SEQUENCE, SEQUENCE_LENGTH(PREPARE_SEQUENCE), cycleMode());
+  }
+
+  // Був фронт SIGNAL і пакет відкрито — запускаємо пакування
+  if (bagReady && readyEdge && !packRunner.isRunning()) {
+    bagReady = false;
+    readyEdge = false;
+    packRunner.start(PACK_SEQUENCE, SEQUENCE_LENGTH(PACK_SEQUENCE), cycleMode());
+    bagsPacked++;
+    bool waited = (long)(bagReadyUs - readyEdgeUs) > 0;
+    recordHandoff(HandoffInputs::READY, waited ? bagReadyUs : readyEdgeUs, waited);
+  }
+}
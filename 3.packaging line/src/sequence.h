@@ -0,0 +1,134 @@
+#pragma once
+#include <Arduino.h>
+
+// Послідовність кроків без delay().
+//
+// Крок — це дія на його початку (висунути/засунути циліндр, перемкнути клапан,
+// увімкнути нагрів) і час очікування до наступного кроку. SequenceRunner::update()
+// викликається з кожної ітерації loop() і виконує всі кроки, чий час настав, тож
+// між кроками loop() продовжує читати входи.
+//
+// Час кожного кроку відраховується від запланованого початку попереднього, а не від
+// моменту виклику update() — затримки loop() не накопичуються вздовж послідовності.
+// freeze()/resume() зупиняють і відновлюють відлік: час паузи додається до початку
+// поточного кроку.
+//
+// Кілька послідовностей можуть виконуватись одночасно (кожна — своїм SequenceRunner).
+// Guard перевіряє блокування перед кожним кроком: поки він забороняє дію, послідовність
+// стоїть на цьому кроці, а його час почнеться з моменту фактичного виконання.
+//
+// Confirm (необов'язковий) дозволяє перейти далі раніше: якщо він підтверджує, що дія
+// кроку вже завершилась (циліндр дійшов до кінцевого датчика), наступний крок
+// починається одразу, і його час відраховується від моменту підтвердження.
+// waitMs тоді — лише верхня межа: без підтвердження крок закінчується за часом, як раніше.
+
+struct SequenceStep {
+    uint8_t action;   // код дії, його виконує Performer
+    uint8_t pin;      // пін циліндра (для дій без піна — 0)
+    uint16_t waitMs;  // скільки чекати після дії до наступного кроку
+    uint8_t modes;    // у яких режимах виконується крок (біти, див. start())
+};
+
+class SequenceRunner {
+public:
+    typedef void (*Performer)(const SequenceStep& step);
+    typedef bool (*Guard)(const SequenceStep& step);
+    typedef bool (*Confirm)(const SequenceStep& step);
+
+    explicit SequenceRunner(Performer performer, Guard guard = nullptr, Confirm confirm = nullptr)
+        : perform(performer), allowed(guard), confirmed(confirm) {}
+
+    // Запустити послідовність з PROGMEM. Виконуються лише кроки, у яких
+    // (step.modes & modeMask) != 0. Перший крок виконується одразу, якщо дозволено.
+    void start(const SequenceStep* steps, uint8_t count, uint8_t modeMask = 0xFF) {
+        sequence = steps;
+        length = count;
+        mask = modeMask;
+        index = 0;
+        frozen = false;
+        holding = false;
+        stepStart = millis();
+        running = loadStep();
+        if (running) enterStep(stepStart);
+    }
+
+    // Обслуговування з loop()
+    void update() {
+        if (!running || frozen) return;
+        unsigned long now = millis();
+        if (holding && !enterStep(now)) return;
+        for (;;) {
+            if (now - stepStart >= current.waitMs) {
+                stepStart += current.waitMs;
+            } else if (confirmed && confirmed(current)) {
+                stepStart = now;
+            } else {
+                return;
+            }
+            index++;
+            if (!loadStep()) {
+                running = false;
+                return;
+            }
+            if (!enterStep(now)) return;
+        }
+    }
+
+    // Зупинити відлік часу (циліндри залишаються як є)
+    void freeze() {
+        if (!running || frozen) return;
+        frozen = true;
+        freezeStart = millis();
+    }
+
+    // Продовжити з того ж місця поточного кроку
+    void resume() {
+        if (!frozen) return;
+        stepStart += millis() - freezeStart;
+        frozen = false;
+    }
+
+    bool isRunning() const { return running; }
+    bool isFrozen() const { return frozen; }
+    // Послідовність чекає, поки блокування дозволить наступний крок
+    bool isHolding() const { return holding; }
+    uint8_t stepIndex() const { return index; }
+
+private:
+    // Прочитати крок index (пропускаючи кроки інших режимів); false — кінець
+    bool loadStep() {
+        for (; index < length; index++) {
+            memcpy_P(&current, &sequence[index], sizeof(current));
+            if (current.modes & mask) return true;
+        }
+        return false;
+    }
+
+    // Виконати поточний крок, якщо блокування дозволяє
+    bool enterStep(unsigned long now) {
+        if (allowed && !allowed(current)) {
+            holding = true;
+            return false;
+        }
+        if (holding) {
+            holding = false;
+            stepStart = now;
+        }
+        perform(current);
+        return true;
+    }
+
+    Performer perform;
+    Guard allowed;
+    Confirm confirmed;
+    const SequenceStep* sequence = nullptr;
+    SequenceStep current = {0, 0, 0, 0};
+    uint8_t length = 0;
+    uint8_t index = 0;
+    uint8_t mask = 0xFF;
+    bool running = false;
+    bool frozen = false;
+    bool holding = false;
+    unsigned long stepStart = 0;
+    unsigned long freezeStart = 0;
+};
@@ -0,0 +1,198 @@
+// Тести src/sequence.h: розклад кроків SequenceRunner без дрейфу, режими, freeze()/resume(),
+// блокування (Guard) і підтвердження кінця ходу (Confirm) у віртуальному часі.
+//
+//   pio test -e native -f test_sequence
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <unity.h>
+
+#include "../../src/sequence.h"
+
+#include <vector>
+
+struct Performed {
+    uint8_t action;
+    unsigned long atMs;
+};
+
+static std::vector<Performed> performed;
+static unsigned long guardOpenAtMs = 0;     // Guard дозволяє дію 2 лише з цього моменту
+static unsigned long confirmAtMs = 0;       // Confirm підтверджує дію 1 з цього моменту (0 — ніколи)
+
+static void perform(const SequenceStep& step) { performed.push_back({step.action, millis()}); }
+
+static bool guard(const SequenceStep& step) { return step.action != 2 || millis() >= guardOpenAtMs; }
+
+static bool confirm(const SequenceStep& step) { return step.action == 1 && confirmAtMs && millis() >= confirmAtMs; }
+
+// Дія, пін, очікування, режими
+const SequenceStep STEPS[] PROGMEM = {
+    {1, 8, 100, 0x01},
+    {2, 9, 200, 0x03},
+    {3, 0, 0, 0x01},
+    {4, 13, 50, 0x02},
+    {5, 0, 50, 0x03},
+};
+const uint8_t STEP_COUNT = sizeof(STEPS) / sizeof(STEPS[0]);
+
+// Викликати update() кожні periodMs до моменту untilMs
+static void run(SequenceRunner& runner, unsigned long untilMs, unsigned long periodMs = 1) {
+    while (millis() + periodMs <= untilMs) {
+        native::advanceMillis(periodMs);
+        runner.update();
+    }
+}
+
+static void assertPerformed(const std::vector<Performed>& expected) {
+    TEST_ASSERT_EQUAL(expected.size(), performed.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT8(expected[i].action, performed[i].action);
+        TEST_ASSERT_EQUAL_UINT32(expected[i].atMs, performed[i].atMs);
+    }
+}
+
+void setUp() {
+    native::resetClock();
+    performed.clear();
+    guardOpenAtMs = 0;
+    confirmAtMs = 0;
+}
+
+void tearDown() {}
+
+// Перший крок — у start(), далі кожен через waitMs попереднього; кроки з нульовим
+// очікуванням — на тій самій ітерації
+void test_steps_follow_wait_times() {
+    SequenceRunner runner(perform);
+    runner.start(STEPS, STEP_COUNT, 0x01);
+    TEST_ASSERT_TRUE(runner.isRunning());
+    run(runner, 1000);
+    assertPerformed({{1, 0}, {2, 100}, {3, 300}, {5, 300}});
+    TEST_ASSERT_FALSE(runner.isRunning());
+}
+
+void test_mode_mask_selects_steps() {
+    SequenceRunner runner(perform);
+    runner.start(STEPS, STEP_COUNT, 0x02);
+    run(runner, 1000);
+    assertPerformed({{2, 0}, {4, 200}, {5, 250}});
+}
+
+// Рідкі виклики update() не зсувають розклад: кожен крок — на першому виклику після свого
+// запланованого моменту, а не через waitMs після попереднього фактичного
+void test_late_updates_do_not_accumulate() {
+    SequenceRunner runner(perform);
+    runner.start(STEPS, STEP_COUNT, 0x02);
+    run(runner, 1000, 70);
+    assertPerformed({{2, 0}, {4, 210}, {5, 280}});
+}
+
+// Після довгої ітерації loop() усі прострочені кроки виконуються одразу, по порядку
+void test_overdue_steps_run_in_one_update() {
+    SequenceRunner runner(perform);
+    runner.start(STEPS, STEP_COUNT);
+    native::advanceMillis(1000);
+    runner.update();
+    assertPerformed({{1, 0}, {2, 1000}, {3, 1000}, {4, 1000}, {5, 1000}});
+    TEST_ASSERT_FALSE(runner.isRunning());
+}
+
+// Пауза посеред кроку: відлік стоїть, залишок кроку — після resume()
+void test_freeze_resume_shifts_remaining_time() {
+    SequenceRunner runner(perform);
+    runner.start(STEPS, STEP_COUNT, 0x01);
+    run(runner, 40);
+    runner.freeze();
+    TEST_ASSERT_TRUE(runner.isFrozen());
+    run(runner, 500);
+    assertPerformed({{1, 0}});
+    runner.freeze();                                // повторний freeze() не скидає початок паузи
+    runner.resume();
+    TEST_ASSERT_FALSE(runner.isFrozen());
+    run(runner, 2000);
+    assertPerformed({{1, 0}, {2, 560}, {3, 760}, {5, 760}});
+}
+
+void test_resume_without_freeze_is_ignored() {
+    SequenceRunner runner(perform);
+    runner.start(STEPS, STEP_COUNT, 0x01);
+    run(runner, 50);
+    runner.resume();
+    run(runner, 1000);
+    assertPerformed({{1, 0}, {2, 100}, {3, 300}, {5, 300}});
+}
+
+// Блокування тримає послідовність на кроці; час кроку — від фактичного виконання
+void test_guard_holds_step_until_allowed() {
+    guardOpenAtMs = 250;
+    SequenceRunner runner(perform, guard);
+    runner.start(STEPS, STEP_COUNT, 0x01);
+    run(runner, 200);
+    TEST_ASSERT_TRUE(runner.isHolding());
+    TEST_ASSERT_EQUAL(1, runner.stepIndex());
+    run(runner, 1000);
+    TEST_ASSERT_FALSE(runner.isHolding());
+    assertPerformed({{1, 0}, {2, 250}, {3, 450}, {5, 450}});
+}
+
+void test_guard_can_hold_first_step() {
+    guardOpenAtMs = 30;
+    SequenceRunner runner(perform, guard);
+    runner.start(STEPS, STEP_COUNT, 0x02);
+    TEST_ASSERT_TRUE(runner.isHolding());
+    TEST_ASSERT_EQUAL(0, performed.size());
+    run(runner, 1000);
+    assertPerformed({{2, 30}, {4, 230}, {5, 280}});
+}
+
+// Підтвердження кінця ходу завершує крок раніше; наступний відраховується від підтвердження
+void test_confirm_ends_step_early() {
+    confirmAtMs = 40;
+    SequenceRunner runner(perform, nullptr, confirm);
+    runner.start(STEPS, STEP_COUNT, 0x01);
+    run(runner, 1000);
+    assertPerformed({{1, 0}, {2, 40}, {3, 240}, {5, 240}});
+}
+
+// Без підтвердження waitMs — верхня межа, крок закінчується за часом
+void test_confirm_missing_falls_back_to_wait() {
+    SequenceRunner runner(perform, nullptr, confirm);
+    runner.start(STEPS, STEP_COUNT, 0x01);
+    run(runner, 1000);
+    assertPerformed({{1, 0}, {2, 100}, {3, 300}, {5, 300}});
+}
+
+// Дві послідовності (підготовка пакету й пакування) не заважають одна одній
+void test_two_runners_are_independent() {
+    SequenceRunner a(perform);
+    SequenceRunner b(perform);
+    a.start(STEPS, STEP_COUNT, 0x01);
+    native::advanceMillis(30);
+    b.start(STEPS, STEP_COUNT, 0x02);
+    a.freeze();
+    while (millis() < 1000) {
+        native::advanceMillis(1);
+        a.update();
+        b.update();
+    }
+    assertPerformed({{1, 0}, {2, 30}, {4, 230}, {5, 280}});
+    TEST_ASSERT_TRUE(a.isRunning());
+    TEST_ASSERT_FALSE(b.isRunning());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_steps_follow_wait_times);
+    RUN_TEST(test_mode_mask_selects_steps);
+    RUN_TEST(test_late_updates_do_not_accumulate);
+    RUN_TEST(test_overdue_steps_run_in_one_update);
+    RUN_TEST(test_freeze_resume_shifts_remaining_time);
+    RUN_TEST(test_resume_without_freeze_is_ignored);
+    RUN_TEST(test_guard_holds_step_until_allowed);
+    RUN_TEST(test_guard_can_hold_first_step);
+    RUN_TEST(test_confirm_ends_step_early);
+    RUN_TEST(test_confirm_missing_falls_back_to_wait);
+    RUN_TEST(test_two_runners_are_independent);
+    return UNITY_END();
+}
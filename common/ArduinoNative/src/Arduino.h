@@ -0,0 +1,111 @@
+#pragma once
+// Заміна Arduino core для збірки прошивок на ПК ([env:native]).
+// Час віртуальний, піни та Serial — віртуальні; керування ними — в ArduinoNative.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+
+#include "avr/pgmspace.h"
+#include "WString.h"
+#include "HardwareSerial.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define PI         3.1415926535897932384626433832795
+#define HALF_PI    1.5707963267948966192313216916398
+#define TWO_PI     6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#if defined(ARDUINO_AVR_MEGA2560)
+#define NUM_DIGITAL_PINS 70
+static const uint8_t A0 = 54;
+static const uint8_t A1 = 55;
+static const uint8_t A2 = 56;
+static const uint8_t A3 = 57;
+static const uint8_t A4 = 58;
+static const uint8_t A5 = 59;
+static const uint8_t A6 = 60;
+static const uint8_t A7 = 61;
+static const uint8_t A8 = 62;
+static const uint8_t A9 = 63;
+static const uint8_t A10 = 64;
+static const uint8_t A11 = 65;
+static const uint8_t A12 = 66;
+static const uint8_t A13 = 67;
+static const uint8_t A14 = 68;
+static const uint8_t A15 = 69;
+#else
+#define NUM_DIGITAL_PINS 20
+static const uint8_t A0 = 14;
+static const uint8_t A1 = 15;
+static const uint8_t A2 = 16;
+static const uint8_t A3 = 17;
+static const uint8_t A4 = 18;
+static const uint8_t A5 = 19;
+#endif
+#define LED_BUILTIN 13
+
+#define _BV(bit) (1UL << (bit))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define sq(x) ((x) * (x))
+
+// В Arduino core min/max — макроси з довільними типами аргументів
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type min(const T& a, const U& b) { return a < b ? a : b; }
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type max(const T& a, const U& b) { return a > b ? a : b; }
+
+class __FlashStringHelper;
+#define F(string_literal) (string_literal)
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Код прошивки і «переривання» виконуються в одному потоці — заборона не потрібна
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+void setup();
+void loop();
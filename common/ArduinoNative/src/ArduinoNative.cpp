@@ -0,0 +1,391 @@
+#include "Arduino.h"
+#include "ArduinoNative.h"
+
+#include <queue>
+#include <set>
+#include <stdio.h>
+
+namespace native {
+
+// ---------------- Плата ----------------
+
+bool Board::level(uint8_t pin) const {
+    if (pin >= MAX_PINS) return false;
+    const Pin& p = pins_[pin];
+    if (p.mode == OUTPUT) return p.output;        // як PINx для виходу
+    if (p.driven) return p.external;
+    return p.mode == INPUT_PULLUP;                 // без сигналу: підтяжка або «земля»
+}
+
+void Board::notifyInput(uint8_t pin, bool before) {
+    bool after = level(pin);
+    if (after == before) return;
+    for (auto& l : inputListeners_) l(pin, after);
+}
+
+void Board::setInput(uint8_t pin, bool lvl) {
+    if (pin >= MAX_PINS) return;
+    bool before = level(pin);
+    pins_[pin].driven = true;
+    pins_[pin].external = lvl;
+    notifyInput(pin, before);
+}
+
+void Board::releaseInput(uint8_t pin) {
+    if (pin >= MAX_PINS) return;
+    bool before = level(pin);
+    pins_[pin].driven = false;
+    notifyInput(pin, before);
+}
+
+void Board::serialInput(const std::string& data, uint8_t port) {
+    SerialPort& s = serial(port);
+    for (char c : data) s.rx.push_back((uint8_t)c);
+}
+
+void Board::pinMode(uint8_t pin, uint8_t m) {
+    if (pin >= MAX_PINS) return;
+    bool before = level(pin);
+    pins_[pin].mode = m;
+    if (m != OUTPUT) notifyInput(pin, before);
+}
+
+void Board::digitalWrite(uint8_t pin, bool lvl) {
+    if (pin >= MAX_PINS) return;
+    Pin& p = pins_[pin];
+    if (p.mode != OUTPUT) {
+        // Запис HIGH у вхід вмикає підтяжку (як в AVR)
+        bool before = level(pin);
+        p.mode = lvl ? INPUT_PULLUP : INPUT;
+        notifyInput(pin, before);
+        return;
+    }
+    if (p.output == lvl) return;
+    p.output = lvl;
+    for (auto& l : outputListeners_) l(pin, lvl);
+}
+
+bool Board::loadEeprom(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    size_t n = fread(eeprom_, 1, sizeof(eeprom_), f);
+    fclose(f);
+    return n == sizeof(eeprom_);
+}
+
+bool Board::saveEeprom(const char* path) const {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    size_t n = fwrite(eeprom_, 1, sizeof(eeprom_), f);
+    fclose(f);
+    return n == sizeof(eeprom_);
+}
+
+static Board defaultBoard("board");
+static Board* currentBoard = &defaultBoard;
+
+Board& board() { return *currentBoard; }
+void setBoard(Board* b) { currentBoard = b ? b : &defaultBoard; }
+
+// ---------------- Годинник і події ----------------
+
+namespace {
+
+struct Event {
+    uint64_t at;
+    EventId id;
+    Board* board;
+    std::function<void()> fn;
+};
+
+struct Later {
+    bool operator()(const Event& a, const Event& b) const {
+        return a.at != b.at ? a.at > b.at : a.id > b.id;  // однаковий час — у порядку планування
+    }
+};
+
+uint64_t nowNs = 0;
+EventId nextId = 1;
+std::priority_queue<Event, std::vector<Event>, Later> events;
+std::set<EventId> cancelled;
+SleepHook sleepHook;
+int eventDepth = 0;        // >0 — виконується подія («переривання»)
+
+struct EventScope {
+    EventScope() { eventDepth++; }
+    ~EventScope() { eventDepth--; }
+};
+
+} // namespace
+
+uint64_t nanos() { return nowNs; }
+
+EventId scheduleAt(uint64_t ns, std::function<void()> fn) {
+    EventId id = nextId++;
+    events.push(Event{ns < nowNs ? nowNs : ns, id, &board(), std::move(fn)});
+    return id;
+}
+
+void cancel(EventId id) { cancelled.insert(id); }
+
+uint64_t nextEventNs() {
+    while (!events.empty() && cancelled.count(events.top().id)) {
+        cancelled.erase(events.top().id);
+        events.pop();
+    }
+    return events.empty() ? UINT64_MAX : events.top().at;
+}
+
+void advanceTo(uint64_t target) {
+    while (nextEventNs() <= target) {
+        Event ev = events.top();
+        events.pop();
+        nowNs = ev.at;
+        BoardScope scope(*ev.board);
+        EventScope inEvent;
+        ev.fn();
+    }
+    if (target > nowNs) nowNs = target;
+}
+
+void advanceNanos(uint64_t ns) { advanceTo(nowNs + ns); }
+
+void resetClock() {
+    nowNs = 0;
+    while (!events.empty()) events.pop();
+    cancelled.clear();
+}
+
+void setSleepHook(SleepHook hook) { sleepHook = std::move(hook); }
+
+void sleepNanos(uint64_t ns) {
+    if (eventDepth) return;   // час обробника переривання не моделюється
+    if (sleepHook) sleepHook(ns);
+    else advanceNanos(ns);
+}
+
+// ---------------- CtcTimer ----------------
+
+void CtcTimer::start(uint16_t top, uint16_t compareB) {
+    top_ = top;
+    compareBTicks_ = compareB;
+    running_ = true;
+    generation_++;
+    scheduleNext(nanos());
+}
+
+void CtcTimer::stop() {
+    running_ = false;
+    generation_++;
+}
+
+void CtcTimer::scheduleNext(uint64_t periodStartNs) {
+    uint32_t gen = generation_;
+    uint64_t matchA = periodStartNs + (uint64_t)top_ * tickNs_;
+    scheduleAt(matchA, [this, gen, matchA]() {
+        if (gen != generation_ || !running_) return;
+        if (compareA_) compareA_();
+        if (gen != generation_ || !running_) return;   // обробник міг зупинити таймер
+        if (compareB_ && compareBTicks_ < top_) {
+            scheduleAt(matchA + (uint64_t)compareBTicks_ * tickNs_, [this, gen]() {
+                if (gen == generation_ && running_ && compareB_) compareB_();
+            });
+        }
+        scheduleNext(matchA);
+    });
+}
+
+} // namespace native
+
+// ---------------- Arduino API ----------------
+
+// avr/eeprom.h: адреса — номер байта, як у avr-libc
+static uint8_t* eepromCell(const void* addr) {
+    return native::board().eeprom() + ((uintptr_t)addr % native::EEPROM_SIZE);
+}
+
+int eeprom_is_ready() { return native::nanos() >= native::board().eepromBusyUntilNs; }
+
+void eeprom_busy_wait() {
+    native::Board& b = native::board();
+    if (native::nanos() < b.eepromBusyUntilNs) native::sleepNanos(b.eepromBusyUntilNs - native::nanos());
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr) {
+    eeprom_busy_wait();
+    return *eepromCell(addr);
+}
+
+void eeprom_write_byte(uint8_t* addr, uint8_t value) {
+    eeprom_busy_wait();
+    *eepromCell(addr) = value;
+    native::board().eepromBusyUntilNs = native::nanos() + native::EEPROM_WRITE_NS;
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value) {
+    if (eeprom_read_byte(addr) != value) eeprom_write_byte(addr, value);
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n) {
+    for (size_t i = 0; i < n; i++) ((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) eeprom_update_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { native::board().pinMode(pin, mode); }
+void digitalWrite(uint8_t pin, uint8_t val) { native::board().digitalWrite(pin, val != LOW); }
+int digitalRead(uint8_t pin) { return native::board().digitalRead(pin) ? HIGH : LOW; }
+int analogRead(uint8_t pin) { return native::board().digitalRead(pin) ? 1023 : 0; }
+void analogWrite(uint8_t pin, int val) {
+    native::board().pinMode(pin, OUTPUT);
+    native::board().digitalWrite(pin, val >= 128);
+}
+
+unsigned long millis() { return (unsigned long)native::millis64(); }
+unsigned long micros() { return (unsigned long)native::micros64(); }
+void delay(unsigned long ms) { native::sleepNanos((uint64_t)ms * 1000000ULL); }
+void delayMicroseconds(unsigned int us) { native::sleepNanos((uint64_t)us * 1000ULL); }
+
+long random(long howbig) { return howbig > 0 ? rand() % howbig : 0; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// ---------------- Print / Stream / HardwareSerial ----------------
+
+size_t Print::printNumber(unsigned long long v, int base) {
+    if (base < 2) base = 10;
+    char buf[66];
+    char* p = &buf[sizeof(buf) - 1];
+    *p = 0;
+    do {
+        int d = (int)(v % base);
+        *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+        v /= base;
+    } while (v);
+    return write(p);
+}
+
+size_t Print::printSigned(long long v, int base) {
+    if (base == 10 && v < 0) {
+        size_t n = print('-');
+        return n + printNumber((unsigned long long)(-v), 10);
+    }
+    return printNumber((unsigned long long)v, base);
+}
+
+size_t Print::printFloat(double v, int digits) {
+    if (isnan(v)) return write("nan");
+    if (isinf(v)) return write("inf");
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return write(buf);
+}
+
+int Stream::timedRead() {
+    uint64_t deadline = native::nanos() + (uint64_t)timeoutMs_ * 1000000ULL;
+    while (true) {
+        int c = read();
+        if (c >= 0) return c;
+        uint64_t now = native::nanos();
+        if (now >= deadline) return -1;
+        // Чекаємо наступної події (байт може прийти від іншого контролера)
+        uint64_t next = native::nextEventNs();
+        uint64_t until = next < deadline ? next : deadline;
+        native::sleepNanos(until > now ? until - now : 1000);
+    }
+}
+
+String Stream::readStringUntil(char terminator) {
+    String s;
+    int c = timedRead();
+    while (c >= 0 && c != terminator) {
+        s += (char)c;
+        c = timedRead();
+    }
+    return s;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+static void drainTx(native::SerialPort& s) {
+    uint64_t byteNs = s.byteTimeNs();
+    if (!byteNs || !s.txQueued) return;
+    uint64_t now = native::nanos();
+    uint64_t sent = (now - s.txDrainNs) / byteNs;
+    if (sent >= s.txQueued) {
+        s.txQueued = 0;
+    } else {
+        s.txQueued -= sent;
+        s.txDrainNs += sent * byteNs;
+    }
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+    native::SerialPort& s = native::board().serial(port_);
+    s.baud = baud;
+    s.txQueued = 0;
+}
+
+int HardwareSerial::available() { return (int)native::board().serial(port_).rx.size(); }
+
+int HardwareSerial::read() {
+    native::SerialPort& s = native::board().serial(port_);
+    if (s.rx.empty()) return -1;
+    int c = s.rx.front();
+    s.rx.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    native::SerialPort& s = native::board().serial(port_);
+    return s.rx.empty() ? -1 : s.rx.front();
+}
+
+int HardwareSerial::availableForWrite() {
+    native::SerialPort& s = native::board().serial(port_);
+    drainTx(s);
+    return (int)(native::SERIAL_TX_BUFFER - s.txQueued);
+}
+
+void HardwareSerial::flush() {
+    native::SerialPort& s = native::board().serial(port_);
+    drainTx(s);
+    if (s.txQueued) native::sleepNanos(s.txQueued * s.byteTimeNs());
+    drainTx(s);
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+    native::Board& brd = native::board();
+    native::SerialPort& s = brd.serial(port_);
+    if (s.baud) {
+        // Повний апаратний буфер блокує так само, як на AVR
+        drainTx(s);
+        while (s.txQueued >= native::SERIAL_TX_BUFFER) {
+            native::sleepNanos(s.byteTimeNs());
+            drainTx(s);
+        }
+        if (!s.txQueued) s.txDrainNs = native::nanos();
+        s.txQueued++;
+    }
+    s.tx.push_back((char)b);
+    for (auto& l : s.txListeners) l(b);
+    return 1;
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+HardwareSerial Serial3(3);
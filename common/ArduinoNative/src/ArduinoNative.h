@@ -0,0 +1,170 @@
+#pragma once
+// Віртуальне «залізо» для збірки прошивок на ПК.
+//
+//  - Годинник: єдиний віртуальний час (нс) з чергою подій. Час іде лише тоді, коли
+//    його прокручують: раннер між викликами loop(), delay()/delayMicroseconds(),
+//    блокуючий Serial. Події (таймери-«переривання», стимули) виконуються рівно у свій момент.
+//  - Плата (Board): 70 віртуальних пінів, чотири Serial-порти з буфером TX як у залізі.
+//    Кілька плат можуть жити в одному процесі (цифровий двійник лінії) — Arduino API
+//    завжди працює з поточною платою, події перемикають плату автоматично.
+//  - CtcTimer: модель 16-бітного таймера в режимі CTC з двома compare-каналами
+//    для коду, який на AVR працює від Timer1/Timer3.
+//  - EEPROM: 4 КБ на плату (як у Mega), запис байта займає EEPROM_WRITE_NS віртуального
+//    часу, протягом якого eeprom_is_ready() повертає false (avr/eeprom.h).
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace native {
+
+constexpr uint8_t MAX_PINS = 70;
+constexpr uint8_t SERIAL_PORTS = 4;
+constexpr size_t SERIAL_TX_BUFFER = 63;   // як у HardwareSerial AVR (64 байти, один резервний)
+constexpr size_t EEPROM_SIZE = 4096;
+constexpr uint64_t EEPROM_WRITE_NS = 3400000;   // стирання + запис байта, 3.4 мс
+
+using PinListener = std::function<void(uint8_t pin, bool level)>;
+using ByteListener = std::function<void(uint8_t b)>;
+
+struct SerialPort {
+    unsigned long baud = 0;
+    std::deque<uint8_t> rx;
+    std::string tx;                 // усе, що прошивка надіслала (для перевірок)
+    size_t txQueued = 0;            // байтів у віртуальному апаратному буфері
+    uint64_t txDrainNs = 0;         // момент, від якого рахується спорожнення буфера
+    std::vector<ByteListener> txListeners;
+
+    uint64_t byteTimeNs() const { return baud ? 10ULL * 1000000000ULL / baud : 0; }
+};
+
+class Board {
+public:
+    explicit Board(const char* name = "board") : name_(name) { memset(eeprom_, 0xFF, sizeof(eeprom_)); }
+
+    const char* name() const { return name_.c_str(); }
+
+    // --- Зовнішній світ → плата ---
+    // Подати рівень на вхід (датчик, кнопка, сигнал іншого контролера)
+    void setInput(uint8_t pin, bool level);
+    // Відпустити вхід: залишається лише внутрішня підтяжка (якщо INPUT_PULLUP)
+    void releaseInput(uint8_t pin);
+    // Надіслати байти у Serial порт плати
+    void serialInput(const std::string& data, uint8_t port = 0);
+
+    // --- Спостереження ---
+    bool outputLevel(uint8_t pin) const { return pin < MAX_PINS && pins_[pin].output; }
+    bool level(uint8_t pin) const;          // те, що поверне digitalRead()
+    uint8_t mode(uint8_t pin) const { return pin < MAX_PINS ? pins_[pin].mode : 0; }
+    void onOutputChange(PinListener l) { outputListeners_.push_back(std::move(l)); }
+    void onInputChange(PinListener l) { inputListeners_.push_back(std::move(l)); }
+    void onSerialTx(ByteListener l, uint8_t port = 0) { serial(port).txListeners.push_back(std::move(l)); }
+
+    SerialPort& serial(uint8_t port) { return serial_[port < SERIAL_PORTS ? port : 0]; }
+    std::string& serialOutput(uint8_t port = 0) { return serial(port).tx; }
+
+    // Вміст EEPROM (чиста — 0xFF) і момент, до якого триває поточний запис
+    uint8_t* eeprom() { return eeprom_; }
+    uint64_t eepromBusyUntilNs = 0;
+    bool loadEeprom(const char* path);
+    bool saveEeprom(const char* path) const;
+
+    // --- Для Arduino API (викликає код прошивки) ---
+    void pinMode(uint8_t pin, uint8_t mode);
+    void digitalWrite(uint8_t pin, bool level);
+    bool digitalRead(uint8_t pin) const { return level(pin); }
+
+private:
+    struct Pin {
+        uint8_t mode = 0;       // INPUT
+        bool output = false;    // рівень, записаний прошивкою (PORTx)
+        bool driven = false;    // чи подає щось рівень ззовні
+        bool external = false;  // зовнішній рівень
+    };
+
+    void notifyInput(uint8_t pin, bool before);
+
+    std::string name_;
+    Pin pins_[MAX_PINS];
+    SerialPort serial_[SERIAL_PORTS];
+    uint8_t eeprom_[EEPROM_SIZE];
+    std::vector<PinListener> outputListeners_;
+    std::vector<PinListener> inputListeners_;
+};
+
+// Поточна плата (чий код зараз виконується). За замовчуванням — одна вбудована плата.
+Board& board();
+void setBoard(Board* b);
+
+class BoardScope {
+public:
+    explicit BoardScope(Board& b) : prev_(&board()) { setBoard(&b); }
+    ~BoardScope() { setBoard(prev_); }
+private:
+    Board* prev_;
+};
+
+// --- Віртуальний час ---
+uint64_t nanos();
+inline uint64_t micros64() { return nanos() / 1000; }
+inline uint64_t millis64() { return nanos() / 1000000; }
+
+// Прокрутити час вперед, виконуючи всі події, що припадають на цей проміжок
+void advanceNanos(uint64_t ns);
+inline void advanceMicros(uint64_t us) { advanceNanos(us * 1000); }
+inline void advanceMillis(uint64_t ms) { advanceNanos(ms * 1000000); }
+// Прокрутити до абсолютного моменту (якщо він ще не настав)
+void advanceTo(uint64_t ns);
+
+// Скинути час і всі заплановані події
+void resetClock();
+
+using EventId = uint64_t;
+// Запланувати подію на абсолютний момент; виконується в контексті поточної плати
+EventId scheduleAt(uint64_t ns, std::function<void()> fn);
+inline EventId scheduleAfter(uint64_t ns, std::function<void()> fn) { return scheduleAt(nanos() + ns, std::move(fn)); }
+void cancel(EventId id);
+// Момент найближчої події (UINT64_MAX, якщо черга порожня)
+uint64_t nextEventNs();
+
+// Очікування всередині прошивки (delay, delayMicroseconds, повний буфер Serial).
+// За замовчуванням просто прокручує час; двійник лінії підміняє, щоб
+// інші контролери працювали, поки цей «спить».
+// Усередині події (обробника переривання) очікування не займає віртуального часу —
+// як короткий delayMicroseconds() в ISR, який на AVR не пускає інший код.
+using SleepHook = std::function<void(uint64_t ns)>;
+void setSleepHook(SleepHook hook);
+void sleepNanos(uint64_t ns);
+
+// Модель 16-бітного таймера AVR у режимі CTC.
+// Канал A: подія кожні top тіків (лічильник скидається). Канал B: через compareB тіків
+// після кожного скидання. Новий top, заданий з обробника A, діє з наступного періоду —
+// так само, як запис OCRnA з ISR(TIMERn_COMPA_vect).
+class CtcTimer {
+public:
+    explicit CtcTimer(uint32_t tickNs) : tickNs_(tickNs) {}
+
+    void onCompareA(std::function<void()> fn) { compareA_ = std::move(fn); }
+    void onCompareB(std::function<void()> fn) { compareB_ = std::move(fn); }
+
+    void start(uint16_t top, uint16_t compareB);
+    void setTop(uint16_t top) { top_ = top; }
+    void stop();
+    bool running() const { return running_; }
+
+private:
+    void scheduleNext(uint64_t periodStartNs);
+
+    uint32_t tickNs_;
+    uint16_t top_ = 0xFFFF;
+    uint16_t compareBTicks_ = 0;
+    bool running_ = false;
+    uint32_t generation_ = 0;
+    std::function<void()> compareA_;
+    std::function<void()> compareB_;
+};
+
+} // namespace native
@@ -0,0 +1,89 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Print/Stream/HardwareSerial з тим самим набором перевантажень, що й в Arduino core:
+// print(bool) друкує 1/0, print(float) — 2 знаки після коми.
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlenSafe(s)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return printNumber(v, base); }
+    size_t print(int v, int base = DEC) { return printSigned(v, base); }
+    size_t print(unsigned int v, int base = DEC) { return printNumber(v, base); }
+    size_t print(long v, int base = DEC) { return printSigned(v, base); }
+    size_t print(unsigned long v, int base = DEC) { return printNumber(v, base); }
+    size_t print(long long v, int base = DEC) { return printSigned(v, base); }
+    size_t print(unsigned long long v, int base = DEC) { return printNumber(v, base); }
+    size_t print(double v, int digits = 2) { return printFloat(v, digits); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template <typename T>
+    size_t println(const T& v, int format) { size_t n = print(v, format); return n + println(); }
+
+private:
+    static size_t strlenSafe(const char* s) { size_t n = 0; while (s[n]) n++; return n; }
+    size_t printSigned(long long v, int base);
+    size_t printNumber(unsigned long long v, int base);
+    size_t printFloat(double v, int digits);
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeoutMs_ = ms; }
+    // Як і в Arduino: блокує (у віртуальному часі) до термінатора або тайм-ауту
+    String readStringUntil(char terminator);
+    size_t readBytes(char* buffer, size_t length);
+
+protected:
+    int timedRead();
+    unsigned long timeoutMs_ = 1000;
+};
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(uint8_t port) : port_(port) {}
+
+    void begin(unsigned long baud);
+    void begin(unsigned long baud, uint8_t) { begin(baud); }
+    void end() {}
+    int available() override;
+    int read() override;
+    int peek() override;
+    int availableForWrite();
+    void flush();
+    size_t write(uint8_t b) override;
+    using Print::write;
+    operator bool() const { return true; }
+
+private:
+    uint8_t port_;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdlib.h>
+#include <string>
+
+// Клас String з Arduino core поверх std::string (лише те, чим користуються прошивки)
+class String {
+public:
+    String() {}
+    String(const char* s) : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    explicit String(char c) : s_(1, c) {}
+    explicit String(int v) : s_(std::to_string(v)) {}
+    explicit String(unsigned int v) : s_(std::to_string(v)) {}
+    explicit String(long v) : s_(std::to_string(v)) {}
+    explicit String(unsigned long v) : s_(std::to_string(v)) {}
+
+    unsigned int length() const { return (unsigned int)s_.size(); }
+    const char* c_str() const { return s_.c_str(); }
+    const std::string& str() const { return s_; }
+
+    char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    bool equals(const String& o) const { return s_ == o.s_; }
+    bool operator==(const String& o) const { return s_ == o.s_; }
+    bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+    bool operator!=(const String& o) const { return s_ != o.s_; }
+    bool operator!=(const char* o) const { return !(*this == o); }
+
+    bool startsWith(const String& prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+    bool endsWith(const String& suffix) const {
+        return s_.size() >= suffix.s_.size() &&
+               s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t p = s_.find(c, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    int indexOf(const String& sub, unsigned int from = 0) const {
+        size_t p = s_.find(sub.s_, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+
+    String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (from >= s_.size()) return String();
+        return String(s_.substr(from, to - from));
+    }
+
+    void trim() {
+        size_t b = s_.find_first_not_of(" \t\r\n");
+        size_t e = s_.find_last_not_of(" \t\r\n");
+        s_ = (b == std::string::npos) ? std::string() : s_.substr(b, e - b + 1);
+    }
+    void toLowerCase() { for (auto& c : s_) c = (char)tolower((unsigned char)c); }
+    void toUpperCase() { for (auto& c : s_) c = (char)toupper((unsigned char)c); }
+
+    long toInt() const { return atol(s_.c_str()); }
+    float toFloat() const { return (float)atof(s_.c_str()); }
+
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    String& operator+=(const char* o) { s_ += (o ? o : ""); return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+    bool concat(const String& o) { s_ += o.s_; return true; }
+    bool concat(char c) { s_ += c; return true; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b) { return String(a.s_ + (b ? b : "")); }
+
+private:
+    std::string s_;
+};
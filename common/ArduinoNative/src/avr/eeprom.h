@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// EEPROM поточної віртуальної плати (ArduinoNative). Як і на AVR, запис байта триває
+// кілька мілісекунд: eeprom_is_ready() дозволяє не чекати на нього в loop(),
+// а читання і наступний запис чекають (у віртуальному часі), доки він завершиться.
+int eeprom_is_ready();
+void eeprom_busy_wait();
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_write_byte(uint8_t* addr, uint8_t value);
+void eeprom_update_byte(uint8_t* addr, uint8_t value);
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_update_block(const void* src, void* dst, size_t n);
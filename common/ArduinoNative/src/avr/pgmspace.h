@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// На ПК флеш і ОЗП — одна адресна простір, читання з PROGMEM — звичайне розіменування
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
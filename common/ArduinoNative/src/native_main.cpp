@@ -0,0 +1,131 @@
+// Раннер прошивки на ПК: setup(), потім loop() у віртуальному часі.
+//
+//   program [--ms N] [--loop-us N] [--in PIN=0|1@MS]... [--serial TEXT@MS]... [--eeprom FILE] [--trace] [--quiet]
+//
+//   --ms N          скільки мілісекунд віртуального часу прогнати (5000)
+//   --loop-us N     скільки мікросекунд «коштує» один виклик loop() (20)
+//   --in P=L@T      у момент T мс подати рівень L на вхід P (можна повторювати)
+//   --serial S@T    у момент T мс надіслати рядок S + '\n' у Serial
+//   --eeprom FILE   вміст EEPROM: прочитати з файлу перед setup() (якщо він є), записати в кінці —
+//                   кілька запусків поспіль моделюють вимкнення і ввімкнення живлення
+//   --trace         друкувати зміни виходів: "<мс> OUT <пін>=<рівень>"
+//   --quiet         не друкувати вивід Serial прошивки
+//
+// Наприкінці в stderr друкується кількість ітерацій loop(), середній і найдовший
+// час ітерації (віртуальний — з урахуванням delay(), і реальний — на цьому ПК).
+//
+// Визначте ARDUINO_NATIVE_NO_MAIN, якщо main() надає інша програма (двійник лінії тощо).
+// Під `pio test` (PIO_UNIT_TESTING) main() — у тесті, раннер не збирається сам.
+
+#if !defined(ARDUINO_NATIVE_NO_MAIN) && !defined(PIO_UNIT_TESTING)
+
+#include "Arduino.h"
+#include "ArduinoNative.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+
+namespace {
+
+bool parseAt(const std::string& arg, std::string& what, uint64_t& atMs) {
+    size_t at = arg.rfind('@');
+    if (at == std::string::npos) return false;
+    what = arg.substr(0, at);
+    atMs = strtoull(arg.c_str() + at + 1, nullptr, 10);
+    return true;
+}
+
+void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [--ms N] [--loop-us N] [--in PIN=0|1@MS]... [--serial TEXT@MS]... [--eeprom FILE] [--trace] [--quiet]\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t runMs = 5000;
+    uint64_t loopUs = 20;
+    bool trace = false;
+    bool quiet = false;
+    std::string eepromPath;
+    native::Board& brd = native::board();
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+        std::string what;
+        uint64_t atMs = 0;
+        if (a == "--ms" && i + 1 < argc) {
+            runMs = strtoull(value.c_str(), nullptr, 10);
+            i++;
+        } else if (a == "--loop-us" && i + 1 < argc) {
+            loopUs = strtoull(value.c_str(), nullptr, 10);
+            i++;
+        } else if (a == "--in" && i + 1 < argc && parseAt(value, what, atMs) && what.find('=') != std::string::npos) {
+            uint8_t pin = (uint8_t)atoi(what.c_str());
+            bool level = atoi(what.c_str() + what.find('=') + 1) != 0;
+            native::scheduleAt(atMs * 1000000ULL, [&brd, pin, level]() { brd.setInput(pin, level); });
+            i++;
+        } else if (a == "--serial" && i + 1 < argc && parseAt(value, what, atMs)) {
+            native::scheduleAt(atMs * 1000000ULL, [&brd, what]() { brd.serialInput(what + "\n"); });
+            i++;
+        } else if (a == "--eeprom" && i + 1 < argc) {
+            eepromPath = value;
+            i++;
+        } else if (a == "--trace") {
+            trace = true;
+        } else if (a == "--quiet") {
+            quiet = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!quiet) brd.onSerialTx([](uint8_t b) { fputc(b, stdout); });
+    if (trace) {
+        brd.onOutputChange([](uint8_t pin, bool level) {
+            printf("%llu OUT %u=%d\n", (unsigned long long)native::millis64(), pin, level ? 1 : 0);
+        });
+    }
+
+    if (!eepromPath.empty()) brd.loadEeprom(eepromPath.c_str());
+
+    using HostClock = std::chrono::steady_clock;
+    setup();
+
+    uint64_t loops = 0;
+    uint64_t virtTotalNs = 0, virtMaxNs = 0;
+    uint64_t hostTotalNs = 0, hostMaxNs = 0;
+    const uint64_t endNs = runMs * 1000000ULL;
+
+    while (native::nanos() < endNs) {
+        uint64_t v0 = native::nanos();
+        auto h0 = HostClock::now();
+        loop();
+        uint64_t hostNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(HostClock::now() - h0).count();
+        native::advanceMicros(loopUs);
+        uint64_t virtNs = native::nanos() - v0;
+
+        loops++;
+        virtTotalNs += virtNs;
+        hostTotalNs += hostNs;
+        if (virtNs > virtMaxNs) virtMaxNs = virtNs;
+        if (hostNs > hostMaxNs) hostMaxNs = hostNs;
+    }
+    fflush(stdout);
+    if (!eepromPath.empty() && !brd.saveEeprom(eepromPath.c_str())) {
+        fprintf(stderr, "cannot write %s\n", eepromPath.c_str());
+    }
+
+    if (loops) {
+        fprintf(stderr,
+                "loops=%llu virtual_ms=%llu loop_virtual_us avg=%.1f max=%.1f loop_host_ns avg=%.0f max=%llu\n",
+                (unsigned long long)loops, (unsigned long long)native::millis64(),
+                virtTotalNs / 1000.0 / loops, virtMaxNs / 1000.0,
+                (double)hostTotalNs / loops, (unsigned long long)hostMaxNs);
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,195 @@
+#pragma once
+#include <stdint.h>
+
+// Кінематика конвеєрів у цілих числах: AVR не має FPU, а float-ділення там коштує
+// сотні тактів. Спільна для 1.conveyor і 2.small conveyor.
+//
+// Одиниці:
+//  - відстань — мікрометри (int32_t) або кроки;
+//  - кроки на мм — Q16.16 (StepScale);
+//  - швидкість генератора кроків — частка кроку на тік таймера, Q0.32 (DdaRamp).
+//
+// Константи з налаштувань (мм, мм/с) переводяться в кроки й тіки функціями constexpr —
+// при компіляції, у прошивку потрапляє лише ціле. Під час роботи — множення, зсуви
+// й додавання; ділення лишається тільки там, де змінюються налаштування.
+// Сумісно з C++11 (Uno збирається з gnu++11).
+
+namespace kin {
+
+typedef int32_t q16_t;
+const q16_t Q16_ONE = 65536L;
+
+// --- При компіляції ---
+
+constexpr q16_t toQ16(double v) { return (q16_t)(v * 65536.0 + (v < 0 ? -0.5 : 0.5)); }
+constexpr int32_t mmToUm(double mm) { return (int32_t)(mm * 1000.0 + (mm < 0 ? -0.5 : 0.5)); }
+
+// Відстань у кроках, з округленням
+constexpr uint32_t mmToSteps(double mm, double stepsPerMm) { return (uint32_t)(mm * stepsPerMm + 0.5); }
+
+// Інтервал між кроками в тіках таймера на швидкості mmPerS
+constexpr uint32_t stepTicks(double mmPerS, double stepsPerMm, double ticksPerSecond) {
+    return (uint32_t)(ticksPerSecond / (mmPerS * stepsPerMm) + 0.5);
+}
+
+// --- Під час роботи ---
+
+// Лише для звітів у Serial
+inline float toFloat(q16_t v) { return v / 65536.0f; }
+
+// Цілий квадратний корінь (вниз), по біту за ітерацію
+inline uint32_t isqrt(uint32_t x) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Масштаб осі: мікрометри <-> кроки. Перетворення — одне множення 32x32 і зсув на 32 або 16
+// біт (без ділення). Кроків на мм — менше 1000.
+class StepScale {
+public:
+    constexpr StepScale() : stepsPerMm_(0), stepsPerUm_(0), umPerStep_(0) {}
+    constexpr explicit StepScale(q16_t stepsPerMm)
+        : stepsPerMm_(stepsPerMm),
+          stepsPerUm_((uint32_t)((((uint64_t)stepsPerMm << 16) + 500) / 1000)),
+          umPerStep_((uint32_t)(((1000ULL << 32) + (uint32_t)stepsPerMm / 2) / (uint32_t)stepsPerMm)) {}
+
+    q16_t stepsPerMm() const { return stepsPerMm_; }
+
+    int32_t steps(int32_t um) const { return (int32_t)(((int64_t)um * stepsPerUm_ + 0x80000000LL) >> 32); }
+    int32_t um(int32_t steps) const { return (int32_t)(((int64_t)steps * umPerStep_ + 0x8000) >> 16); }
+
+private:
+    q16_t stepsPerMm_;
+    uint32_t stepsPerUm_;       // Q0.32
+    uint32_t umPerStep_;        // Q16.16
+};
+
+// Генератор кроків з розгоном і гальмуванням для переривання таймера з постійною частотою
+// тіків (цифровий диференціальний аналізатор).
+//
+// Швидкість — частка кроку на тік (Q0.32). На кожному тіку до неї додається прискорення,
+// а до фази — швидкість; переповнення фази — крок. На тіку — лише 32-бітні додавання,
+// на кроці — ще одне множення для перевірки гальмівного шляху: v² >= 2·a·залишок.
+// Найбільша швидкість — півкроку на тік: імпульс STEP триває один тік, пауза — не менше одного.
+//
+// Рух лише вперед (конвеєри). Налаштування і moveTo() — з loop() під noInterrupts(),
+// tick() — з переривання.
+class DdaRamp {
+public:
+    static const uint32_t MAX_VELOCITY = 0x80000000UL;
+
+    explicit DdaRamp(uint32_t tickHz) : tickHz_(tickHz) {}
+
+    void setMaxSpeed(uint32_t stepsPerS) {
+        vMax_ = perTick(stepsPerS);
+        if (vMax_ > MAX_VELOCITY) vMax_ = MAX_VELOCITY;
+    }
+
+    void setAcceleration(uint32_t stepsPerS2) {
+        accel_ = (uint32_t)(((uint64_t)stepsPerS2 << 32) / ((uint64_t)tickHz_ * tickHz_));
+        if (!accel_) accel_ = 1;
+        setDeceleration(accel_);
+    }
+
+    // Їхати до положення target і стати на ньому. Якщо з поточної швидкості прискоренням
+    // setAcceleration() зупинитись не встигаємо, гальмування на цій цілі різкіше —
+    // ціль не проїжджається. Ціль позаду — миттєва зупинка.
+    void moveTo(int32_t target) {
+        int32_t remaining = target - position_;
+        if (remaining <= 0) {
+            stop();
+            return;
+        }
+        target_ = target;
+        uint32_t v2 = velocitySquared();
+        setDeceleration(accel_);
+        if (needBrake((uint32_t)remaining, v2)) setDeceleration(v2 / (2 * (uint32_t)remaining) + 1);
+        braking_ = needBrake((uint32_t)remaining, v2);
+    }
+
+    void stop() {
+        velocity_ = 0;
+        phase_ = 0;
+        target_ = position_;
+        braking_ = false;
+    }
+
+    // Раз на тік. true — на цьому тіку зробити крок.
+    bool tick() {
+        if (target_ == position_) return false;
+        if (braking_) {
+            velocity_ = velocity_ > vFloor_ + decel_ ? velocity_ - decel_ : vFloor_;
+        } else if (velocity_ < vMax_) {
+            velocity_ = vMax_ - velocity_ > accel_ ? velocity_ + accel_ : vMax_;
+        } else if (velocity_ > vMax_) {
+            velocity_ = velocity_ - vMax_ > decel_ ? velocity_ - decel_ : vMax_;
+        }
+        uint32_t before = phase_;
+        phase_ += velocity_;
+        if (phase_ >= before) return false;
+
+        position_++;
+        int32_t remaining = target_ - position_;
+        if (remaining == 0) {
+            velocity_ = 0;
+            phase_ = 0;
+            braking_ = false;
+        } else {
+            braking_ = needBrake((uint32_t)remaining, velocitySquared());
+        }
+        return true;
+    }
+
+    int32_t position() const { return position_; }
+    bool isMoving() const { return target_ != position_; }
+
+    // Для звітів: кроків/с і кроків/с²
+    uint32_t speed() const { return (uint32_t)(((uint64_t)velocity_ * tickHz_) >> 32); }
+    uint32_t deceleration() const { return (uint32_t)(((uint64_t)decel_ * tickHz_ * tickHz_) >> 32); }
+
+private:
+    uint32_t tickHz_;
+    uint32_t vMax_ = 0;
+    uint32_t accel_ = 1;
+    uint32_t decel_ = 1;
+    uint32_t vFloor_ = 0;           // швидкість після першого кроку з місця: нижче гальмування не йде
+    uint32_t brakeHorizon_ = 0;     // далі за стільки кроків 2·a·залишок не вміщується в 32 біти
+    uint32_t velocity_ = 0;
+    uint32_t phase_ = 0;
+    int32_t position_ = 0;
+    int32_t target_ = 0;
+    bool braking_ = false;
+
+    uint32_t perTick(uint32_t stepsPerS) const { return (uint32_t)(((uint64_t)stepsPerS << 32) / tickHz_); }
+
+    void setDeceleration(uint32_t decel) {
+        if (decel > MAX_VELOCITY / 2) decel = MAX_VELOCITY / 2;
+        decel_ = decel;
+        vFloor_ = isqrt(2 * decel) << 16;
+        if (vFloor_ > MAX_VELOCITY) vFloor_ = MAX_VELOCITY;
+        brakeHorizon_ = 0xFFFFFFFFUL / (2 * decel);
+    }
+
+    // (кроків/тік)² у Q0.32; старших 16 біт швидкості досить — похибка в частках кроку
+    uint32_t velocitySquared() const {
+        uint16_t hi = velocity_ >> 16;
+        return (uint32_t)hi * hi;
+    }
+
+    bool needBrake(uint32_t remaining, uint32_t v2) const {
+        return remaining <= brakeHorizon_ && v2 >= 2 * decel_ * remaining;
+    }
+};
+
+} // namespace kin
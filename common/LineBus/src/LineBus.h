@@ -0,0 +1,329 @@
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+
+// Шина між контролерами лінії: короткі кадри по спільній лінії UART (RS-485, напівдуплекс).
+// Прошивки до неї ще не під'єднані (вільних UART немає — README.md); її прогоняє двійник лінії.
+//
+// Ведучий (адреса 0, конвеєр) опитує ведених за фіксованим розкладом: кожні pollPeriodMs —
+// один кадр POLL наступному веденому по колу. Ведений одразу відповідає кадром STATUS зі своїм
+// станом. У POLL ведучий передає стан станції, що стоїть перед опитуваною за потоком: свій —
+// малому конвеєру (1), останній отриманий від малого конвеєра — пакуванню (2). Так кожна
+// станція бачить, що відбувається перед нею, а не лише рівень на дроті.
+//
+// Відповідь, що не прийшла за replyTimeoutMs, — тайм-аут. Якщо вона приходить пізніше, її стан
+// зберігається, але рахується вона окремо як запізніла, а не як відповідь. Після тайм-ауту
+// наступне опитування чекає, поки лінія помовчить replyTimeoutMs: запізнілий ведений не
+// перебиває ведучого. Кадр, що саме приймається, теж відкладає опитування.
+//
+// Кадр: 0x7E, кому, від кого, тип, довжина, дані, CRC-8 (поліном 0x07) усього після 0x7E.
+// 0x7E усередині даних не заважає — довжина відома. Якщо після частини кадру лінія мовчить
+// довше за GAP_US, приймач скидається; кадр з неправильною CRC відкидається і рахується.
+//
+// Напрямок трансивера — пін DE: HIGH на час передачі кадру (flush() чекає останнього байта),
+// решту часу станція слухає. Для трансивера з автоматичним напрямком — NO_DE.
+// update() викликається з кожної ітерації loop() і не блокує, крім передачі власного кадру
+// (13 байтів, ~1.1 мс на 115200).
+
+namespace linebus {
+
+const uint8_t NO_DE = 255;            // трансивер з автоматичним напрямком
+const uint8_t MASTER = 0;
+const uint8_t MAX_STATIONS = 4;         // адреси 0..3
+const uint8_t SYNC = 0x7E;
+const uint8_t MAX_PAYLOAD = 8;
+const uint16_t GAP_US = 2000;           // пауза між байтами, що обриває кадр
+const uint16_t STALE_MS = 500;          // без звісток довше — станція офлайн
+
+enum FrameType : uint8_t {
+    POLL = 1,                           // ведучий → ведений: стан станції перед ним
+    STATUS = 2                          // ведений → ведучий: власний стан
+};
+
+// Біти StationStatus::flags
+enum Flag : uint8_t {
+    RUNNING = 0x01,                     // станція працює (не зупинена, не на паузі)
+    READY = 0x02,                       // продукт готовий для наступної станції
+    BUSY = 0x04,                        // станція посеред свого циклу
+    STALE = 0x80                        // ведучий давно не чув цю станцію, дані застарілі
+};
+
+const uint16_t ETA_UNKNOWN = 0xFFFF;
+
+} // namespace linebus
+
+struct StationStatus {
+    uint8_t state;          // стан автомата станції (свій enum у кожній прошивці)
+    uint8_t flags;          // linebus::Flag
+    uint16_t counter;       // готових одиниць від увімкнення (спайок, партій, пакетів), по модулю 65536
+    uint8_t incoming;       // скільки баночок / спайок іде до наступної станції
+    uint16_t etaMs;         // через скільки мс вони там будуть (ETA_UNKNOWN — невідомо)
+
+    static const uint8_t WIRE_SIZE = 7;
+
+    void write(uint8_t* p) const {
+        p[0] = state;
+        p[1] = flags;
+        p[2] = (uint8_t)counter;
+        p[3] = (uint8_t)(counter >> 8);
+        p[4] = incoming;
+        p[5] = (uint8_t)etaMs;
+        p[6] = (uint8_t)(etaMs >> 8);
+    }
+
+    void read(const uint8_t* p) {
+        state = p[0];
+        flags = p[1];
+        counter = (uint16_t)(p[2] | (p[3] << 8));
+        incoming = p[4];
+        etaMs = (uint16_t)(p[5] | (p[6] << 8));
+    }
+};
+
+class LineBus {
+public:
+    // port — HardwareSerial, вже відкритий з потрібною швидкістю
+    LineBus(HardwareSerial& port, uint8_t address, uint8_t dePin = linebus::NO_DE)
+        : serial(port), self(address), de(dePin) {}
+
+    // Ведучому — кількість ведених (адреси 1..slaves) і період опитування
+    void begin(uint8_t slaves = 0, uint16_t pollPeriodMs = 25, uint16_t replyTimeoutMs = 10) {
+        slaveCount = slaves < linebus::MAX_STATIONS ? slaves : linebus::MAX_STATIONS - 1;
+        periodMs = pollPeriodMs;
+        timeoutMs = replyTimeoutMs;
+        memset(stations, 0, sizeof(stations));
+        memset(links, 0, sizeof(links));
+        for (uint8_t i = 0; i < linebus::MAX_STATIONS; i++) stations[i].etaMs = linebus::ETA_UNKNOWN;
+        if (de != linebus::NO_DE) {
+            pinMode(de, OUTPUT);
+            digitalWrite(de, LOW);
+        }
+        lastPollMs = millis();
+    }
+
+    void update() {
+        receive();
+        if (self != linebus::MASTER || !slaveCount) return;
+        unsigned long now = millis();
+        if (awaiting && now - sentMs >= timeoutMs) timeout(now);
+        if (now - lastPollMs < periodMs) return;
+        if (awaiting) timeout(now);                 // тайм-аут довший за період опитування
+        if (rxSynced) return;                       // лінію зайнято кадром — опитаємо після нього
+        if (guarding) {
+            if (now - guardFromMs < timeoutMs || now - rxMs < timeoutMs) return;
+            guarding = false;
+            lastPollMs = now;                       // розклад далі — від цього опитування
+        } else {
+            // Розклад від попереднього опитування, а не від моменту виклику; після довгої
+            // ітерації loop() — від поточного моменту, без серії опитувань навздогін
+            lastPollMs = now - lastPollMs < 2u * periodMs ? lastPollMs + periodMs : now;
+        }
+        nextSlave = nextSlave % slaveCount + 1;
+        poll(nextSlave);
+    }
+
+    // Стан цієї станції, який вона публікує (заповнює прошивка)
+    StationStatus& local() { return stations[self]; }
+
+    // Останній відомий стан станції: ведучому — будь-якої, веденому — станції перед ним
+    const StationStatus& station(uint8_t address) const { return stations[address % linebus::MAX_STATIONS]; }
+    // Станція перед цією за потоком (для веденого — те, що передав ведучий)
+    const StationStatus& upstream() const { return station(self ? self - 1 : 0); }
+
+    // Дані станції свіжі: відповідь (ведучому) або опитування (веденому) не давніше STALE_MS
+    bool online(uint8_t address) const {
+        if (address == self) return true;
+        const Link& l = links[address % linebus::MAX_STATIONS];
+        return l.heard && millis() - l.heardMs < linebus::STALE_MS;
+    }
+    bool upstreamOnline() const {
+        if (!self) return true;
+        return online(self - 1) && !(upstream().flags & linebus::STALE);
+    }
+
+    void printStats(Print& out) const {
+        out.print(F("Line bus: station "));
+        out.print(self);
+        out.print(self == linebus::MASTER ? F(" (master), ") : F(", "));
+        out.print(frames);
+        out.print(F(" frames, "));
+        out.print(crcErrors);
+        out.println(F(" CRC errors"));
+        for (uint8_t a = 0; a < linebus::MAX_STATIONS; a++) {
+            if (a == self || (self == linebus::MASTER ? a > slaveCount : a != self - 1)) continue;
+            const StationStatus& s = stations[a];
+            const Link& l = links[a];
+            out.print('#');
+            out.print(a);
+            out.print(online(a) ? F(" online") : F(" offline"));
+            out.print(F(" state "));
+            out.print(s.state);
+            out.print(F(" flags "));
+            out.print(s.flags & linebus::RUNNING ? 'R' : '-');
+            out.print(s.flags & linebus::READY ? 'Y' : '-');
+            out.print(s.flags & linebus::BUSY ? 'B' : '-');
+            out.print(s.flags & linebus::STALE ? 'S' : '-');
+            out.print(F(" counter "));
+            out.print(s.counter);
+            out.print(F(" incoming "));
+            out.print(s.incoming);
+            if (s.etaMs != linebus::ETA_UNKNOWN) {
+                out.print(F(" in "));
+                out.print(s.etaMs);
+                out.print(F(" ms"));
+            }
+            if (self == linebus::MASTER) {
+                out.print(F("; polls "));
+                out.print(l.polls);
+                out.print(F(" replies "));
+                out.print(l.replies);
+                out.print(F(" timeouts "));
+                out.print(l.timeouts);
+                out.print(F(" (late "));
+                out.print(l.late);
+                out.print(')');
+            }
+            out.println();
+        }
+    }
+
+private:
+    // polls = replies + timeouts (+1, поки чекаємо відповідь); late — частина timeouts
+    struct Link {
+        uint32_t polls;
+        uint32_t replies;
+        uint32_t timeouts;
+        uint32_t late;                  // відповідь прийшла вже після тайм-ауту
+        bool heard;
+        unsigned long heardMs;
+    };
+
+    HardwareSerial& serial;
+    uint8_t self;
+    uint8_t de;
+    uint8_t slaveCount = 0;
+    uint16_t periodMs = 25;
+    uint16_t timeoutMs = 10;
+
+    StationStatus stations[linebus::MAX_STATIONS];
+    Link links[linebus::MAX_STATIONS];
+    uint16_t frames = 0;
+    uint16_t crcErrors = 0;
+
+    // Ведучий
+    unsigned long lastPollMs = 0;
+    unsigned long sentMs = 0;
+    uint8_t nextSlave = 0;
+    uint8_t awaiting = 0;               // від кого чекаємо відповідь (0 — ні від кого)
+    bool guarding = false;              // після тайм-ауту: чекаємо тиші на лінії
+    unsigned long guardFromMs = 0;
+    unsigned long rxMs = 0;             // останній байт з лінії
+
+    // Приймач: заголовок (кому, від кого, тип, довжина), дані, CRC
+    uint8_t rx[4 + linebus::MAX_PAYLOAD + 1];
+    uint8_t rxLength = 0;               // 0 — чекаємо SYNC
+    bool rxSynced = false;
+    unsigned long rxByteUs = 0;
+
+    static uint8_t crc8(const uint8_t* p, uint8_t length) {
+        uint8_t crc = 0;
+        while (length--) {
+            crc ^= *p++;
+            for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+    void send(uint8_t to, uint8_t type, const StationStatus& s) {
+        uint8_t frame[1 + 4 + StationStatus::WIRE_SIZE + 1];
+        frame[0] = linebus::SYNC;
+        frame[1] = to;
+        frame[2] = self;
+        frame[3] = type;
+        frame[4] = StationStatus::WIRE_SIZE;
+        s.write(frame + 5);
+        frame[sizeof(frame) - 1] = crc8(frame + 1, sizeof(frame) - 2);
+        // Усе, що ще в буфері порту, має піти до DE
+        serial.flush();
+        if (de != linebus::NO_DE) digitalWrite(de, HIGH);
+        serial.write(frame, sizeof(frame));
+        serial.flush();
+        if (de != linebus::NO_DE) digitalWrite(de, LOW);
+    }
+
+    void poll(uint8_t slave) {
+        // Станція перед опитуваною; застарілі дані позначаються, а не замовчуються
+        StationStatus up = stations[slave - 1];
+        if (slave - 1 != self && !online(slave - 1)) up.flags |= linebus::STALE;
+        links[slave].polls++;
+        awaiting = slave;
+        send(slave, linebus::POLL, up);
+        sentMs = millis();
+    }
+
+    void receive() {
+        // Пауза рахується, лише поки буфер порожній: байти, що чекали в буфері під час довгої
+        // ітерації loop(), прийшли без паузи
+        if (!serial.available()) {
+            if (rxSynced && micros() - rxByteUs > linebus::GAP_US) rxSynced = false;   // обірваний кадр
+            return;
+        }
+        while (serial.available()) {
+            uint8_t b = (uint8_t)serial.read();
+            rxByteUs = micros();
+            rxMs = millis();
+            if (!rxSynced) {
+                if (b == linebus::SYNC) {
+                    rxSynced = true;
+                    rxLength = 0;
+                }
+                continue;
+            }
+            rx[rxLength++] = b;
+            if (rxLength == 4 && rx[3] > linebus::MAX_PAYLOAD) {
+                rxSynced = false;       // не наш кадр або шум
+                continue;
+            }
+            if (rxLength < 4 || rxLength < 4 + rx[3] + 1) continue;
+            rxSynced = false;
+            if (crc8(rx, rxLength - 1) != rx[rxLength - 1]) {
+                crcErrors++;
+                continue;
+            }
+            frames++;
+            handle(rx[0], rx[1], rx[2], rx + 4, rx[3]);
+        }
+    }
+
+    void handle(uint8_t to, uint8_t from, uint8_t type, const uint8_t* data, uint8_t length) {
+        if (to != self || from >= linebus::MAX_STATIONS || length != StationStatus::WIRE_SIZE) return;
+        if (self == linebus::MASTER && type == linebus::STATUS) {
+            // Стан свіжий і в запізнілій відповіді, але відповіддю на опитування вона не є
+            stations[from].read(data);
+            heard(from);
+            if (awaiting == from) {
+                links[from].replies++;
+                awaiting = 0;
+            } else {
+                links[from].late++;
+            }
+        } else if (self != linebus::MASTER && type == linebus::POLL && from == linebus::MASTER) {
+            stations[self - 1].read(data);
+            heard(self - 1);
+            heard(linebus::MASTER);
+            send(linebus::MASTER, linebus::STATUS, stations[self]);
+        }
+    }
+
+    void timeout(unsigned long now) {
+        links[awaiting].timeouts++;
+        awaiting = 0;
+        guarding = true;
+        guardFromMs = now;
+    }
+
+    void heard(uint8_t address) {
+        links[address].heard = true;
+        links[address].heardMs = millis();
+    }
+};
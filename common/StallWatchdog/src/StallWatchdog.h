@@ -0,0 +1,183 @@
+#pragma once
+#include <Arduino.h>
+#include <stddef.h>
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#endif
+
+// Сторожовий таймер зависань loop() — спільний для всіх трьох прошивок.
+//
+// Прошивка викликає StallWatchdog::kick(...) з кожної ітерації loop() і передає свої стани
+// (до трьох байтів: стан автомата, крок послідовності тощо). Апаратний WDT працює в режимі
+// «переривання, потім скидання» з періодом 16 мс: переривання рахує періоди без kick(), а коли
+// їх набігає на stallBudgetMs, записує звіт у .noinit RAM і більше не перезаводить WDT —
+// наступний період скидає плату. Якщо цикл завис із забороненими перериваннями, звіту не буде,
+// але плата так само скинеться через 16-32 мс.
+//
+// Після перезапуску begin() знаходить звіт у .noinit, переносить його в EEPROM (переживає
+// вимкнення живлення, лічильник зависань продовжується) і повертає true — тоді прошивка
+// друкує його через printReport(). У звіті: стани з останнього kick(), тривалість
+// попередньої ітерації, скільки тривало зависання і час від увімкнення.
+//
+// Бюджет має бути більшим за найдовшу законну ітерацію (друк відповіді на команду Serial).
+// Там, де ітерація законно чекає довше (друк великого звіту в повільний порт), прошивка
+// викликає feed() з циклу очікування — бюджет рахується заново від кожного виклику.
+// На ПК (ArduinoNative) WDT немає: kick() лише запам'ятовує стан, begin() повертає false.
+
+struct StallReport {
+    uint16_t magic;
+    uint16_t count;             // номер зависання (з EEPROM)
+    uint8_t state[3];           // стани з останнього kick()
+    uint32_t lastLoopUs;        // остання завершена ітерація loop()
+    uint32_t stalledMs;         // від останнього kick() до рішення сторожа
+    uint32_t uptimeMs;          // millis() у момент зависання
+    uint8_t crc;                // CRC усіх попередніх полів
+};
+
+namespace stallwatchdog {
+
+const uint16_t MAGIC = 0x57D7;
+const uint8_t TICK_MS = 16;     // період WDTO_15MS (128 кГц / 2048)
+
+static volatile uint8_t ticks = 0;
+static uint8_t budgetTicks = 0xFF;
+static volatile uint8_t state[3] = {0, 0, 0};
+static volatile uint32_t lastLoopUs = 0;
+static volatile uint32_t lastKickUs = 0;
+static StallReport saved;       // звіт з EEPROM після begin()
+
+#if defined(__AVR__)
+// Переживає скидання (не ініціалізується при старті); після вимкнення живлення — сміття,
+// тому magic і CRC
+static StallReport pending __attribute__((section(".noinit")));
+
+// Після скидання сторожем WDT лишається ввімкненим з найкоротшим періодом: вимикаємо його
+// ще до ініціалізації C++ і setup(), інакше плата скидалася б знову й знову
+static void disableAfterReset() __attribute__((naked, used, section(".init3")));
+static void disableAfterReset() {
+    MCUSR = 0;
+    wdt_disable();
+}
+#else
+static StallReport pending;
+#endif
+
+inline uint8_t crc8(const void* data, uint8_t length) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint8_t crc = 0;
+    while (length--) {
+        crc ^= *p++;
+        for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+inline bool valid(const StallReport& r) {
+    return r.magic == MAGIC && r.crc == crc8(&r, offsetof(StallReport, crc));
+}
+
+} // namespace stallwatchdog
+
+class StallWatchdog {
+public:
+    // Наприкінці setup(): stallBudgetMs — найдовша допустима ітерація loop(),
+    // eepromAddress — місце звіту (sizeof(StallReport) байтів).
+    // true — попередній запуск закінчився зависанням, звіт готовий для printReport().
+    static bool begin(uint16_t stallBudgetMs, uint16_t eepromAddress) {
+        using namespace stallwatchdog;
+        uint16_t budget = stallBudgetMs / TICK_MS + 2;     // +1 — фаза WDT відносно kick()
+        budgetTicks = budget > 0xFF ? 0xFF : (uint8_t)budget;
+        lastKickUs = micros();
+        bool stalled = false;
+#if defined(__AVR__)
+        StallReport* address = (StallReport*)(uintptr_t)eepromAddress;
+        eeprom_read_block(&saved, address, sizeof(saved));
+        uint16_t count = valid(saved) ? saved.count : 0;
+        if (valid(pending)) {
+            saved = pending;
+            saved.count = count + 1;
+            saved.crc = crc8(&saved, offsetof(StallReport, crc));
+            eeprom_update_block(&saved, address, sizeof(saved));
+            stalled = true;
+        }
+        pending.magic = 0;
+
+        noInterrupts();
+        wdt_reset();
+        WDTCSR = _BV(WDCE) | _BV(WDE);
+        WDTCSR = _BV(WDIE) | _BV(WDE);                     // переривання + скидання, 16 мс
+        interrupts();
+#else
+        (void)eepromAddress;
+#endif
+        return stalled;
+    }
+
+    // З кожної ітерації loop()
+    static void kick(uint8_t s0, uint8_t s1 = 0, uint8_t s2 = 0) {
+        using namespace stallwatchdog;
+        unsigned long now = micros();
+#if defined(__AVR__)
+        uint8_t sreg = SREG;
+        noInterrupts();
+#endif
+        ticks = 0;
+        state[0] = s0;
+        state[1] = s1;
+        state[2] = s2;
+        lastLoopUs = now - lastKickUs;
+        lastKickUs = now;
+#if defined(__AVR__)
+        SREG = sreg;
+#endif
+    }
+
+    // Посеред довгої законної операції: відкласти скидання ще на stallBudgetMs, не змінюючи
+    // станів. stalledMs у звіті однаково рахується від останнього kick()
+    static void feed() {
+        stallwatchdog::ticks = 0;                          // один байт — запис атомарний
+    }
+
+    static void printReport(Print& out) {
+        const StallReport& r = stallwatchdog::saved;
+        out.print(F("Watchdog reset #"));
+        out.print(r.count);
+        out.print(F(": loop stalled for "));
+        out.print(r.stalledMs);
+        out.print(F(" ms at uptime "));
+        out.print(r.uptimeMs / 1000);
+        out.print(F(" s, states "));
+        out.print(r.state[0]);
+        out.print('/');
+        out.print(r.state[1]);
+        out.print('/');
+        out.print(r.state[2]);
+        out.print(F(", previous loop "));
+        out.print(r.lastLoopUs);
+        out.println(F(" us"));
+    }
+
+    // З переривання WDT
+    static void onTick() {
+        using namespace stallwatchdog;
+        if (++ticks < budgetTicks) {
+#if defined(__AVR__)
+            WDTCSR |= _BV(WDIE);                           // наступний період — знову переривання
+#endif
+            return;
+        }
+        // Звіт і скидання: WDIE не відновлюємо, наступний період WDT скидає плату
+        pending.count = 0;
+        for (uint8_t i = 0; i < 3; i++) pending.state[i] = state[i];
+        pending.lastLoopUs = lastLoopUs;
+        pending.stalledMs = (micros() - lastKickUs) / 1000;
+        pending.uptimeMs = millis();
+        pending.magic = MAGIC;
+        pending.crc = crc8(&pending, offsetof(StallReport, crc));
+    }
+};
+
+#if defined(__AVR__)
+ISR(WDT_vect) { StallWatchdog::onTick(); }
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+// Адреса функції в ELF прошивки AVR (ELF32, little-endian) за назвою — без libelf.
+// Ім'я C++ без аргументів шукається і в скаліченому вигляді: loop → _Z4loopv.
+
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+class ElfSymbols {
+public:
+    // false — файл не ELF32 або символу немає
+    static bool find(const char* path, const std::string& name, uint32_t& address) {
+        std::vector<uint8_t> image;
+        if (!load(path, image) || image.size() < sizeof(Elf32_Ehdr)) return false;
+        const Elf32_Ehdr* eh = (const Elf32_Ehdr*)image.data();
+        if (memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 || eh->e_ident[EI_CLASS] != ELFCLASS32) return false;
+        if ((size_t)eh->e_shoff + (size_t)eh->e_shnum * sizeof(Elf32_Shdr) > image.size()) return false;
+
+        const std::string mangled = "_Z" + std::to_string(name.size()) + name + "v";
+        const Elf32_Shdr* sections = (const Elf32_Shdr*)(image.data() + eh->e_shoff);
+        for (unsigned s = 0; s < eh->e_shnum; s++) {
+            const Elf32_Shdr& symtab = sections[s];
+            if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= eh->e_shnum) continue;
+            const Elf32_Shdr& strtab = sections[symtab.sh_link];
+            if (symtab.sh_offset + symtab.sh_size > image.size() || strtab.sh_offset + strtab.sh_size > image.size()) {
+                return false;
+            }
+            const Elf32_Sym* syms = (const Elf32_Sym*)(image.data() + symtab.sh_offset);
+            const char* strings = (const char*)image.data() + strtab.sh_offset;
+            for (size_t i = 0; i < symtab.sh_size / sizeof(Elf32_Sym); i++) {
+                if (ELF32_ST_TYPE(syms[i].st_info) != STT_FUNC || syms[i].st_name >= strtab.sh_size) continue;
+                const char* sym = strings + syms[i].st_name;
+                if (name == sym || mangled == sym) {
+                    address = syms[i].st_value;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    static bool load(const char* path, std::vector<uint8_t>& image) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) image.insert(image.end(), buf, buf + n);
+        fclose(f);
+        return true;
+    }
+};
@@ -0,0 +1,231 @@
+// Вимірювання прошивок на справжньому наборі інструкцій AVR: ELF зі збірки PlatformIO
+// (megaatmega2560, uno) виконується під simavr такт у такт, зі стимулами на входах зі сценарію.
+//
+//   avr_bench SCENARIO [--elf FILE] [--ms N] [--vcd FILE]
+//
+//   SCENARIO      файл сценарію (scenario.h, приклади — у scenarios/)
+//   --elf FILE    інший ELF замість указаного в сценарії (порівняти дві збірки)
+//   --ms N        інша тривалість прогону
+//   --vcd FILE    часова діаграма пінів STEP, датчиків і watch (GTKWave)
+//
+// Звіт:
+//  - loop(): кількість ітерацій, середній і найдовший період — від входу у функцію loop-symbol
+//    до наступного входу, разом з обслуговуванням Serial ядром Arduino;
+//  - STEP: кроки, період (мін/медіана/макс у рухах) і джитер — різниця сусідніх періодів;
+//  - датчик → зупинка: від активного фронту до останнього кроку перед паузою stop-gap,
+//    і скільки кроків конвеєр зробив після фронту;
+//  - isr: від фронту датчика до входу в обробник (адреса вектора в таблиці переривань).
+
+#include "elf_symbols.h"
+#include "metrics.h"
+#include "scenario.h"
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_vcd_file.h>
+#include <simavr/avr_ioport.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint32_t F_CPU_HZ = 16000000;
+const double CYCLES_PER_US = F_CPU_HZ / 1e6;
+const uint32_t VECTOR_BYTES = 4;            // jmp — два слова на вектор (ATmega2560 і ATmega328P)
+
+struct PinProbe {
+    std::vector<uint64_t>* rising;          // моменти переходу в 1 (лише для STEP)
+    avr_t* avr;
+    uint32_t changes = 0;
+    bool level = false;
+};
+
+void onPinChange(avr_irq_t*, uint32_t value, void* param) {
+    PinProbe* p = (PinProbe*)param;
+    bool level = value != 0;
+    if (level == p->level) return;
+    p->level = level;
+    p->changes++;
+    if (level && p->rising) p->rising->push_back(p->avr->cycle);
+}
+
+void usage(const char* prog) {
+    fprintf(stderr, "usage: %s SCENARIO [--elf FILE] [--ms N] [--vcd FILE]\n", prog);
+}
+
+double us(double cycles) { return cycles / CYCLES_PER_US; }
+double seconds(uint64_t cycle) { return cycle / (double)F_CPU_HZ; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* scenarioPath = nullptr;
+    const char* elfOverride = nullptr;
+    const char* vcdPath = nullptr;
+    uint64_t msOverride = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--elf" && hasValue) {
+            elfOverride = argv[++i];
+        } else if (a == "--ms" && hasValue) {
+            msOverride = strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--vcd" && hasValue) {
+            vcdPath = argv[++i];
+        } else if (!scenarioPath && a[0] != '-') {
+            scenarioPath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!scenarioPath) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Scenario sc;
+    std::string error;
+    if (!ScenarioParser::parse(scenarioPath, sc, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+    if (elfOverride) sc.elf = elfOverride;
+    if (msOverride) sc.ms = msOverride;
+
+    elf_firmware_t fw;
+    memset(&fw, 0, sizeof(fw));
+    if (sc.elf.empty() || elf_read_firmware(sc.elf.c_str(), &fw) != 0) {
+        fprintf(stderr, "cannot load %s (build it first: pio run)\n", sc.elf.c_str());
+        return 2;
+    }
+    // ELF з PlatformIO не має секції .mmcu — плату й частоту задає сценарій
+    strncpy(fw.mmcu, sc.mcu.c_str(), sizeof(fw.mmcu) - 1);
+    fw.frequency = F_CPU_HZ;
+
+    avr_t* avr = avr_make_mcu_by_name(fw.mmcu);
+    if (!avr) {
+        fprintf(stderr, "simavr does not know %s\n", fw.mmcu);
+        return 2;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &fw);
+    avr->frequency = F_CPU_HZ;
+
+    uint32_t loopAddress = 0;
+    bool haveLoop = ElfSymbols::find(sc.elf.c_str(), sc.loopSymbol, loopAddress);
+    if (!haveLoop) {
+        fprintf(stderr, "warning: no function %s in %s - loop() period is not measured\n", sc.loopSymbol.c_str(),
+                sc.elf.c_str());
+    }
+
+    auto pinIrq = [&](uint8_t pin) -> avr_irq_t* {
+        PortBit pb;
+        if (!sc.portBit(pin, pb)) {
+            fprintf(stderr, "pin %u does not exist on %s\n", pin, sc.mcu.c_str());
+            exit(2);
+        }
+        return avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(pb.port), pb.bit);
+    };
+
+    avr_vcd_t vcd;
+    if (vcdPath) avr_vcd_init(avr, vcdPath, &vcd, 10000);
+
+    // Вимірювані піни: STEP, датчики (їхні фронти — зі стимулів), watch
+    std::vector<uint64_t> steps;
+    std::vector<PinProbe> probes(sc.watched.size() + 1);
+    if (sc.stepPin >= 0) {
+        probes[0] = {&steps, avr};
+        avr_irq_t* irq = pinIrq((uint8_t)sc.stepPin);
+        avr_irq_register_notify(irq, onPinChange, &probes[0]);
+        if (vcdPath) avr_vcd_add_signal(&vcd, irq, 1, "STEP");
+    }
+    for (size_t i = 0; i < sc.watched.size(); i++) {
+        probes[i + 1] = {nullptr, avr};
+        avr_irq_t* irq = pinIrq(sc.watched[i].pin);
+        avr_irq_register_notify(irq, onPinChange, &probes[i + 1]);
+        if (vcdPath) avr_vcd_add_signal(&vcd, irq, 1, sc.watched[i].name.c_str());
+    }
+    std::vector<std::vector<uint64_t>> sensorEdges(sc.sensors.size());
+    for (const NamedPin& s : sc.sensors) {
+        if (vcdPath) avr_vcd_add_signal(&vcd, pinIrq(s.pin), 1, s.name.c_str());
+    }
+    if (vcdPath) avr_vcd_start(&vcd);
+
+    std::vector<std::vector<uint64_t>> vectorEntries(sc.vectors.size());
+    std::vector<uint64_t> loopEntries;
+    const uint64_t endCycle = sc.ms * (F_CPU_HZ / 1000);
+    size_t next = 0;
+    int state = cpu_Running;
+
+    auto h0 = std::chrono::steady_clock::now();
+    while (avr->cycle < endCycle && state != cpu_Done && state != cpu_Crashed) {
+        while (next < sc.stimuli.size() && sc.stimuli[next].atUs * CYCLES_PER_US <= avr->cycle) {
+            const Stimulus& st = sc.stimuli[next++];
+            avr_raise_irq(pinIrq(st.pin), st.level);
+            for (size_t i = 0; i < sc.sensors.size(); i++) {
+                if (sc.sensors[i].pin == st.pin && sc.sensors[i].activeLevel == st.level) {
+                    sensorEdges[i].push_back(avr->cycle);
+                }
+            }
+        }
+        state = avr_run(avr);
+        // Після інструкції pc — наступна: вхід у loop() або в обробник переривання
+        if (haveLoop && avr->pc == loopAddress) loopEntries.push_back(avr->cycle);
+        for (size_t v = 0; v < sc.vectors.size(); v++) {
+            if (avr->pc == sc.vectors[v].first * VECTOR_BYTES) vectorEntries[v].push_back(avr->cycle);
+        }
+    }
+    double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - h0).count();
+    if (vcdPath) avr_vcd_stop(&vcd);
+
+    printf("=== avr_bench: %s (%s, %.3f s, %llu cycles, %.1f s on PC) ===\n", sc.elf.c_str(), sc.mcu.c_str(),
+           seconds(avr->cycle), (unsigned long long)avr->cycle, hostSeconds);
+    if (state == cpu_Crashed) printf("CPU crashed at pc 0x%05x\n", (unsigned)avr->pc);
+
+    if (haveLoop) {
+        Summary loop = intervals(loopEntries);
+        printf("loop(): %u iterations, mean %.1f us, worst %.1f us at %.3f s\n", loop.count, us(loop.mean),
+               us(loop.max), seconds(loop.maxAt));
+    }
+
+    uint64_t gap = (uint64_t)(sc.stopGapMs * 1000 * CYCLES_PER_US);
+    if (sc.stepPin >= 0) {
+        StepStats st = stepStats(steps, gap);
+        printf("STEP (pin %d): %u steps, period min %.1f / median %.1f / max %.1f us\n", sc.stepPin, st.steps,
+               us(st.minPeriod), us(st.medianPeriod), us(st.maxPeriod));
+        printf("  jitter (period to period): mean %.2f us, worst %.2f us at %.3f s\n", us(st.jitter.mean),
+               us(st.jitter.max), seconds(st.jitter.maxAt));
+    }
+
+    for (size_t i = 0; i < sc.sensors.size(); i++) {
+        const NamedPin& s = sc.sensors[i];
+        if (sc.stepPin >= 0) {
+            StopLatency l = stopLatency(sensorEdges[i], steps, gap, avr->cycle);
+            printf("%s -> stop: %u edges while moving", s.name.c_str(), l.cycles.count);
+            if (l.cycles.count) {
+                printf(", latency mean %.2f ms, worst %.2f ms at %.3f s; steps after edge mean %.1f, max %.0f",
+                       us(l.cycles.mean) / 1000, us(l.cycles.max) / 1000, seconds(l.cycles.maxAt), l.steps.mean,
+                       l.steps.max);
+            }
+            printf(" (%u while stopped, %u not stopped by the end)\n", l.idleEdges, l.unfinished);
+        }
+        for (size_t v = 0; v < sc.vectors.size(); v++) {
+            Summary isr = latencyTo(sensorEdges[i], vectorEntries[v]);
+            printf("%s -> %s: %u edges, latency mean %.2f us, worst %.2f us (%.0f cycles)\n", s.name.c_str(),
+                   sc.vectors[v].second.c_str(), isr.count, us(isr.mean), us(isr.max), isr.max);
+        }
+    }
+
+    for (size_t i = 0; i < sc.watched.size(); i++) {
+        printf("%s (pin %u): %u changes\n", sc.watched[i].name.c_str(), sc.watched[i].pin, probes[i + 1].changes);
+    }
+    if (vcdPath) printf("VCD: %s\n", vcdPath);
+    return state == cpu_Crashed ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+// Обробка моментів подій (у тактах CPU), знятих під simavr: період loop(), період і джитер
+// кроків, затримка від фронту датчика до зупинки конвеєра і до входу в обробник переривання.
+// Без simavr — лише вектори моментів, тож однаково рахується для будь-якої прошивки.
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+struct Summary {
+    unsigned count = 0;
+    double mean = 0;
+    double max = 0;
+    uint64_t maxAt = 0;             // такт, на якому найбільше значення
+
+    void add(double v, uint64_t at) {
+        mean += (v - mean) / ++count;
+        if (count == 1 || v > max) {
+            max = v;
+            maxAt = at;
+        }
+    }
+};
+
+// Інтервали між послідовними моментами (період loop())
+inline Summary intervals(const std::vector<uint64_t>& at) {
+    Summary s;
+    for (size_t i = 1; i < at.size(); i++) s.add((double)(at[i] - at[i - 1]), at[i - 1]);
+    return s;
+}
+
+struct StepStats {
+    unsigned steps = 0;
+    double minPeriod = 0, medianPeriod = 0, maxPeriod = 0;   // без пауз між рухами
+    Summary jitter;                 // |період - попередній період| в межах одного руху
+};
+
+// Кроки розбиваються на рухи паузами, довшими за gap; у русі розгін і гальмування міняють
+// період плавно, тож різниця сусідніх періодів показує саме нерівномірність імпульсів
+inline StepStats stepStats(const std::vector<uint64_t>& rising, uint64_t gap) {
+    StepStats st;
+    st.steps = (unsigned)rising.size();
+    std::vector<uint64_t> periods;
+    uint64_t previous = 0;
+    for (size_t i = 1; i < rising.size(); i++) {
+        uint64_t p = rising[i] - rising[i - 1];
+        if (p > gap) {
+            previous = 0;
+            continue;
+        }
+        periods.push_back(p);
+        if (previous) st.jitter.add((double)(p > previous ? p - previous : previous - p), rising[i - 1]);
+        previous = p;
+    }
+    if (!periods.empty()) {
+        std::sort(periods.begin(), periods.end());
+        st.minPeriod = (double)periods.front();
+        st.medianPeriod = (double)periods[periods.size() / 2];
+        st.maxPeriod = (double)periods.back();
+    }
+    return st;
+}
+
+struct StopLatency {
+    Summary cycles;                 // від фронту до останнього кроку перед паузою
+    Summary steps;                  // кроків після фронту
+    unsigned idleEdges = 0;         // фронти, коли конвеєр стояв
+    unsigned unfinished = 0;        // прогін закінчився раніше, ніж конвеєр зупинився
+};
+
+// Для кожного активного фронту датчика, на якому конвеєр їхав (крок не раніше ніж за gap):
+// останній крок перед першою паузою, довшою за gap. end — такт кінця прогону
+inline StopLatency stopLatency(const std::vector<uint64_t>& edges, const std::vector<uint64_t>& rising, uint64_t gap,
+                               uint64_t end) {
+    StopLatency r;
+    for (uint64_t e : edges) {
+        size_t i = std::lower_bound(rising.begin(), rising.end(), e) - rising.begin();
+        if (i == 0 || e - rising[i - 1] > gap) {
+            r.idleEdges++;
+            continue;
+        }
+        if (i == rising.size()) {
+            r.idleEdges++;          // останній крок був ще до фронту
+            continue;
+        }
+        size_t last = i;
+        while (last + 1 < rising.size() && rising[last + 1] - rising[last] <= gap) last++;
+        if (last + 1 == rising.size() && end - rising[last] <= gap) {
+            r.unfinished++;
+            continue;
+        }
+        r.cycles.add((double)(rising[last] - e), e);
+        r.steps.add((double)(last - i + 1), e);
+    }
+    return r;
+}
+
+// Від кожного фронту до першого входу в обробник не раніше за фронт
+inline Summary latencyTo(const std::vector<uint64_t>& edges, const std::vector<uint64_t>& entries) {
+    Summary s;
+    for (uint64_t e : edges) {
+        auto it = std::lower_bound(entries.begin(), entries.end(), e);
+        if (it != entries.end()) s.add((double)(*it - e), e);
+    }
+    return s;
+}
@@ -0,0 +1,180 @@
+#pragma once
+// Сценарій прогону прошивки під simavr: плата, ELF, тривалість, піни для вимірювань
+// і стимули на входах. Текстовий файл, рядок — одна директива, '#' — коментар:
+//
+//   mcu atmega2560                  atmega2560 (Mega) або atmega328p (Uno)
+//   elf PATH                        ELF прошивки (відносно файлу сценарію; з пробілами — в лапках)
+//   ms N                            скільки мілісекунд симулювати
+//   loop-symbol NAME                функція, вхід у яку — початок ітерації (loop)
+//   step PIN                        пін STEP: період і джитер кроків, зупинки після датчиків
+//   stop-gap MS                     стільки мс без кроків — конвеєр стоїть (20)
+//   sensor PIN LEVEL [NAME]         датчик і його активний рівень: затримка «фронт → зупинка»
+//   isr VECTOR [NAME]               номер вектора: затримка «фронт датчика → вхід в обробник»
+//   watch PIN NAME                  ще один пін у VCD (клапани, сигнали)
+//   at MS PIN LEVEL                 у момент MS подати рівень на вхід
+//   pulse MS PIN LEVEL WIDTH [COUNT PERIOD]
+//                                   імпульс рівня LEVEL на WIDTH мс; COUNT разів через PERIOD мс
+//
+// Піни — номери Arduino; порт і біт — з таблиць variants/mega і variants/standard.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct PortBit {
+    char port;
+    uint8_t bit;
+};
+
+struct NamedPin {
+    uint8_t pin;
+    std::string name;
+    bool activeLevel;               // лише для датчиків
+};
+
+struct Stimulus {
+    uint64_t atUs;
+    uint8_t pin;
+    bool level;
+};
+
+struct Scenario {
+    std::string mcu = "atmega2560";
+    std::string elf;
+    uint64_t ms = 10000;
+    std::string loopSymbol = "loop";
+    int stepPin = -1;
+    double stopGapMs = 20;
+    std::vector<NamedPin> sensors;
+    std::vector<NamedPin> watched;
+    std::vector<std::pair<int, std::string>> vectors;
+    std::vector<Stimulus> stimuli;  // відсортовані за часом
+
+    // Порт і біт піна Arduino на цій платі; false — такого піна немає
+    bool portBit(uint8_t pin, PortBit& pb) const {
+        // variants/mega/pins_arduino.h (так само, як fastgpio у 1.conveyor)
+        static const char MEGA_PORT[] = "EEEEGEHHHHBBBBJJHHDDDDAAAAAAAACCCCCCCCDGGGLLLLLLLLBBBBFFFFFFFFKKKKKKKK";
+        static const uint8_t MEGA_BIT[] = {0, 1, 4, 5, 5, 3, 3, 4, 5, 6, 4, 5, 6, 7, 1, 0, 1, 0, 3, 2,
+                                           1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 7, 6, 5, 4, 3, 2, 1, 0, 7, 2,
+                                           1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5,
+                                           6, 7, 0, 1, 2, 3, 4, 5, 6, 7};
+        if (mcu == "atmega2560") {
+            if (pin >= sizeof(MEGA_BIT)) return false;
+            pb = {MEGA_PORT[pin], MEGA_BIT[pin]};
+            return true;
+        }
+        // variants/standard: 0-7 — PD, 8-13 — PB, 14-19 (A0-A5) — PC
+        if (pin < 8) {
+            pb = {'D', pin};
+        } else if (pin < 14) {
+            pb = {'B', (uint8_t)(pin - 8)};
+        } else if (pin < 20) {
+            pb = {'C', (uint8_t)(pin - 14)};
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+class ScenarioParser {
+public:
+    // false — помилка (error: файл і рядок)
+    static bool parse(const char* path, Scenario& s, std::string& error) {
+        FILE* f = fopen(path, "r");
+        if (!f) {
+            error = std::string("cannot open ") + path;
+            return false;
+        }
+        std::string dir(path);
+        size_t slash = dir.rfind('/');
+        dir = slash == std::string::npos ? "" : dir.substr(0, slash + 1);
+
+        char buf[256];
+        unsigned lineNo = 0;
+        bool ok = true;
+        while (ok && fgets(buf, sizeof(buf), f)) {
+            lineNo++;
+            char* hash = strchr(buf, '#');
+            if (hash) *hash = 0;
+            std::vector<std::string> w = split(buf);
+            if (w.empty()) continue;
+            ok = directive(w, dir, s);
+            if (!ok) error = std::string(path) + ":" + std::to_string(lineNo) + ": cannot parse \"" + w[0] + "\" line";
+        }
+        fclose(f);
+        if (ok && s.mcu != "atmega2560" && s.mcu != "atmega328p") {
+            error = std::string(path) + ": unsupported mcu " + s.mcu;
+            ok = false;
+        }
+        std::stable_sort(s.stimuli.begin(), s.stimuli.end(),
+                         [](const Stimulus& a, const Stimulus& b) { return a.atUs < b.atUs; });
+        return ok;
+    }
+
+private:
+    static std::vector<std::string> split(const char* line) {
+        std::vector<std::string> words;
+        const char* p = line;
+        while (*p) {
+            while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+            if (*p == '"') {                // шлях з пробілами: "2.small conveyor/..."
+                const char* start = ++p;
+                while (*p && *p != '"') p++;
+                words.emplace_back(start, p - start);
+                if (*p) p++;
+                continue;
+            }
+            const char* start = p;
+            while (*p && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+            if (p > start) words.emplace_back(start, p - start);
+        }
+        return words;
+    }
+
+    static uint64_t us(const std::string& ms) { return (uint64_t)(atof(ms.c_str()) * 1000.0 + 0.5); }
+
+    static bool directive(const std::vector<std::string>& w, const std::string& dir, Scenario& s) {
+        const std::string& d = w[0];
+        size_t n = w.size();
+        if (d == "mcu" && n == 2) {
+            s.mcu = w[1];
+        } else if (d == "elf" && n == 2) {
+            s.elf = w[1][0] == '/' ? w[1] : dir + w[1];
+        } else if (d == "ms" && n == 2) {
+            s.ms = strtoull(w[1].c_str(), nullptr, 10);
+        } else if (d == "loop-symbol" && n == 2) {
+            s.loopSymbol = w[1];
+        } else if (d == "step" && n == 2) {
+            s.stepPin = atoi(w[1].c_str());
+        } else if (d == "stop-gap" && n == 2) {
+            s.stopGapMs = atof(w[1].c_str());
+        } else if (d == "sensor" && (n == 3 || n == 4)) {
+            s.sensors.push_back({(uint8_t)atoi(w[1].c_str()), n == 4 ? w[3] : "pin" + w[1], atoi(w[2].c_str()) != 0});
+        } else if (d == "isr" && (n == 2 || n == 3)) {
+            s.vectors.push_back({atoi(w[1].c_str()), n == 3 ? w[2] : "vector " + w[1]});
+        } else if (d == "watch" && n == 3) {
+            s.watched.push_back({(uint8_t)atoi(w[1].c_str()), w[2], false});
+        } else if (d == "at" && n == 4) {
+            s.stimuli.push_back({us(w[1]), (uint8_t)atoi(w[2].c_str()), atoi(w[3].c_str()) != 0});
+        } else if (d == "pulse" && (n == 5 || n == 7)) {
+            uint64_t at = us(w[1]);
+            uint8_t pin = (uint8_t)atoi(w[2].c_str());
+            bool level = atoi(w[3].c_str()) != 0;
+            uint64_t width = us(w[4]);
+            unsigned count = n == 7 ? (unsigned)atoi(w[5].c_str()) : 1;
+            uint64_t period = n == 7 ? us(w[6]) : 0;
+            for (unsigned i = 0; i < count; i++, at += period) {
+                s.stimuli.push_back({at, pin, level});
+                s.stimuli.push_back({at + width, pin, !level});
+            }
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,114 @@
+#include "bus_stations.h"
+
+#include <Arduino.h>
+#include <LineBus.h>
+#include "bus_wire.h"
+#include "firmware.h"
+
+#include <stdio.h>
+
+namespace bus_stations {
+
+namespace {
+
+const uint8_t PORT = 1;                 // Serial1 кожної віртуальної плати
+const unsigned long BAUD = 115200;
+const uint8_t SLAVES = 2;
+const uint16_t POLL_MS = 25;
+
+const Plant* plant = nullptr;
+native::Board* boards[3] = {nullptr, nullptr, nullptr};
+BusWire wire;
+
+LineBus master(Serial1, linebus::MASTER);
+LineBus smallStation(Serial1, 1);
+LineBus packagingStation(Serial1, 2);
+
+struct StdoutPrint : Print {
+    size_t write(uint8_t b) override { return fputc(b, stdout) == EOF ? 0 : 1; }
+};
+
+// Конвеєр: закриті спайки і скільки їх ще на ремені до закривання
+void masterSetup() {
+    Serial1.begin(BAUD);
+    master.begin(SLAVES, POLL_MS);
+}
+
+void masterLoop() {
+    namespace fw = firmware::conveyor;
+    StationStatus& s = master.local();
+    s.state = 0;
+    s.flags = 0;
+    if (boards[0]->outputLevel(fw::startStopPin)) s.flags |= linebus::RUNNING;
+    if (fw::paintWorking() || fw::capWorking()) s.flags |= linebus::BUSY;
+    s.counter = (uint16_t)plant->setsCapped();
+    uint32_t onBelt = plant->setsFed() - plant->setsCapped();
+    s.incoming = onBelt < 0xFF ? (uint8_t)onBelt : 0xFF;
+    s.etaMs = linebus::ETA_UNKNOWN;
+    master.update();
+}
+
+// Малий конвеєр: зсунуті спайки і скільки їх на платформі для наступного пакету
+void smallSetup() {
+    Serial1.begin(BAUD);
+    smallStation.begin();
+}
+
+void smallLoop() {
+    namespace fw = firmware::small_conveyor;
+    StationStatus& s = smallStation.local();
+    s.state = 0;
+    s.flags = 0;
+    if (boards[1]->level(fw::startStopPin)) s.flags |= linebus::RUNNING;
+    if (boards[1]->outputLevel(fw::signalPin)) s.flags |= linebus::READY;
+    if (fw::working()) s.flags |= linebus::BUSY;
+    s.counter = (uint16_t)plant->setsPushed();
+    s.incoming = (uint8_t)plant->setsOnPlatform();
+    s.etaMs = linebus::ETA_UNKNOWN;
+    smallStation.update();
+}
+
+// Пакування: готові пакети
+void packagingSetup() {
+    Serial1.begin(BAUD);
+    packagingStation.begin();
+}
+
+void packagingLoop() {
+    StationStatus& s = packagingStation.local();
+    s.state = 0;
+    s.flags = boards[2]->level(firmware::packaging::startStopPin) ? linebus::RUNNING : 0;
+    s.counter = (uint16_t)plant->packages();
+    s.incoming = 0;
+    s.etaMs = linebus::ETA_UNKNOWN;
+    packagingStation.update();
+}
+
+const Firmware MASTER = {"bus master", masterSetup, masterLoop};
+const Firmware SMALL = {"bus small conveyor", smallSetup, smallLoop};
+const Firmware PACKAGING = {"bus packaging", packagingSetup, packagingLoop};
+
+} // namespace
+
+void attach(Scheduler& scheduler, native::Board& conveyor, native::Board& smallConveyor,
+            native::Board& packaging, const Plant& p, uint32_t loopCostUs) {
+    plant = &p;
+    boards[0] = &conveyor;
+    boards[1] = &smallConveyor;
+    boards[2] = &packaging;
+    for (native::Board* b : boards) wire.attach(*b, PORT, linebus::NO_DE);
+    scheduler.add(conveyor, MASTER, loopCostUs);
+    scheduler.add(smallConveyor, SMALL, loopCostUs);
+    scheduler.add(packaging, PACKAGING, loopCostUs);
+}
+
+void printReport() {
+    StdoutPrint out;
+    master.printStats(out);
+    smallStation.printStats(out);
+    packagingStation.printStats(out);
+    printf("Лінія: %llu байтів, колізій: %llu\n", (unsigned long long)wire.bytes(),
+           (unsigned long long)wire.collisions());
+}
+
+} // namespace bus_stations
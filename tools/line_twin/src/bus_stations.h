@@ -0,0 +1,26 @@
+#pragma once
+// Шина лінії (common/LineBus) у двійнику.
+//
+// Прошивки зазвичай зібрані без шини (LINE_BUS_ENABLED 0: на платах для неї поки немає
+// вільного UART, common/LineBus/README.md). Тоді двійник ставить біля кожної плати станцію
+// шини — окремий контролер у планувальнику, що працює з Serial1 тієї самої віртуальної плати
+// (прошивки цей порт не відкривають). Прошивки з шиною — середовище native_bus, без станцій.
+// Порти з'єднані віртуальною лінією RS-485 (bus_wire.h). Стан, який публікує станція, береться
+// з моделі цеху і зондів прошивок — те, що прошивка публікувала б сама.
+//
+// Ведучий — біля конвеєра, ведені — біля малого конвеєра (1) і пакування (2). Наприкінці —
+// звіт ведучого, що бачать ведені про станцію перед собою, і лічильники лінії.
+
+#include <ArduinoNative.h>
+#include "plant.h"
+#include "scheduler.h"
+
+namespace bus_stations {
+
+// Під'єднати станції до плат і додати їх у планувальник; loopCostUs — ітерація станції
+void attach(Scheduler& scheduler, native::Board& conveyor, native::Board& smallConveyor,
+            native::Board& packaging, const Plant& plant, uint32_t loopCostUs);
+
+void printReport();
+
+} // namespace bus_stations
@@ -0,0 +1,62 @@
+#pragma once
+// Спільна лінія RS-485 шини лінії (common/LineBus) між віртуальними платами.
+//
+// Байт, який плата пише в порт шини, доходить до приймачів усіх інших плат у момент, коли
+// він вийшов би з UART (через стільки байтових інтервалів, скільки вже стоїть у буфері TX).
+// На лінію потрапляє лише те, що передано з піднятим DE: журнал Uno в той самий Serial
+// іде в USB і шину не засмічує — так само, як з трансивером на платі.
+// Якщо дві плати передають одночасно, байти накладаються на лінії: рахуємо це як колізію.
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <LineBus.h>
+
+#include <stdint.h>
+#include <vector>
+
+class BusWire {
+public:
+    void attach(native::Board& board, uint8_t port, uint8_t dePin) {
+        nodes_.push_back({&board, port, dePin, 0});
+        size_t index = nodes_.size() - 1;
+        board.onSerialTx([this, index](uint8_t b) { transmit(index, b); }, port);
+    }
+
+    uint64_t bytes() const { return bytes_; }
+    uint64_t collisions() const { return collisions_; }
+
+private:
+    struct Node {
+        native::Board* board;
+        uint8_t port;
+        uint8_t dePin;
+        uint64_t busyUntilNs;           // коли вийде останній байт цієї плати
+    };
+
+    bool driving(const Node& n) const {
+        return n.dePin == linebus::NO_DE || n.board->outputLevel(n.dePin);
+    }
+
+    void transmit(size_t from, uint8_t b) {
+        Node& n = nodes_[from];
+        if (!driving(n)) return;
+        native::SerialPort& s = n.board->serial(n.port);
+        uint64_t byteNs = s.byteTimeNs();
+        uint64_t now = native::nanos();
+        uint64_t start = n.busyUntilNs > now ? n.busyUntilNs : now;
+        n.busyUntilNs = start + byteNs;
+        for (const Node& other : nodes_) {
+            if (&other != &n && other.busyUntilNs > start) collisions_++;
+        }
+        bytes_++;
+        native::scheduleAt(n.busyUntilNs, [this, from, b] {
+            for (size_t i = 0; i < nodes_.size(); i++) {
+                if (i != from) nodes_[i].board->serialInput(std::string(1, (char)b), nodes_[i].port);
+            }
+        });
+    }
+
+    std::vector<Node> nodes_;
+    uint64_t bytes_ = 0;
+    uint64_t collisions_ = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+// Прошивки лінії, зібрані для двійника.
+//
+// Кожна прошивка компілюється у власному файлі (fw_*.cpp) всередині свого
+// простору імен — макроси пінів і глобальні змінні різних плат не перетинаються.
+// Назовні видно лише точки входу, піни, через які плату бачить модель цеху,
+// і кілька «зондів» стану автомата для обліку часу станцій.
+
+#include <stdint.h>
+
+struct Firmware {
+    const char* name;
+    void (*setup)();
+    void (*loop)();
+};
+
+namespace firmware {
+
+// 1.conveyor — Mega: основний конвеєр, розлив фарби, закривання кришок
+namespace conveyor {
+extern const Firmware entry;
+extern const uint8_t stepPin;
+extern const uint8_t enablePin;      // LOW — драйвер увімкнено
+extern const uint8_t sensor1Pin;     // INPUT_PULLUP, активний LOW
+extern const uint8_t sensor2Pin;
+extern const uint8_t startButtonPin; // INPUT_PULLUP, натиснуто — LOW
+extern const uint8_t startStopPin;   // вихід для інших контролерів
+extern const uint8_t feedValvePin;   // valve1, видача спайки (інвертований: LOW — увімкнено)
+extern const double stepsPerMm;
+extern const int jarsInSet;
+extern const uint8_t busPort;        // шина лінії: номер Serial і пін DE трансивера
+extern const uint8_t busDePin;
+
+bool paintWorking();                 // розлив тримає конвеєр: дотягування, поршні, пауза
+bool capWorking();                   // закривання тримає конвеєр: гальмування, завертання, закривання
+void printBus();                     // звіт ведучого шини (команда bus), якщо шину ввімкнено
+} // namespace conveyor
+
+// 2.small conveyor — Uno: малий конвеєр з розподілювачем №6 (4 партії в шаховому порядку)
+namespace small_conveyor {
+extern const Firmware entry;
+extern const uint8_t stepPin;
+extern const uint8_t enablePin;      // LOW — драйвер увімкнено
+extern const uint8_t sensorPin;      // INPUT_PULLUP, активний LOW
+extern const uint8_t pusherPin;      // розподілювач №6 (інвертований: LOW — увімкнено)
+extern const uint8_t signalPin;      // вихід: 4 партії готові
+extern const uint8_t startStopPin;   // вхід від конвеєра
+extern const uint8_t busPort;
+extern const uint8_t busDePin;
+
+double stepsPerMm();                 // змінюється командою micro:
+bool working();                      // після датчика: дотягування, пневматика, сигнал
+} // namespace small_conveyor
+
+// 3.packaging line — Uno: пакування 4 спайок у пакет
+namespace packaging {
+extern const Firmware entry;
+extern const uint8_t signalPin;      // вхід від малого конвеєра
+extern const uint8_t startStopPin;   // вхід від конвеєра
+extern const uint8_t bagLiftPin;     // DIST_8, піднімання/опускання платформи з присосками
+extern const uint8_t pushPin;        // DIST_9, засування спайок у пакет
+extern const uint8_t ejectPin;       // DIST_13, скидання готового пакету
+extern const unsigned long pauseBetweenCyclesMs;
+extern const uint8_t busPort;
+extern const uint8_t busDePin;
+
+bool pipelined();
+void setPipelined(bool on);          // PIPELINED_CYCLES: підготовка пакету під час хвоста циклу
+} // namespace packaging
+
+} // namespace firmware
@@ -0,0 +1,53 @@
+// 1.conveyor у двійнику (Mega: аналогові піни з 54)
+#define ARDUINO_AVR_MEGA2560
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <avr/eeprom.h>
+#include <StallWatchdog.h>
+#include <LineBus.h>
+#include "firmware.h"
+
+namespace conveyor_fw {
+#include "../../../1.conveyor/src/main.cpp"
+}
+
+namespace firmware {
+namespace conveyor {
+
+const Firmware entry = {"conveyor", conveyor_fw::setup, conveyor_fw::loop};
+const uint8_t stepPin = X_STEP_PIN;
+const uint8_t enablePin = X_ENABLE_PIN;
+const uint8_t sensor1Pin = sensor_1;
+const uint8_t sensor2Pin = sensor_2;
+const uint8_t startButtonPin = start_PIN;
+const uint8_t startStopPin = START_STOP_PIN;
+const uint8_t feedValvePin = PNEUMATIC_1_PIN;
+const double stepsPerMm = STEPS_PER_MM_XY;
+const int jarsInSet = JARS_IN_SET;
+const uint8_t busPort = 1;           // LINE_BUS_SERIAL — Serial1
+const uint8_t busDePin = LINE_BUS_DE_PIN;
+
+bool paintWorking() {
+    using namespace conveyor_fw;
+    return machineState == MACHINE_RUNNING &&
+           (paintState == P_DOCIAG || paintState == P_PISTON || paintState == P_PISTON_2 || paintState == P_DELAY);
+}
+
+bool capWorking() {
+    using namespace conveyor_fw;
+    return machineState == MACHINE_RUNNING &&
+           (capState == C_BRAKE || capState == C_SCREW_ON || capState == C_SCREW_PAUSE ||
+            capState == C_CLOSE || capState == C_CLOSE_PAUSE);
+}
+
+void printBus() {
+#if LINE_BUS_ENABLED
+    struct StdoutPrint : Print {
+        size_t write(uint8_t b) override { return fputc(b, stdout) == EOF ? 0 : 1; }
+    } out;
+    conveyor_fw::lineBus.printStats(out);
+#endif
+}
+
+} // namespace conveyor
+} // namespace firmware
@@ -0,0 +1,29 @@
+// 3.packaging line у двійнику (Uno: A0 = 14, A2 = 16)
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <StallWatchdog.h>
+#include <LineBus.h>
+#include "firmware.h"
+
+namespace packaging_fw {
+#include "../../../3.packaging line/src/main.cpp"
+}
+
+namespace firmware {
+namespace packaging {
+
+const Firmware entry = {"packaging", packaging_fw::setup, packaging_fw::loop};
+const uint8_t signalPin = SIGNAL_PIN;
+const uint8_t startStopPin = START_STOP_PIN;
+const uint8_t bagLiftPin = DIST_8;
+const uint8_t pushPin = DIST_9;
+const uint8_t ejectPin = DIST_13;
+const unsigned long pauseBetweenCyclesMs = packaging_fw::DELAY_BETWEEN_CYCLES;
+const uint8_t busPort = 0;
+const uint8_t busDePin = packaging_fw::LINE_BUS_DE_PIN;
+
+bool pipelined() { return packaging_fw::PIPELINED_CYCLES; }
+void setPipelined(bool on) { packaging_fw::PIPELINED_CYCLES = on; }
+
+} // namespace packaging
+} // namespace firmware
@@ -0,0 +1,35 @@
+// 2.small conveyor у двійнику (Uno)
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <FixedKinematics.h>
+#include <StallWatchdog.h>
+#include <LineBus.h>
+#include "firmware.h"
+
+namespace small_conveyor_fw {
+#include "../../../2.small conveyor/src/main.cpp"
+}
+
+namespace firmware {
+namespace small_conveyor {
+
+const Firmware entry = {"small conveyor", small_conveyor_fw::setup, small_conveyor_fw::loop};
+const uint8_t stepPin = small_conveyor_fw::STEP_PIN;
+const uint8_t enablePin = small_conveyor_fw::ENABLE_PIN;
+const uint8_t sensorPin = small_conveyor_fw::SENSOR_PIN;
+const uint8_t pusherPin = small_conveyor_fw::PNEUMATIC_PIN;
+const uint8_t signalPin = small_conveyor_fw::SIGNAL_PIN;
+const uint8_t startStopPin = small_conveyor_fw::START_STOP_PIN;
+const uint8_t busPort = 0;
+const uint8_t busDePin = small_conveyor_fw::LINE_BUS_DE_PIN;
+
+double stepsPerMm() { return small_conveyor_fw::stepScale.stepsPerMm() / 65536.0; }
+
+bool working() {
+    using namespace small_conveyor_fw;
+    return currentState == SENSOR_TRIGGERED || currentState == PULLING ||
+           currentState == PNEUMATIC_WORKING || currentState == SIGNAL_ACTIVE;
+}
+
+} // namespace small_conveyor
+} // namespace firmware
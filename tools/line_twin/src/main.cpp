@@ -0,0 +1,185 @@
+// Цифровий двійник лінії: конвеєр (Mega), малий конвеєр і пакування (Uno)
+// в одному процесі у віртуальному часі, з моделлю цеху між ними.
+//
+//   line_twin [--minutes N] [--conveyor-loop-us N] [--uno-loop-us N] [--serial NAME]
+//             [--jar-pitch MM] [--jar-diameter MM] [--feed-to-s1 MM] [--s1-to-s2 MM]
+//             [--s2-to-end MM] [--small-to-sensor MM] [--platform-sets N] [--pipelined 0|1]
+//             [--bus 0|1]
+//
+// Наприкінці друкує сталу продуктивність (баночок/год), час кожної станції
+// (зайнята / простій / заблокована) і вузьке місце.
+//
+// З --bus 1 — ще й шина лінії між платами (bus_stations.h) і звіт ведучого: опитування,
+// відповіді, тайм-аути, запізнілі відповіді, колізії. Зібраний з -DLINE_BUS_ENABLED=1
+// (середовище native_bus) — на шині самі прошивки: їхні порти шини з'єднані віртуальною
+// лінією RS-485 (bus_wire.h), а звіт дає ведучий конвеєра (команда bus).
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include "bus_stations.h"
+#include "bus_wire.h"
+#include "firmware.h"
+#include "plant.h"
+#include "scheduler.h"
+#include "../../telemetry_decode/src/telemetry_decoder.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+namespace {
+
+void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [--minutes N] [--conveyor-loop-us N] [--uno-loop-us N] [--serial conveyor|small|packaging]\n"
+            "          [--jar-pitch MM] [--jar-diameter MM] [--feed-to-s1 MM] [--s1-to-s2 MM]\n"
+            "          [--s2-to-end MM] [--small-to-sensor MM] [--platform-sets N] [--pipelined 0|1]\n"
+            "          [--bus 0|1]\n",
+            prog);
+}
+
+void echoSerial(native::Board& board) {
+    board.onSerialTx([&board](uint8_t b) {
+        static bool lineStart = true;
+        if (lineStart) printf("%10.3f [%s] ", native::nanos() / 1e9, board.name());
+        fputc(b, stdout);
+        lineStart = (b == '\n');
+    });
+}
+
+// Конвеєр пише двійкову телеметрію (telemetry.h) — розбираємо тим самим декодером, що й з порту
+void echoTelemetry(native::Board& board) {
+    static TelemetryDecoder decoder([&board](const std::string& line) {
+        printf("%10.3f [%s] %s", native::nanos() / 1e9, board.name(), line.c_str());
+    });
+    board.onSerialTx([](uint8_t b) { decoder.feed(b); });
+}
+
+// printf рахує ширину в байтах, а назви станцій — кирилиця (2 байти на літеру)
+void printPadded(const char* text, int width) {
+    int chars = 0;
+    for (const char* p = text; *p; p++) {
+        if (((uint8_t)*p & 0xC0) != 0x80) chars++;
+    }
+    printf("%s%*s", text, width > chars ? width - chars : 0, "");
+}
+
+void printReport(const Plant& plant, double minutes, double hostSeconds) {
+    printf("\n=== Двійник лінії: %.1f хв віртуального часу (%.1f с на ПК) ===\n", minutes, hostSeconds);
+    printf("Спайок видано: %u, закрито: %u, на платформі: %u\n",
+           plant.setsFed(), plant.setsCapped(), plant.setsOnPlatform());
+    printf("Пакетів: %u, баночок упаковано: %u (пакування: %s цикл)\n", plant.packages(), plant.jarsPacked(),
+           firmware::packaging::pipelined() ? "конвеєрний" : "послідовний");
+    printf("Стала продуктивність: %.0f баночок/год на пакуванні, %.0f баночок/год на закриванні\n",
+           plant.packedJarsPerHour(), plant.cappedJarsPerHour());
+
+    printf("\n");
+    printPadded("станція", 16);
+    printf("  зайнята   простій  заблокована\n");
+    int bottleneck = 0;
+    double bestBusy = -1;
+    for (int i = 0; i < Plant::STATION_COUNT; i++) {
+        const StationStats& s = plant.station((Plant::Station)i);
+        double total = s.totalMs() ? (double)s.totalMs() : 1.0;
+        double busy = 100.0 * s.busyMs / total;
+        printPadded(s.name, 16);
+        printf(" %8.1f%% %8.1f%% %11.1f%%\n", busy, 100.0 * s.idleMs / total, 100.0 * s.blockedMs / total);
+        if (busy > bestBusy) {
+            bestBusy = busy;
+            bottleneck = i;
+        }
+    }
+    printf("\nВузьке місце: %s (зайнята %.1f%% часу)\n", plant.station((Plant::Station)bottleneck).name, bestBusy);
+
+    if (plant.platformOverflows()) {
+        printf("Увага: %u разів спайку зсунуто на повну платформу пакування\n", plant.platformOverflows());
+    }
+    if (plant.shortBags()) {
+        printf("Увага: %u пакетів запаяно неповними (менше 4 спайок)\n", plant.shortBags());
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double minutes = 30;
+    uint32_t conveyorLoopUs = 50;
+    uint32_t unoLoopUs = 20;
+    std::string serialEcho;
+    PlantConfig cfg;
+    int pipelined = -1;   // -1 — як у прошивці
+    bool bus = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!v) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (!strcmp(a, "--minutes")) minutes = atof(v);
+        else if (!strcmp(a, "--conveyor-loop-us")) conveyorLoopUs = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--uno-loop-us")) unoLoopUs = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--serial")) serialEcho = v;
+        else if (!strcmp(a, "--jar-pitch")) cfg.jarPitchMm = atof(v);
+        else if (!strcmp(a, "--jar-diameter")) cfg.jarDiameterMm = atof(v);
+        else if (!strcmp(a, "--feed-to-s1")) cfg.feedToSensor1Mm = atof(v);
+        else if (!strcmp(a, "--s1-to-s2")) cfg.sensor1ToSensor2Mm = atof(v);
+        else if (!strcmp(a, "--s2-to-end")) cfg.sensor2ToBeltEndMm = atof(v);
+        else if (!strcmp(a, "--small-to-sensor")) cfg.smallToSensorMm = atof(v);
+        else if (!strcmp(a, "--platform-sets")) cfg.platformSets = atoi(v);
+        else if (!strcmp(a, "--pipelined")) pipelined = atoi(v) != 0;
+        else if (!strcmp(a, "--bus")) bus = atoi(v) != 0;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+
+    if (pipelined >= 0) firmware::packaging::setPipelined(pipelined);
+
+    native::Board conveyor("conveyor");
+    native::Board smallConveyor("small");
+    native::Board packaging("packaging");
+    if (serialEcho == "conveyor") echoTelemetry(conveyor);
+    else if (serialEcho == "small") echoSerial(smallConveyor);
+    else if (serialEcho == "packaging") echoSerial(packaging);
+
+    Plant plant(conveyor, smallConveyor, packaging, cfg);
+    plant.attach();
+    plant.pressStart(100);
+
+    Scheduler scheduler;
+    scheduler.add(conveyor, firmware::conveyor::entry, conveyorLoopUs);
+    scheduler.add(smallConveyor, firmware::small_conveyor::entry, unoLoopUs);
+    scheduler.add(packaging, firmware::packaging::entry, unoLoopUs);
+#if LINE_BUS_ENABLED
+    // Шину ведуть прошивки; окремі станції зайняли б ті самі порти
+    bus = false;
+    BusWire busWire;
+    busWire.attach(conveyor, firmware::conveyor::busPort, firmware::conveyor::busDePin);
+    busWire.attach(smallConveyor, firmware::small_conveyor::busPort, firmware::small_conveyor::busDePin);
+    busWire.attach(packaging, firmware::packaging::busPort, firmware::packaging::busDePin);
+#endif
+    if (bus) bus_stations::attach(scheduler, conveyor, smallConveyor, packaging, plant, unoLoopUs);
+
+    auto t0 = std::chrono::steady_clock::now();
+    scheduler.run((uint64_t)(minutes * 60e9));
+    double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    fflush(stdout);
+    printReport(plant, minutes, hostSeconds);
+    if (bus) {
+        printf("\n");
+        bus_stations::printReport();
+    }
+#if LINE_BUS_ENABLED
+    printf("\n");
+    firmware::conveyor::printBus();
+    printf("Лінія: %llu байтів, колізій: %llu\n", (unsigned long long)busWire.bytes(),
+           (unsigned long long)busWire.collisions());
+#endif
+    return 0;
+}
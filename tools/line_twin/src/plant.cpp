@@ -0,0 +1,206 @@
+#include <Arduino.h>
+#include "plant.h"
+#include "firmware.h"
+
+namespace fc = firmware::conveyor;
+namespace fs = firmware::small_conveyor;
+namespace fp = firmware::packaging;
+
+void StationStats::add(StationState s) {
+    switch (s) {
+        case STATION_BUSY: busyMs++; break;
+        case STATION_IDLE: idleMs++; break;
+        case STATION_BLOCKED: blockedMs++; break;
+    }
+}
+
+Plant::Plant(native::Board& conveyor, native::Board& smallConveyor, native::Board& packaging, const PlantConfig& cfg)
+    : conveyor_(conveyor), small_(smallConveyor), packaging_(packaging), cfg_(cfg) {
+    sensor1Mm_ = cfg_.feedToSensor1Mm;
+    sensor2Mm_ = sensor1Mm_ + cfg_.sensor1ToSensor2Mm;
+    beltEndMm_ = sensor2Mm_ + cfg_.sensor2ToBeltEndMm;
+    setLengthMm_ = fc::jarsInSet * cfg_.jarPitchMm;
+    stations_[PAINT].name = "розлив";
+    stations_[CAP].name = "закривання";
+    stations_[SMALL_CONVEYOR].name = "малий конвеєр";
+    stations_[PACKAGING].name = "пакування";
+}
+
+void Plant::attach() {
+    // Початкові рівні входів: кнопка відпущена, датчики вільні, сигналів немає
+    conveyor_.setInput(fc::startButtonPin, HIGH);
+    conveyor_.setInput(fc::sensor1Pin, HIGH);
+    conveyor_.setInput(fc::sensor2Pin, HIGH);
+    small_.setInput(fs::sensorPin, HIGH);
+    small_.setInput(fs::startStopPin, LOW);
+    packaging_.setInput(fp::startStopPin, LOW);
+    packaging_.setInput(fp::signalPin, LOW);
+
+    conveyor_.onOutputChange([this](uint8_t pin, bool level) {
+        if (pin == fc::stepPin && level && !conveyor_.outputLevel(fc::enablePin)) {
+            moveBelt(1.0 / fc::stepsPerMm);
+        } else if (pin == fc::feedValvePin && !level) {
+            feedSet();
+        } else if (pin == fc::startStopPin) {
+            // Дроти START_STOP: конвеєр → малий конвеєр і пакування
+            small_.setInput(fs::startStopPin, level);
+            packaging_.setInput(fp::startStopPin, level);
+        }
+    });
+    small_.onOutputChange([this](uint8_t pin, bool level) {
+        if (pin == fs::stepPin && level && !small_.outputLevel(fs::enablePin)) {
+            moveSmallBelt(1.0 / fs::stepsPerMm());
+        } else if (pin == fs::pusherPin && !level) {
+            push();
+        } else if (pin == fs::signalPin) {
+            packaging_.setInput(fp::signalPin, level);
+        }
+    });
+    packaging_.onOutputChange([this](uint8_t pin, bool level) { onPackagingOutput(pin, level); });
+
+    native::scheduleAfter(1000000, [this]() { sample(); });
+}
+
+void Plant::pressStart(uint64_t atMs) {
+    native::scheduleAt(atMs * 1000000ULL, [this]() { conveyor_.setInput(fc::startButtonPin, LOW); });
+    native::scheduleAt((atMs + 200) * 1000000ULL, [this]() { conveyor_.setInput(fc::startButtonPin, HIGH); });
+}
+
+// valve1 виштовхує нову спайку; якщо попередня ще не відійшла — нова стає впритул за нею
+void Plant::feedSet() {
+    double front = 0.0;
+    if (!jars_.empty()) {
+        double tail = jars_.back().pos - cfg_.jarPitchMm;
+        if (tail < front) front = tail;
+    }
+    for (int i = 0; i < fc::jarsInSet; i++) {
+        jars_.push_back(Jar{front - i * cfg_.jarPitchMm, i == fc::jarsInSet - 1});
+    }
+    setsFed_++;
+    updateSensors();
+}
+
+void Plant::moveBelt(double mm) {
+    for (Jar& j : jars_) j.pos += mm;
+    while (!jars_.empty() && jars_.front().pos > beltEndMm_) {
+        if (jars_.front().lastInSet) {
+            // Спайка зійшла з ременя — на вхід малого конвеєра
+            double front = 0.0;
+            if (!smallSets_.empty()) {
+                double tail = smallSets_.back() - setLengthMm_ - cfg_.smallGapMm;
+                if (tail < front) front = tail;
+            }
+            smallSets_.push_back(front);
+            updateSmallSensor();
+        }
+        jars_.pop_front();
+    }
+    updateSensors();
+}
+
+void Plant::updateSensors() {
+    bool s1 = false, s2 = false;
+    double r = cfg_.jarDiameterMm / 2;
+    for (const Jar& j : jars_) {
+        if (j.pos > sensor1Mm_ - r && j.pos < sensor1Mm_ + r) s1 = true;
+        if (j.pos > sensor2Mm_ - r && j.pos < sensor2Mm_ + r) s2 = true;
+    }
+    conveyor_.setInput(fc::sensor1Pin, !s1);
+    conveyor_.setInput(fc::sensor2Pin, !s2);
+}
+
+void Plant::moveSmallBelt(double mm) {
+    if (smallSets_.empty()) return;
+    for (double& front : smallSets_) front += mm;
+    updateSmallSensor();
+}
+
+void Plant::updateSmallSensor() {
+    bool seen = false;
+    for (double front : smallSets_) {
+        if (front >= cfg_.smallToSensorMm && front - setLengthMm_ < cfg_.smallToSensorMm) seen = true;
+    }
+    small_.setInput(fs::sensorPin, !seen);
+}
+
+// Розподілювач №6 зсуває на платформу спайку, що стоїть під датчиком
+void Plant::push() {
+    for (auto it = smallSets_.begin(); it != smallSets_.end(); ++it) {
+        if (*it >= cfg_.smallToSensorMm && *it - setLengthMm_ < cfg_.smallToSensorMm) {
+            smallSets_.erase(it);
+            if (platform_ >= (uint32_t)cfg_.platformSets) overflows_++;
+            platform_++;
+            pushed_++;
+            break;
+        }
+    }
+    updateSmallSensor();
+}
+
+void Plant::onPackagingOutput(uint8_t pin, bool level) {
+    bool active = !level;   // циліндри пакування інвертовані
+    uint64_t now = native::nanos();
+    if (pin == fp::bagLiftPin) {
+        if (active && !preparing_) {
+            preparing_ = true;
+            bagLiftReleases_ = 0;
+            pauseEndNs_ = 0;
+        } else if (!active && preparing_ && ++bagLiftReleases_ == 2) {
+            preparing_ = false;   // пакет відкрито, чекаємо SIGNAL_PIN
+        }
+    } else if (pin == fp::pushPin && active) {
+        packing_ = true;
+        pauseEndNs_ = 0;
+        inBag_ = platform_ < (uint32_t)cfg_.platformSets ? platform_ : cfg_.platformSets;
+        if (inBag_ < (uint32_t)cfg_.platformSets) shortBags_++;
+        platform_ -= inBag_;
+    } else if (pin == fp::ejectPin && !active && packing_) {
+        packing_ = false;
+        if (!fp::pipelined()) pauseEndNs_ = now + fp::pauseBetweenCyclesMs * 1000000ULL;
+        packages_++;
+        jarsPacked_ += inBag_ * fc::jarsInSet;
+        inBag_ = 0;
+        packed_.push_back(Milestone{now, jarsPacked_});
+    }
+}
+
+void Plant::sample() {
+    uint64_t now = native::nanos();
+    bool paint = fc::paintWorking();
+    bool cap = fc::capWorking();
+
+    // Розлив і закривання стоять на одному ремені: поки одна станція тримає
+    // конвеєр, друга не отримає наступну баночку
+    stations_[PAINT].add(paint ? STATION_BUSY : cap ? STATION_BLOCKED : STATION_IDLE);
+    stations_[CAP].add(cap ? STATION_BUSY : paint ? STATION_BLOCKED : STATION_IDLE);
+
+    if (cap && !capWasWorking_) {
+        setsCapped_++;
+        capped_.push_back(Milestone{now, setsCapped_ * (uint32_t)fc::jarsInSet});
+    }
+    capWasWorking_ = cap;
+
+    // Малий конвеєр зайнятий, поки везе або обробляє спайку; заблокований —
+    // якщо має спайку, а платформа пакування вже повна
+    bool platformFull = platform_ >= (uint32_t)cfg_.platformSets;
+    StationState smallState = STATION_IDLE;
+    if (!smallSets_.empty() && platformFull && !fs::working()) smallState = STATION_BLOCKED;
+    else if (!smallSets_.empty() || fs::working()) smallState = STATION_BUSY;
+    stations_[SMALL_CONVEYOR].add(smallState);
+
+    bool packagingBusy = preparing_ || packing_ || now < pauseEndNs_;
+    stations_[PACKAGING].add(packagingBusy ? STATION_BUSY : STATION_IDLE);
+
+    native::scheduleAt(now + 1000000, [this]() { sample(); });
+}
+
+double Plant::ratePerHour(const std::vector<Milestone>& events) {
+    if (events.size() < 2) return 0.0;
+    const Milestone& first = events.front();
+    const Milestone& last = events.back();
+    double hours = (last.ns - first.ns) / 3.6e12;
+    return hours > 0 ? (last.jars - first.jars) / hours : 0.0;
+}
+
+double Plant::packedJarsPerHour() const { return ratePerHour(packed_); }
+double Plant::cappedJarsPerHour() const { return ratePerHour(capped_); }
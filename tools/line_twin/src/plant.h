@@ -0,0 +1,124 @@
+#pragma once
+// Модель цеху навколо трьох контролерів.
+//
+// Основний конвеєр: ремінь рухається на 1/STEPS_PER_MM_XY мм за кожен STEP при
+// увімкненому драйвері. Спайка з JARS_IN_SET баночок з'являється на місці видачі,
+// коли спрацьовує valve1. Датчики 1 і 2 бачать баночку, поки її центр ближче за
+// половину діаметра. Спайка, що зійшла з кінця ременя, переходить на малий конвеєр.
+//
+// Малий конвеєр: спайка — суцільний предмет довжиною JARS_IN_SET кроків баночок,
+// датчик бачить її, поки вона під ним. Розподілювач №6 зсуває спайку з-під датчика
+// на платформу пакування. DIST_9 пакування забирає з платформи до 4 спайок у пакет,
+// DIST_13 скидає готовий пакет.
+// Пакування зайняте, поки готує пакет (DIST_8: опускання … відкривання), пакує
+// (DIST_9 … DIST_13) або витримує паузу між циклами (лише в послідовному режимі).
+//
+// Раз на мілісекунду кожна станція отримує стан: зайнята, простій (немає роботи)
+// або заблокована (робота є, але її не пускає сусідня станція).
+
+#include <ArduinoNative.h>
+
+#include <deque>
+#include <stdint.h>
+#include <vector>
+
+struct PlantConfig {
+    double jarPitchMm = 40.0;          // відстань між центрами баночок у спайці
+    double jarDiameterMm = 34.0;       // скільки ременя баночка «закриває» для датчика
+    double feedToSensor1Mm = 120.0;    // від передньої баночки щойно виданої спайки до датчика 1
+    double sensor1ToSensor2Mm = 400.0; // між датчиками 1 і 2
+    double sensor2ToBeltEndMm = 300.0; // від датчика 2 до переходу на малий конвеєр
+    double smallToSensorMm = 250.0;    // малий конвеєр: від входу до датчика
+    double smallGapMm = 5.0;           // зазор між спайками, що підпирають одна одну
+    int platformSets = 4;              // скільки спайок вміщує платформа пакування
+};
+
+enum StationState : uint8_t { STATION_BUSY, STATION_IDLE, STATION_BLOCKED };
+
+struct StationStats {
+    const char* name;
+    uint64_t busyMs = 0;
+    uint64_t idleMs = 0;
+    uint64_t blockedMs = 0;
+
+    void add(StationState s);
+    uint64_t totalMs() const { return busyMs + idleMs + blockedMs; }
+};
+
+class Plant {
+public:
+    enum Station { PAINT, CAP, SMALL_CONVEYOR, PACKAGING, STATION_COUNT };
+
+    Plant(native::Board& conveyor, native::Board& smallConveyor, native::Board& packaging, const PlantConfig& cfg);
+
+    // Підключити модель до пінів плат і запланувати облік часу станцій
+    void attach();
+    // Натиснути кнопку старту конвеєра на 200 мс
+    void pressStart(uint64_t atMs);
+
+    const StationStats& station(Station s) const { return stations_[s]; }
+
+    uint32_t setsFed() const { return setsFed_; }
+    uint32_t setsCapped() const { return setsCapped_; }
+    uint32_t setsOnPlatform() const { return platform_; }
+    uint32_t setsPushed() const { return pushed_; }   // зсунуто розподілювачем №6 на платформу
+    uint32_t packages() const { return packages_; }
+    uint32_t jarsPacked() const { return jarsPacked_; }
+    uint32_t platformOverflows() const { return overflows_; }
+    uint32_t shortBags() const { return shortBags_; }
+    // Стала продуктивність між першою і останньою подією (0 — подій замало)
+    double packedJarsPerHour() const;
+    double cappedJarsPerHour() const;
+
+private:
+    struct Jar {
+        double pos;        // координата центру на основному ремені, мм
+        bool lastInSet;
+    };
+
+    void feedSet();
+    void moveBelt(double mm);
+    void moveSmallBelt(double mm);
+    void updateSensors();
+    void updateSmallSensor();
+    void push();
+    void onPackagingOutput(uint8_t pin, bool level);
+    void sample();
+
+    // Момент події та кількість баночок, накопичена до нього включно
+    struct Milestone {
+        uint64_t ns;
+        uint32_t jars;
+    };
+    static double ratePerHour(const std::vector<Milestone>& events);
+
+    native::Board& conveyor_;
+    native::Board& small_;
+    native::Board& packaging_;
+    PlantConfig cfg_;
+    double sensor1Mm_, sensor2Mm_, beltEndMm_, setLengthMm_;
+
+    std::deque<Jar> jars_;
+    std::deque<double> smallSets_;   // передній край кожної спайки на малому конвеєрі, мм
+
+    uint32_t setsFed_ = 0;
+    uint32_t setsCapped_ = 0;
+    uint32_t platform_ = 0;
+    uint32_t pushed_ = 0;
+    uint32_t inBag_ = 0;
+    uint32_t packages_ = 0;
+    uint32_t jarsPacked_ = 0;
+    uint32_t overflows_ = 0;
+    uint32_t shortBags_ = 0;
+    std::vector<Milestone> capped_;
+    std::vector<Milestone> packed_;
+
+    // Пакування: підготовка пакету і пакування можуть перекриватись (PIPELINED_CYCLES)
+    bool preparing_ = false;
+    int bagLiftReleases_ = 0;
+    bool packing_ = false;
+    uint64_t pauseEndNs_ = 0;
+    bool capWasWorking_ = false;
+
+    StationStats stations_[STATION_COUNT];
+};
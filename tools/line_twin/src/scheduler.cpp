@@ -0,0 +1,86 @@
+#include "scheduler.h"
+
+Scheduler* Scheduler::active_ = nullptr;
+
+void Scheduler::add(native::Board& board, const Firmware& fw, uint32_t loopCostUs) {
+    auto node = std::make_unique<Node>();
+    node->board = &board;
+    node->fw = fw;
+    node->loopCostNs = (uint64_t)loopCostUs * 1000;
+    nodes_.push_back(std::move(node));
+}
+
+void Scheduler::run(uint64_t endNs) {
+    endNs_ = endNs;
+    active_ = this;
+    native::setSleepHook([this](uint64_t ns) { sleep(ns); });
+    for (auto& n : nodes_) {
+        n->stack.resize(STACK_SIZE);
+        getcontext(&n->context);
+        n->context.uc_stack.ss_sp = n->stack.data();
+        n->context.uc_stack.ss_size = n->stack.size();
+        n->context.uc_link = &main_;
+        makecontext(&n->context, &Scheduler::entry, 0);
+    }
+
+    // Плати передають хід одна одній напряму; планувальник отримує його назад,
+    // коли найближче пробудження виходить за кінець прогону
+    int first = earliest();
+    if (first >= 0 && nodes_[first]->wakeNs < endNs_) switchTo(-1, first);
+    native::advanceTo(endNs_);
+
+    // Зупинка: кожна плата по черзі отримує хід і виходить з прошивки винятком
+    stopping_ = true;
+    for (int i = 0; i < (int)nodes_.size(); i++) switchTo(-1, i);
+    native::setSleepHook(nullptr);
+    native::setBoard(nullptr);
+    active_ = nullptr;
+}
+
+void Scheduler::entry() { active_->nodeMain(active_->current_); }
+
+void Scheduler::nodeMain(int index) {
+    Node& n = *nodes_[index];
+    try {
+        if (stopping_) throw Stop();
+        n.fw.setup();
+        while (true) {
+            n.fw.loop();
+            native::sleepNanos(n.loopCostNs);
+        }
+    } catch (const Stop&) {
+    }
+    // Повернення з функції переходить у uc_link — контекст планувальника
+    current_ = -1;
+}
+
+void Scheduler::sleep(uint64_t ns) {
+    int index = current_;
+    nodes_[index]->wakeNs = native::nanos() + ns;
+    int next = earliest();
+    if (nodes_[next]->wakeNs >= endNs_) {
+        switchTo(index, -1);
+    } else {
+        // Події до пробудження наступної плати (кроки таймера, модель цеху)
+        native::advanceTo(nodes_[next]->wakeNs);
+        if (next == index) return;   // ця плата прокидається першою — перемикатись нема потреби
+        switchTo(index, next);
+    }
+    if (stopping_) throw Stop();
+}
+
+int Scheduler::earliest() const {
+    int best = -1;
+    for (int i = 0; i < (int)nodes_.size(); i++) {
+        if (best < 0 || nodes_[i]->wakeNs < nodes_[best]->wakeNs) best = i;
+    }
+    return best;
+}
+
+void Scheduler::switchTo(int from, int to) {
+    current_ = to;
+    native::setBoard(to >= 0 ? nodes_[to]->board : nullptr);
+    ucontext_t* save = from >= 0 ? &nodes_[from]->context : &main_;
+    ucontext_t* load = to >= 0 ? &nodes_[to]->context : &main_;
+    swapcontext(save, load);
+}
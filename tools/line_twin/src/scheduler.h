@@ -0,0 +1,54 @@
+#pragma once
+// Почергове виконання кількох прошивок у спільному віртуальному часі.
+//
+// Прошивки можуть чекати всередині loop() (delay(), повний буфер Serial), тому кожна
+// плата виконується у власному контексті з власним стеком (ucontext), але лише одна
+// за раз: коли плата «засинає» (delay, вартість ітерації loop(), повний буфер Serial),
+// керування отримує та, чий момент пробудження найраніший. Перемикання — звичайний
+// swapcontext без потоків ОС, тож навіть плати без delay() у loop() (перемикання
+// кожні десятки мкс віртуального часу) не впираються в планувальник ОС.
+// Порядок однаковий на кожному запуску — результат двійника детермінований.
+
+#include <ArduinoNative.h>
+#include "firmware.h"
+
+#include <ucontext.h>
+#include <memory>
+#include <vector>
+
+class Scheduler {
+public:
+    // loopCostUs — скільки віртуального часу займає одна ітерація loop() без delay()
+    void add(native::Board& board, const Firmware& fw, uint32_t loopCostUs);
+
+    // Виконувати всі плати до моменту endNs віртуального часу
+    void run(uint64_t endNs);
+
+private:
+    static constexpr size_t STACK_SIZE = 1 << 20;
+
+    struct Node {
+        native::Board* board;
+        Firmware fw;
+        uint64_t loopCostNs;
+        uint64_t wakeNs = 0;
+        ucontext_t context;
+        std::vector<char> stack;
+    };
+
+    struct Stop {};
+
+    static void entry();
+    void nodeMain(int index);
+    void sleep(uint64_t ns);
+    int earliest() const;
+    void switchTo(int from, int to);      // -1 — контекст планувальника
+
+    std::vector<std::unique_ptr<Node>> nodes_;
+    ucontext_t main_;
+    int current_ = -1;
+    bool stopping_ = false;
+    uint64_t endNs_ = 0;
+
+    static Scheduler* active_;
+};
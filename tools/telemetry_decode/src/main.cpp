@@ -0,0 +1,36 @@
+// Декодер телеметрії 1.conveyor: двійковий потік із Serial → читабельний журнал.
+//
+//   telemetry_decode [FILE]
+//
+// Без FILE читає stdin, тож працює і з портом, і з прошивкою на ПК:
+//   stty -F /dev/ttyACM0 115200 raw && telemetry_decode /dev/ttyACM0
+//   pio run -e native -t exec -- --ms 10000 ... | telemetry_decode
+
+#include "telemetry_decoder.h"
+
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [FILE]\n", argv[0]);
+        return 2;
+    }
+    FILE* in = stdin;
+    if (argc == 2) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    TelemetryDecoder decoder([](const std::string& line) {
+        fputs(line.c_str(), stdout);
+        fflush(stdout);
+    });
+    // По байту: кадр виводиться, щойно прийшов його роздільник, а не коли наповниться блок
+    int c;
+    while ((c = fgetc(in)) != EOF) decoder.feed((uint8_t)c);
+    decoder.finish();
+    return 0;
+}
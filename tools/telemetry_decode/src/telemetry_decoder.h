@@ -0,0 +1,207 @@
+#pragma once
+// Декодер телеметрії 1.conveyor (1.conveyor/src/telemetry.h) на ПК.
+//
+// Потік байтів ріжеться на кадри по 0x00; кадр розкодовується з COBS, перевіряється CRC-8,
+// а аргументи розбираються за форматом події з тієї ж таблиці, що й у прошивці
+// (telemetry_events.h). Байти, що не складаються в цілий кадр (текст іншого походження,
+// обірваний кадр після підключення до порту), передаються як є — до останнього '\n'.
+//
+// Час подій — micros() плати (32 біти); переповнення кожні 71.6 хв розгортається.
+
+#include "../../../1.conveyor/src/telemetry_events.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+class TelemetryDecoder {
+public:
+    // Готовий рядок виводу (з '\n' у кінці)
+    using Sink = std::function<void(const std::string& line)>;
+
+    explicit TelemetryDecoder(Sink sink) : sink_(std::move(sink)) {}
+
+    void feed(uint8_t b) {
+        if (b != 0) {
+            pending_.push_back(b);
+            return;
+        }
+        handleChunk();
+        pending_.clear();
+    }
+
+    void feed(const uint8_t* data, size_t n) {
+        for (size_t i = 0; i < n; i++) feed(data[i]);
+    }
+
+    // Кінець потоку: вивести те, що лишилося
+    void finish() {
+        passThrough(pending_.data(), pending_.size());
+        pending_.clear();
+        if (!text_.empty()) {
+            sink_(text_ + "\n");
+            text_.clear();
+        }
+    }
+
+    // Шматки між роздільниками, що не розібрались як кадр (зіпсовані або просто текст)
+    unsigned badFrames() const { return badFrames_; }
+
+private:
+    static constexpr uint8_t TELEMETRY_EVENT_COUNT = 0
+#define TELEMETRY_EVENT_ONE(name, level, format) + 1
+        TELEMETRY_EVENTS(TELEMETRY_EVENT_ONE)
+#undef TELEMETRY_EVENT_ONE
+        ;
+
+    struct EventInfo {
+        const char* name;
+        const char* level;
+        const char* format;
+    };
+
+    static const EventInfo& info(uint8_t id) {
+        static const EventInfo events[] = {
+#define TELEMETRY_EVENT_INFO(name, level, format) {#name, #level, format},
+            TELEMETRY_EVENTS(TELEMETRY_EVENT_INFO)
+#undef TELEMETRY_EVENT_INFO
+        };
+        return events[id];
+    }
+
+    static uint8_t crc8(const uint8_t* p, size_t n) {
+        uint8_t crc = 0;
+        while (n--) {
+            crc ^= *p++;
+            for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+    static bool cobsDecode(const uint8_t* in, size_t n, std::vector<uint8_t>& out) {
+        out.clear();
+        size_t i = 0;
+        while (i < n) {
+            uint8_t code = in[i++];
+            if (code == 0 || i + code - 1 > n) return false;
+            for (uint8_t k = 1; k < code; k++) out.push_back(in[i++]);
+            if (code < 0xFF && i < n) out.push_back(0);
+        }
+        return true;
+    }
+
+    // Кадр з байтів [0, n): пробуємо з початку, потім з кожного місця після '\n'
+    // (перед кадром у тому ж шматку міг бути звичайний текст)
+    void handleChunk() {
+        const uint8_t* p = pending_.data();
+        size_t n = pending_.size();
+        for (size_t start = 0; start < n; start++) {
+            if (start > 0 && p[start - 1] != '\n') continue;
+            if (decodeFrame(p + start, n - start)) {
+                passThrough(p, start);
+                return;
+            }
+        }
+        if (n) badFrames_++;
+        passThrough(p, n);
+    }
+
+    void passThrough(const uint8_t* p, size_t n) {
+        if (!n) return;
+        std::string s((const char*)p, n);
+        size_t nl = s.rfind('\n');
+        if (nl == std::string::npos) return;         // обривок — не виводимо
+        sink_(s.substr(0, nl + 1));
+    }
+
+    bool decodeFrame(const uint8_t* p, size_t n) {
+        std::vector<uint8_t> f;
+        if (!cobsDecode(p, n, f) || f.size() < 6) return false;
+        if (crc8(f.data(), f.size() - 1) != f.back()) return false;
+        f.pop_back();
+
+        uint8_t id = f[0];
+        uint32_t t = f[1] | (f[2] << 8) | (f[3] << 16) | ((uint32_t)f[4] << 24);
+        if (haveTime_ && t < lastMicros_ && lastMicros_ - t > 0x80000000u) epoch_++;
+        haveTime_ = true;
+        lastMicros_ = t;
+        double seconds = ((double)epoch_ * 4294967296.0 + t) / 1e6;
+
+        if (id == 0) {                               // TEXT: довільний текст рядками
+            text_.append((const char*)f.data() + 5, f.size() - 5);
+            size_t nl;
+            while ((nl = text_.find('\n')) != std::string::npos) {
+                sink_(text_.substr(0, nl + 1));
+                text_.erase(0, nl + 1);
+            }
+            return true;
+        }
+
+        char head[64];
+        if (id >= TELEMETRY_EVENT_COUNT) {
+            snprintf(head, sizeof(head), "%12.6f ?     unknown event %u\n", seconds, id);
+            sink_(head);
+            return true;
+        }
+
+        const EventInfo& e = info(id);
+        std::string message;
+        size_t pos = 5;
+        for (const char* c = e.format; *c; c++) {
+            if (*c != '%') {
+                message += *c;
+                continue;
+            }
+            c++;
+            char buf[32];
+            if (*c == '%') {
+                message += '%';
+                continue;
+            } else if (*c == 'u' || *c == 'd') {
+                uint32_t v;
+                if (!readVarint(f, pos, v)) return false;
+                if (*c == 'u') {
+                    snprintf(buf, sizeof(buf), "%u", v);
+                } else {
+                    snprintf(buf, sizeof(buf), "%d", (int32_t)((v >> 1) ^ (~(v & 1) + 1)));
+                }
+            } else if (*c == 'f') {
+                if (pos + 4 > f.size()) return false;
+                float v;
+                memcpy(&v, &f[pos], 4);
+                pos += 4;
+                snprintf(buf, sizeof(buf), "%.2f", v);
+            } else {
+                return false;
+            }
+            message += buf;
+        }
+        if (pos != f.size()) return false;
+
+        snprintf(head, sizeof(head), "%12.6f %-5s ", seconds, e.level);
+        sink_(std::string(head) + message + "\n");
+        return true;
+    }
+
+    static bool readVarint(const std::vector<uint8_t>& f, size_t& pos, uint32_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (pos >= f.size()) return false;
+            uint8_t b = f[pos++];
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    Sink sink_;
+    std::vector<uint8_t> pending_;
+    std::string text_;
+    uint32_t lastMicros_ = 0;
+    uint32_t epoch_ = 0;
+    bool haveTime_ = false;
+    unsigned badFrames_ = 0;
+};
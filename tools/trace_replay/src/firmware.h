@@ -0,0 +1,26 @@
+#pragma once
+// 1.conveyor, зібраний для відтворювача (fw_conveyor.cpp — у власному просторі імен,
+// як у двійнику лінії). Назовні — точки входу, входи з запису, стани і назви виходів.
+
+#include <stdint.h>
+
+namespace firmware {
+
+void setup();
+void loop();
+
+// Піни входів у порядку бітів InputTrace: START, STOP, датчик 1, датчик 2
+extern const uint8_t inputPins[4];
+extern const uint8_t stepPin;
+
+// Стани станка, розливу, закривання і їхні назви (ті самі, що друкує trace)
+enum StateKind : uint8_t { MACHINE, PAINT, CAP, STATE_KINDS };
+uint8_t state(StateKind kind);
+const char* stateName(StateKind kind, uint8_t value);
+// Номер стану за назвою; false — такої назви в цієї групи немає
+bool stateByName(const char* name, StateKind& kind, uint8_t& value);
+
+// Назва виходу з pinout.h (nullptr — не вихід прошивки)
+const char* outputName(uint8_t pin);
+
+} // namespace firmware
@@ -0,0 +1,93 @@
+// 1.conveyor у відтворювачі (Mega: аналогові піни з 54)
+#define ARDUINO_AVR_MEGA2560
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include <avr/eeprom.h>
+#include <StallWatchdog.h>
+#include "firmware.h"
+
+#include <string.h>
+
+namespace conveyor_fw {
+#include "../../../1.conveyor/src/main.cpp"
+}
+
+namespace firmware {
+
+using namespace conveyor_fw;
+
+void setup() { conveyor_fw::setup(); }
+void loop() { conveyor_fw::loop(); }
+
+const uint8_t inputPins[4] = {start_PIN, stop_PIN, sensor_1, sensor_2};
+const uint8_t stepPin = X_STEP_PIN;
+
+namespace {
+
+struct StateTable {
+    const char* const* names;
+    uint8_t count;
+};
+
+template <size_t N>
+constexpr StateTable table(const char* const (&names)[N]) {
+    return {names, (uint8_t)N};
+}
+
+const StateTable STATES[STATE_KINDS] = {table(MACHINE_STATE_NAMES), table(PAINT_STATE_NAMES), table(CAP_STATE_NAMES)};
+
+struct OutputName {
+    uint8_t pin;
+    const char* name;
+};
+
+const OutputName OUTPUTS[] = {
+    {PNEUMATIC_1_PIN, "PNEUMATIC_1"},
+    {PNEUMATIC_2_PIN, "PNEUMATIC_2"},
+    {PNEUMATIC_3_PIN, "PNEUMATIC_3"},
+    {PNEUMATIC_4_PIN, "PNEUMATIC_4"},
+    {PNEUMATIC_5_PIN, "PNEUMATIC_5"},
+    {START_STOP_PIN, "START_STOP"},
+    {START_CONVEYOR_PIN, "START_CONVEYOR"},
+    {X_STEP_PIN, "X_STEP"},
+    {X_DIR_PIN, "X_DIR"},
+    {X_ENABLE_PIN, "X_ENABLE"},
+    {ledMode0Pin, "LED_MODE0"},
+    {ledMode1Pin, "LED_MODE1"},
+};
+
+} // namespace
+
+uint8_t state(StateKind kind) {
+    switch (kind) {
+        case MACHINE: return machineState;
+        case PAINT: return paintState;
+        default: return capState;
+    }
+}
+
+const char* stateName(StateKind kind, uint8_t value) {
+    return value < STATES[kind].count ? STATES[kind].names[value] : "?";
+}
+
+bool stateByName(const char* name, StateKind& kind, uint8_t& value) {
+    for (uint8_t k = 0; k < STATE_KINDS; k++) {
+        for (uint8_t v = 0; v < STATES[k].count; v++) {
+            if (strcmp(STATES[k].names[v], name) == 0) {
+                kind = (StateKind)k;
+                value = v;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const char* outputName(uint8_t pin) {
+    for (const OutputName& o : OUTPUTS) {
+        if (o.pin == pin) return o.name;
+    }
+    return nullptr;
+}
+
+} // namespace firmware
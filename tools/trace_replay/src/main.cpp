@@ -0,0 +1,360 @@
+// Відтворення запису входів 1.conveyor (команда trace, input_trace.h) на ПК.
+//
+//   trace_replay TRACE [--loop-us N] [--tail-ms N] [--tolerance-ms X] [--tolerance-steps N]
+//                      [--save FILE] [--diff FILE] [--log]
+//
+//   TRACE              журнал з виводом trace (після tools/telemetry_decode); «-» — stdin
+//   --loop-us N        скільки мікросекунд «коштує» один виклик loop() (20)
+//   --tail-ms N        скільки прогнати після останнього запису (2000)
+//   --tolerance-ms X   допустимий зсув моменту переходу або зміни виходу (2)
+//   --tolerance-steps N  допустимий зсув положення конвеєра в кроках на зміні виходу (2)
+//   --save FILE        записати часову діаграму виходів (для --diff з іншою версією прошивки)
+//   --diff FILE        порівняти діаграму виходів із збереженою раніше
+//   --log              друкувати журнал прошивки (телеметрію) під час відтворення
+//
+// Прошивка збирається разом із відтворювачем (fw_conveyor.cpp), тож відтворюється та
+// версія 1.conveyor, що лежить у дереві. Входи з запису подаються на піни у свої моменти
+// віртуального часу; переходи станів, які дала прошивка, порівнюються із записаними, а зміни
+// виходів (без імпульсів STEP — замість них положення конвеєра в кроках) стають діаграмою.
+// Код виходу: 0 — збіг, 1 — розбіжність, 2 — помилка аргументів або запису.
+
+#include <Arduino.h>
+#include <ArduinoNative.h>
+#include "firmware.h"
+#include "trace.h"
+#include "../../telemetry_decode/src/telemetry_decoder.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Запис починається не з увімкнення: плата вже працювала, прошивка на ПК стартує
+// з setup() за стільки до першого запису
+const uint64_t LEAD_IN_NS = 200000000ULL;
+
+struct Transition {
+    uint64_t ns;
+    uint8_t value;
+};
+
+struct OutputChange {
+    uint64_t ns;
+    uint8_t pin;
+    bool level;
+    uint32_t steps;                 // імпульсів STEP від початку відтворення
+};
+
+void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s TRACE [--loop-us N] [--tail-ms N] [--tolerance-ms X] [--tolerance-steps N]\n"
+            "          [--save FILE] [--diff FILE] [--log]\n",
+            prog);
+}
+
+std::string pinName(uint8_t pin) {
+    const char* name = firmware::outputName(pin);
+    return name ? name : "pin" + std::to_string(pin);
+}
+
+double ms(uint64_t ns) { return ns / 1e6; }
+
+// Значення на момент ns за переходами (перший елемент — початкове значення)
+uint8_t valueAt(const std::vector<Transition>& seq, uint64_t ns) {
+    uint8_t v = seq.front().value;
+    for (const Transition& t : seq) {
+        if (t.ns > ns) break;
+        v = t.value;
+    }
+    return v;
+}
+
+// Переходи від моменту from: початкове значення на from, далі — пізніші
+std::vector<Transition> since(const std::vector<Transition>& seq, uint64_t from) {
+    std::vector<Transition> out{{from, valueAt(seq, from)}};
+    for (const Transition& t : seq) {
+        if (t.ns > from) out.push_back(t);
+    }
+    return out;
+}
+
+// Записані й відтворені переходи кожної групи станів; true — збіг
+bool compareStates(const std::vector<Transition> (&recorded)[firmware::STATE_KINDS],
+                   const std::vector<Transition> (&replayed)[firmware::STATE_KINDS],
+                   uint64_t from, double toleranceMs) {
+    static const char* const KIND_NAMES[] = {"machine", "paint", "cap"};
+    unsigned matched = 0, total = 0;
+    double worstShift = 0;
+    bool same = true;
+    for (uint8_t k = 0; k < firmware::STATE_KINDS; k++) {
+        firmware::StateKind kind = (firmware::StateKind)k;
+        std::vector<Transition> a = since(recorded[k], from);
+        std::vector<Transition> b = since(replayed[k], from);
+        total += a.size() - 1;
+        bool diverged = false;           // далі в цій групі порівнювати нема з чим
+        for (size_t i = 0; i < a.size(); i++) {
+            if (i >= b.size() || a[i].value != b[i].value) {
+                diverged = true;
+                printf("States diverge at %.3f ms: %s %s recorded, replay %s\n", ms(a[i].ns), KIND_NAMES[k],
+                       firmware::stateName(kind, a[i].value),
+                       i < b.size() ? firmware::stateName(kind, b[i].value) : "stays");
+                same = false;
+                break;
+            }
+            if (i == 0) continue;
+            double shift = ms(b[i].ns) - ms(a[i].ns);
+            if (fabs(shift) > fabs(worstShift)) worstShift = shift;
+            if (fabs(shift) > toleranceMs) {
+                printf("States shifted at %.3f ms: %s %s %+.3f ms in replay\n", ms(a[i].ns), KIND_NAMES[k],
+                       firmware::stateName(kind, a[i].value), shift);
+                same = false;
+            } else {
+                matched++;
+            }
+        }
+        if (!diverged && b.size() > a.size()) {
+            printf("States diverge at %.3f ms: replay adds %s %s\n", ms(b[a.size()].ns), KIND_NAMES[k],
+                   firmware::stateName(kind, b[a.size()].value));
+            same = false;
+        }
+    }
+    printf("States: %u of %u transitions matched, largest shift %+.3f ms\n", matched, total, worstShift);
+    return same;
+}
+
+bool saveTimeline(const char* path, const std::vector<OutputChange>& changes) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# trace_replay output timeline: ms pin level steps\n");
+    for (const OutputChange& c : changes) {
+        fprintf(f, "%.3f %s %d %u\n", ms(c.ns), pinName(c.pin).c_str(), c.level ? 1 : 0, c.steps);
+    }
+    return fclose(f) == 0;
+}
+
+bool loadTimeline(const char* path, std::vector<OutputChange>& changes) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char buf[128];
+    while (fgets(buf, sizeof(buf), f)) {
+        if (buf[0] == '#') continue;
+        double atMs;
+        char name[32];
+        int level;
+        unsigned steps;
+        if (sscanf(buf, "%lf %31s %d %u", &atMs, name, &level, &steps) != 4) continue;
+        uint8_t pin = 0;
+        while (pin < native::MAX_PINS && pinName(pin) != name) pin++;
+        changes.push_back({(uint64_t)llround(atMs * 1e6), pin, level != 0, steps});
+    }
+    fclose(f);
+    return true;
+}
+
+// Порівняння діаграм по кожному виходу окремо: n-та зміна з n-ю; true — збіг
+bool diffTimelines(const std::vector<OutputChange>& before, const std::vector<OutputChange>& after,
+                   double toleranceMs, uint32_t toleranceSteps) {
+    const unsigned MAX_REPORTED = 20;
+    unsigned differences = 0;
+    double worstShift = 0;
+    for (uint8_t pin = 0; pin < native::MAX_PINS; pin++) {
+        std::vector<const OutputChange*> a, b;
+        for (const OutputChange& c : before) {
+            if (c.pin == pin) a.push_back(&c);
+        }
+        for (const OutputChange& c : after) {
+            if (c.pin == pin) b.push_back(&c);
+        }
+        for (size_t i = 0; i < a.size() || i < b.size(); i++) {
+            std::string what;
+            char line[160];
+            if (i >= a.size() || i >= b.size() || a[i]->level != b[i]->level) {
+                const OutputChange* c = i < b.size() ? b[i] : a[i];
+                snprintf(line, sizeof(line), "  %s #%zu: %s %s=%d at %.3f ms\n", pinName(pin).c_str(), i + 1,
+                         i < b.size() ? "new" : "missing", pinName(pin).c_str(), c->level ? 1 : 0, ms(c->ns));
+                what = line;
+            } else {
+                double shift = ms(b[i]->ns) - ms(a[i]->ns);
+                int32_t steps = (int32_t)(b[i]->steps - a[i]->steps);
+                if (fabs(shift) > fabs(worstShift)) worstShift = shift;
+                if (fabs(shift) > toleranceMs || (uint32_t)abs(steps) > toleranceSteps) {
+                    snprintf(line, sizeof(line), "  %s #%zu =%d: %.3f -> %.3f ms (%+.3f), position %+d steps\n",
+                             pinName(pin).c_str(), i + 1, b[i]->level ? 1 : 0, ms(a[i]->ns), ms(b[i]->ns), shift, steps);
+                    what = line;
+                }
+            }
+            if (what.empty()) continue;
+            if (differences++ == 0) printf("Output differences (before -> after):\n");
+            if (differences <= MAX_REPORTED) fputs(what.c_str(), stdout);
+        }
+    }
+    if (differences > MAX_REPORTED) printf("  ... %u more\n", differences - MAX_REPORTED);
+    printf("Outputs vs saved timeline: %u before, %u after, %u differences, largest shift %+.3f ms\n",
+           (unsigned)before.size(), (unsigned)after.size(), differences, worstShift);
+    return differences == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* tracePath = nullptr;
+    const char* savePath = nullptr;
+    const char* diffPath = nullptr;
+    uint64_t loopUs = 20;
+    uint64_t tailMs = 2000;
+    double toleranceMs = 2.0;
+    uint32_t toleranceSteps = 2;
+    bool log = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--loop-us" && hasValue) {
+            loopUs = strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--tail-ms" && hasValue) {
+            tailMs = strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--tolerance-ms" && hasValue) {
+            toleranceMs = atof(argv[++i]);
+        } else if (a == "--tolerance-steps" && hasValue) {
+            toleranceSteps = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (a == "--save" && hasValue) {
+            savePath = argv[++i];
+        } else if (a == "--diff" && hasValue) {
+            diffPath = argv[++i];
+        } else if (a == "--log") {
+            log = true;
+        } else if (!tracePath && (a == "-" || a[0] != '-')) {
+            tracePath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!tracePath) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Trace trace;
+    std::string error;
+    FILE* in = std::string(tracePath) == "-" ? stdin : fopen(tracePath, "r");
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", tracePath);
+        return 2;
+    }
+    bool parsed = TraceParser::parse(in, trace, error);
+    if (in != stdin) fclose(in);
+    if (!parsed) {
+        fprintf(stderr, "%s: %s\n", tracePath, error.c_str());
+        return 2;
+    }
+
+    // Момент бази на віртуальному годиннику: з увімкнення — збігається з платою
+    const uint64_t offsetNs = trace.fromPowerUp() ? 0 : LEAD_IN_NS;
+    native::Board& board = native::board();
+
+    // Рівні входів до setup(): з бази, а для запису з увімкнення — з першої вибірки
+    uint8_t levels = trace.baseLevels;
+    for (const TraceEvent& e : trace.events) {
+        if (levels != Trace::UNKNOWN) break;
+        if (e.input) levels = e.levels;
+    }
+    if (levels == Trace::UNKNOWN) levels = 0x0F;    // нічого не записано: усе відпущено (підтяжки)
+    for (uint8_t i = 0; i < 4; i++) board.setInput(firmware::inputPins[i], levels & (1 << i));
+
+    std::vector<Transition> recorded[firmware::STATE_KINDS];
+    for (uint8_t k = 0; k < firmware::STATE_KINDS; k++) {
+        recorded[k].push_back({offsetNs, trace.baseState[k]});
+    }
+    uint64_t lastNs = offsetNs;
+    for (const TraceEvent& e : trace.events) {
+        uint64_t at = offsetNs + e.us * 1000;
+        lastNs = at;
+        if (e.input) {
+            uint8_t lv = e.levels;
+            native::scheduleAt(at, [&board, lv]() {
+                for (uint8_t i = 0; i < 4; i++) board.setInput(firmware::inputPins[i], lv & (1 << i));
+            });
+        } else {
+            recorded[e.kind].push_back({at, e.value});
+        }
+    }
+
+    // Порівнювати стани можна лише з моменту, коли стан плати відомий і збігається зі
+    // свіжим стартом: з увімкнення — одразу, інакше — з першої зупинки станка в записі
+    uint64_t compareFrom = offsetNs;
+    if (!trace.fromPowerUp() && trace.baseState[firmware::MACHINE] != 0) {
+        compareFrom = UINT64_MAX;
+        for (const Transition& t : recorded[firmware::MACHINE]) {
+            if (t.ns > offsetNs && t.value == 0) {
+                compareFrom = t.ns;
+                break;
+            }
+        }
+    }
+
+    std::vector<OutputChange> outputs;
+    uint32_t steps = 0;
+    board.onOutputChange([&](uint8_t pin, bool level) {
+        if (pin == firmware::stepPin) {
+            if (level) steps++;
+            return;
+        }
+        outputs.push_back({native::nanos(), pin, level, steps});
+    });
+    if (log) {
+        static TelemetryDecoder decoder([](const std::string& line) { printf("%10.3f  %s", native::nanos() / 1e9, line.c_str()); });
+        board.onSerialTx([](uint8_t b) { decoder.feed(b); });
+    }
+
+    std::vector<Transition> replayed[firmware::STATE_KINDS];
+    auto pollStates = [&]() {
+        for (uint8_t k = 0; k < firmware::STATE_KINDS; k++) {
+            uint8_t v = firmware::state((firmware::StateKind)k);
+            if (replayed[k].empty() || replayed[k].back().value != v) replayed[k].push_back({native::nanos(), v});
+        }
+    };
+
+    firmware::setup();
+    const uint64_t endNs = lastNs + tailMs * 1000000ULL;
+    while (native::nanos() < endNs) {
+        pollStates();
+        firmware::loop();
+        native::advanceMicros(loopUs);
+    }
+    fflush(stdout);
+
+    // Поки стан з запису невідомий («?» у базі), початкове значення — як у відтворенні
+    for (uint8_t k = 0; k < firmware::STATE_KINDS; k++) {
+        if (recorded[k].front().value == Trace::UNKNOWN) recorded[k].front().value = replayed[k].front().value;
+    }
+
+    printf("Trace: %u records%s, %.3f s\n", (unsigned)trace.events.size(),
+           trace.fromPowerUp() ? " from power-up" : "", (lastNs - offsetNs) / 1e9);
+    bool same = true;
+    if (compareFrom == UINT64_MAX) {
+        printf("States: not compared - the machine was %s when the trace starts and never stopped in it\n",
+               firmware::stateName(firmware::MACHINE, trace.baseState[firmware::MACHINE]));
+    } else {
+        if (compareFrom > offsetNs) printf("States compared from the first stop, %.3f ms\n", ms(compareFrom));
+        same = compareStates(recorded, replayed, compareFrom, toleranceMs);
+    }
+    printf("Outputs: %u changes, %u steps\n", (unsigned)outputs.size(), steps);
+
+    if (savePath && !saveTimeline(savePath, outputs)) {
+        fprintf(stderr, "cannot write %s\n", savePath);
+        return 2;
+    }
+    if (diffPath) {
+        std::vector<OutputChange> before;
+        if (!loadTimeline(diffPath, before)) {
+            fprintf(stderr, "cannot read %s\n", diffPath);
+            return 2;
+        }
+        same = diffTimelines(before, outputs, toleranceMs, toleranceSteps) && same;
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+#pragma once
+// Розбір виводу команди `trace` 1.conveyor (1.conveyor/src/input_trace.h) — тексту,
+// який дає tools/telemetry_decode:
+//
+//   Trace: 18 records, 0 dropped
+//   base 0 in ? ? ? ?
+//   +500 in 1111
+//   +49520 RUNNING
+//   ...
+//   end of trace
+//
+// Час запису — мікросекунди від бази (прирости складаються в 64 біти, тож переповнення
+// micros() на платі не заважає). Якщо у файлі кілька виводів, береться останній.
+
+#include "firmware.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct TraceEvent {
+    uint64_t us;                    // від бази
+    bool input;                     // рівні входів, інакше — новий стан
+    uint8_t levels;                 // біти InputTrace: START, STOP, датчик 1, датчик 2
+    firmware::StateKind kind;
+    uint8_t value;
+};
+
+struct Trace {
+    static constexpr uint8_t UNKNOWN = 0xFF;
+
+    uint32_t baseMicros = 0;        // micros() плати на момент бази
+    uint8_t baseLevels = UNKNOWN;
+    uint8_t baseState[firmware::STATE_KINDS] = {UNKNOWN, UNKNOWN, UNKNOWN};
+    uint32_t dropped = 0;           // записів, витіснених з кільця до виводу
+    std::vector<TraceEvent> events;
+
+    // Запис від увімкнення плати: кільце не переповнювалось, база порожня
+    bool fromPowerUp() const { return dropped == 0 && baseLevels == UNKNOWN; }
+};
+
+class TraceParser {
+public:
+    // false — у файлі немає повного виводу trace (error пояснює, чому)
+    static bool parse(FILE* in, Trace& trace, std::string& error) {
+        Trace current;
+        bool inside = false, found = false;
+        uint64_t at = 0;
+        char buf[256];
+        unsigned lineNo = 0;
+        while (fgets(buf, sizeof(buf), in)) {
+            lineNo++;
+            std::string line = trim(buf);
+            if (line.compare(0, 7, "Trace: ") == 0) {
+                current = Trace();
+                current.dropped = (uint32_t)strtoul(line.c_str() + line.find(',') + 1, nullptr, 10);
+                inside = true;
+                at = 0;
+                continue;
+            }
+            if (!inside) continue;
+            if (line == "end of trace") {
+                trace = current;
+                inside = false;
+                found = true;
+                continue;
+            }
+            std::vector<std::string> words = split(line);
+            bool ok = false;
+            if (!words.empty() && words[0] == "base") {
+                ok = parseBase(words, current);
+            } else if (!words.empty() && words[0][0] == '+') {
+                at += strtoull(words[0].c_str() + 1, nullptr, 10);
+                ok = parseEvent(words, at, current);
+            }
+            if (!ok) {
+                error = "line " + std::to_string(lineNo) + ": cannot parse \"" + line + "\"";
+                return false;
+            }
+        }
+        if (!found) error = inside ? "trace is cut off (no \"end of trace\")" : "no trace dump found";
+        return found;
+    }
+
+private:
+    static std::string trim(const char* s) {
+        std::string line(s);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        size_t start = line.find_first_not_of(' ');
+        return start == std::string::npos ? std::string() : line.substr(start);
+    }
+
+    static std::vector<std::string> split(const std::string& line) {
+        std::vector<std::string> words;
+        size_t pos = 0;
+        while (pos < line.size()) {
+            size_t end = line.find(' ', pos);
+            if (end == std::string::npos) end = line.size();
+            if (end > pos) words.push_back(line.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        return words;
+    }
+
+    // "1101" → біти InputTrace; "?" → UNKNOWN
+    static bool parseLevels(const std::string& s, uint8_t& levels) {
+        if (s == "?") {
+            levels = Trace::UNKNOWN;
+            return true;
+        }
+        if (s.size() != 4) return false;
+        levels = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            if (s[i] != '0' && s[i] != '1') return false;
+            if (s[i] == '1') levels |= 1 << i;
+        }
+        return true;
+    }
+
+    // base <micros> in <рівні> <стан станка> <розливу> <закривання>
+    static bool parseBase(const std::vector<std::string>& w, Trace& t) {
+        if (w.size() != 7 || w[2] != "in" || !parseLevels(w[3], t.baseLevels)) return false;
+        t.baseMicros = (uint32_t)strtoul(w[1].c_str(), nullptr, 10);
+        for (uint8_t k = 0; k < firmware::STATE_KINDS; k++) {
+            const std::string& name = w[4 + k];
+            firmware::StateKind kind;
+            uint8_t value;
+            if (name == "?") {
+                t.baseState[k] = Trace::UNKNOWN;
+            } else if (firmware::stateByName(name.c_str(), kind, value) && kind == k) {
+                t.baseState[k] = value;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // +<приріст> in <рівні>  |  +<приріст> <назва стану>
+    static bool parseEvent(const std::vector<std::string>& w, uint64_t at, Trace& t) {
+        TraceEvent e{at, false, 0, firmware::MACHINE, 0};
+        if (w.size() == 3 && w[1] == "in") {
+            e.input = true;
+            if (!parseLevels(w[2], e.levels) || e.levels == Trace::UNKNOWN) return false;
+        } else if (w.size() != 2 || !firmware::stateByName(w[1].c_str(), e.kind, e.value)) {
+            return false;
+        }
+        t.events.push_back(e);
+        return true;
+    }
+};